@@ -0,0 +1,83 @@
+#include "pch.h"
+#include "../kwh-modbus/libraries/backfillQueue/BackfillQueue.hpp"
+#include "test_helpers.h"
+#include "../kwh-modbus/noArduino/ArduinoMacros.h"
+
+TEST_TRAITS(BackfillQueueTests, push_MergesTouchingRanges,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BackfillQueue queue;
+	queue.init(4);
+
+	ASSERT_TRUE(queue.push(6, 1, TimeScale::sec1, 100, 200));
+	ASSERT_TRUE(queue.push(6, 1, TimeScale::sec1, 200, 260));
+	ASSERT_TRUE(queue.push(6, 1, TimeScale::sec1, 50, 120));
+	ASSERT_TRUE(queue.push(6, 1, TimeScale::min1, 100, 200));
+	ASSERT_TRUE(queue.push(6, 2, TimeScale::sec1, 100, 200));
+
+	ASSERT_EQ(queue.getCount(), 3);
+	ASSERT_EQ(queue._ranges[0].startTime, 50);
+	ASSERT_EQ(queue._ranges[0].endTime, 260);
+	ASSERT_FALSE(queue.push(6, 1, TimeScale::sec1, 300, 300));
+}
+
+TEST_TRAITS(BackfillQueueTests, push_Full_DropsOldest,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	BackfillQueue queue;
+	queue.init(2);
+
+	queue.push(6, 1, TimeScale::sec1, 100, 200);
+	queue.push(6, 2, TimeScale::sec1, 100, 200);
+	queue.push(6, 3, TimeScale::sec1, 100, 200);
+
+	ASSERT_EQ(queue.getCount(), 2);
+	ASSERT_EQ(queue.getDroppedRanges(), 1);
+	ASSERT_EQ(queue._ranges[0].deviceNumber, 2);
+	ASSERT_EQ(queue._ranges[1].deviceNumber, 3);
+}
+
+TEST_TRAITS(BackfillQueueTests, takeChunk_RoundRobin,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BackfillQueue queue;
+	queue.init(4);
+	queue.push(6, 1, TimeScale::sec1, 100, 125);
+	queue.push(5, 0, TimeScale::ms250, 100, 103);
+	BackfillRange chunk;
+
+	ASSERT_TRUE(queue.takeChunk(10, chunk));
+	ASSERT_EQ(chunk.slaveId, 6);
+	ASSERT_EQ(chunk.startTime, 100);
+	ASSERT_EQ(chunk.endTime, 110);
+
+	ASSERT_TRUE(queue.takeChunk(12, chunk));
+	ASSERT_EQ(chunk.slaveId, 5);
+	ASSERT_EQ(chunk.startTime, 100);
+	ASSERT_EQ(chunk.endTime, 103);
+
+	ASSERT_TRUE(queue.takeChunk(10, chunk));
+	ASSERT_EQ(chunk.startTime, 110);
+	ASSERT_EQ(chunk.endTime, 120);
+	ASSERT_TRUE(queue.takeChunk(10, chunk));
+	ASSERT_EQ(chunk.startTime, 120);
+	ASSERT_EQ(chunk.endTime, 125);
+
+	ASSERT_TRUE(queue.isEmpty());
+	ASSERT_FALSE(queue.takeChunk(10, chunk));
+}
+
+TEST_TRAITS(BackfillQueueTests, removeDevice,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BackfillQueue queue;
+	queue.init(4);
+	queue.push(6, 1, TimeScale::sec1, 100, 200);
+	queue.push(6, 2, TimeScale::sec1, 100, 200);
+	queue.push(6, 1, TimeScale::min1, 100, 200);
+
+	queue.removeDevice(6, 1);
+
+	ASSERT_EQ(queue.getCount(), 1);
+	ASSERT_EQ(queue.front()->deviceNumber, 2);
+}
@@ -48,6 +48,26 @@ TEST_TRAITS(BitFunctionTests, bitsToBytes_17,
 	ASSERT_EQ(bytes, 3);
 }
 
+TEST_TRAITS(BitFunctionTests, isPowerOfTwo,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	ASSERT_TRUE(BitFunctions::isPowerOfTwo(1));
+	ASSERT_TRUE(BitFunctions::isPowerOfTwo(128));
+	ASSERT_TRUE(BitFunctions::isPowerOfTwo(0x80000000));
+	ASSERT_FALSE(BitFunctions::isPowerOfTwo(0));
+	ASSERT_FALSE(BitFunctions::isPowerOfTwo(100));
+}
+
+TEST_TRAITS(BitFunctionTests, bitsToBytes_MoreThanWord,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	// 2000 points of 40 bits
+	auto bytes = BitFunctions::bitsToBytes((uint32_t)2000 * 40);
+	ASSERT_EQ(bytes, 10000);
+	auto regs = BitFunctions::bitsToStructs<uint16_t, uint16_t>((uint32_t)2000 * 40);
+	ASSERT_EQ(regs, 5000);
+}
+
 TEST_TRAITS(BitFunctionTests, bitsToBytes_63,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
@@ -62,6 +82,13 @@ TEST_TRAITS(BitFunctionTests, bitsToBytes_65,
 	ASSERT_EQ(bytes, 9);
 }
 
+TEST_TRAITS(BitFunctionTests, bitsToBytes_300,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	auto bytes = BitFunctions::bitsToBytes(300);
+	ASSERT_EQ(bytes, 38);
+}
+
 TEST_TRAITS(BitFunctionTests, bitsToStructs_uint16_t_1,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
@@ -125,6 +152,13 @@ TEST_TRAITS(BitFunctionTests, bitsToStructs_int_97,
 	ASSERT_EQ(result, 4);
 }
 
+TEST_TRAITS(BitFunctionTests, bitsToStructs_uint16_t_1856,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	auto result = BitFunctions::bitsToStructs<uint16_t, word>(1856);
+	ASSERT_EQ(result, 116);
+}
+
 TEST_TRAITS(BitFunctionTests, bitsToStructs_string_0,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Rare)
 {
@@ -0,0 +1,94 @@
+#include "pch.h"
+#include "../kwh-modbus/libraries/device/BufferedDataCollectorDevice.h"
+#include "../kwh-modbus/libraries/bitFunctions/BitFunctions.hpp"
+#include "test_helpers.h"
+
+TEST_TRAITS(BufferedDataCollectorDeviceTests, readData_WrappedBuffer,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BufferedDataCollectorDevice device;
+	ASSERT_TRUE(device.init(false, TimeScale::sec1, 8, 8));
+	for (uint32_t time = 100; time < 110; time++)
+	{
+		ASSERT_TRUE(device.recordAt(time, 0, time - 50));
+	}
+	ASSERT_EQ(device.getNumStored(), 8);
+	byte buffer[12];
+	word numDataPointsInPage;
+	word pagesRemaining;
+	byte dataPointSize;
+
+	ASSERT_TRUE(device.readData(100, 12, 0, buffer, 12, 0, numDataPointsInPage, pagesRemaining, dataPointSize));
+
+	ASSERT_EQ(numDataPointsInPage, 12);
+	ASSERT_EQ(pagesRemaining, 0);
+	// Older than the buffer reaches, and newer than the newest point
+	ASSERT_EQ(buffer[0], 255);
+	ASSERT_EQ(buffer[1], 255);
+	for (int i = 2; i < 10; i++)
+	{
+		ASSERT_EQ(buffer[i], 50 + i);
+	}
+	ASSERT_EQ(buffer[10], 255);
+	ASSERT_EQ(buffer[11], 255);
+}
+
+TEST_TRAITS(BufferedDataCollectorDeviceTests, readDataPoints_SameAsReadDataPoint,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BufferedDataCollectorDevice device;
+	ASSERT_TRUE(device.init(false, TimeScale::ms250, 5, 7));
+	for (uint32_t quarter = 0; quarter < 30; quarter++)
+	{
+		if (quarter % 6 != 4)
+			ASSERT_TRUE(device.recordAt(40 + quarter / 4, quarter % 4, quarter));
+	}
+
+	for (word stride = 1; stride <= 3; stride++)
+	{
+		byte buffer[8];
+		byte expected[8];
+		memset(expected, 0, 8);
+		ASSERT_TRUE(device.readDataPoints(44, 2, 10, stride, buffer, 5));
+		for (word i = 0; i < 10; i++)
+		{
+			uint32_t quarter = 18 + i * stride;
+			byte point = 0;
+			if (!device.readDataPoint(40 + quarter / 4, quarter % 4, &point, 5))
+				point = 0x1F;
+			BitFunctions::copyBits(&point, expected, (uint32_t)0, (uint32_t)i * 5, (uint32_t)5);
+		}
+		ASSERT_EQ(memcmp(buffer, expected, 7), 0);
+	}
+}
+
+TEST_TRAITS(BufferedDataCollectorDeviceTests, record_SkippedPeriodsAreMissing,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	TimeManager timeManager;
+	BufferedDataCollectorDevice device;
+	ASSERT_TRUE(device.init(false, TimeScale::min1, 24, 6));
+	ASSERT_FALSE(device.record(1));
+	device.setTimeSource(&timeManager);
+
+	timeManager.setClock(600);
+	ASSERT_TRUE(device.record(0x123456));
+	timeManager.setClock(785);
+	ASSERT_TRUE(device.record(0x0A0B0C));
+	// The period before the newest one can't be recorded any more
+	ASSERT_FALSE(device.recordAt(720, 0, 5));
+
+	byte buffer[12];
+	ASSERT_TRUE(device.readDataPoints(600, 0, 4, 1, buffer, 24));
+	ASSERT_EQ(buffer[0], 0x56);
+	ASSERT_EQ(buffer[2], 0x12);
+	ASSERT_EQ(buffer[3], 0xFF);
+	ASSERT_EQ(buffer[8], 0xFF);
+	ASSERT_EQ(buffer[9], 0x0C);
+	ASSERT_EQ(buffer[11], 0x0A);
+
+	// Far enough ahead that nothing stored is still in the buffer
+	ASSERT_TRUE(device.recordAt(1200, 0, 7));
+	ASSERT_EQ(device.getNumStored(), 1);
+	ASSERT_FALSE(device.readDataPoint(780, 0, buffer, 24));
+}
@@ -0,0 +1,61 @@
+#include "pch.h"
+#include "../kwh-modbus/libraries/busPriorityBudget/BusPriorityBudget.hpp"
+#include "test_helpers.h"
+#include "../kwh-modbus/noArduino/ArduinoMacros.h"
+
+TEST_TRAITS(BusPriorityBudgetTests, hasBudget_Unlimited,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BusPriorityBudget budget;
+	budget.reset(0);
+
+	budget.charge(BusPriority::liveData, 5000000);
+
+	ASSERT_TRUE(budget.hasBudget(BusPriority::liveData));
+	ASSERT_EQ(budget.getSpent(BusPriority::liveData), 5000000);
+}
+
+TEST_TRAITS(BusPriorityBudgetTests, hasBudget_Spent,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BusPriorityBudget budget;
+	budget.setBudget(BusPriority::backfill, 200000);
+	budget.reset(0);
+
+	budget.charge(BusPriority::backfill, 150000);
+	ASSERT_TRUE(budget.hasBudget(BusPriority::backfill));
+	budget.charge(BusPriority::backfill, 50000);
+	ASSERT_FALSE(budget.hasBudget(BusPriority::backfill));
+	ASSERT_TRUE(budget.hasBudget(BusPriority::onboarding));
+}
+
+TEST_TRAITS(BusPriorityBudgetTests, update_NewCycle,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BusPriorityBudget budget;
+	budget.config(500000);
+	budget.setBudget(BusPriority::onboarding, 100000);
+	budget.reset(1000);
+	budget.charge(BusPriority::onboarding, 100000);
+
+	budget.update(400000);
+	ASSERT_FALSE(budget.hasBudget(BusPriority::onboarding));
+	budget.update(501000);
+	ASSERT_TRUE(budget.hasBudget(BusPriority::onboarding));
+	ASSERT_EQ(budget.getSpent(BusPriority::onboarding), 0);
+}
+
+TEST_TRAITS(BusPriorityBudgetTests, update_MicrosOverflow,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	BusPriorityBudget budget;
+	budget.config(500000);
+	budget.setBudget(BusPriority::onboarding, 100000);
+	budget.reset((unsigned long)-256);
+	budget.charge(BusPriority::onboarding, 100000);
+
+	budget.update(1000);
+	ASSERT_FALSE(budget.hasBudget(BusPriority::onboarding));
+	budget.update(500000);
+	ASSERT_TRUE(budget.hasBudget(BusPriority::onboarding));
+}
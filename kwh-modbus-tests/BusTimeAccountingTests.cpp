@@ -0,0 +1,88 @@
+#include "pch.h"
+#include "../kwh-modbus/libraries/busTimeAccounting/BusTimeAccounting.hpp"
+#include "test_helpers.h"
+#include "../kwh-modbus/noArduino/ArduinoMacros.h"
+
+TEST_TRAITS(BusTimeAccountingTests, getFrameWireTime_9600Baud,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BusTimeAccounting busTime;
+	busTime.config(9600, 6013);
+
+	// Reading 10 registers: 8 byte request, 25 byte response
+	auto request = busTime.getFrameWireTime(BusTimeAccounting::getReadRequestLength());
+	auto response = busTime.getFrameWireTime(BusTimeAccounting::getReadResponseLength(10));
+
+	ASSERT_EQ(request, 8 * 1145 + 6013);
+	ASSERT_EQ(response, 25 * 1145 + 6013);
+}
+
+TEST_TRAITS(BusTimeAccountingTests, getFrameWireTime_NoFrame,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	BusTimeAccounting busTime;
+	busTime.config(9600, 6013);
+
+	ASSERT_EQ(busTime.getFrameWireTime(0), 0);
+}
+
+TEST_TRAITS(BusTimeAccountingTests, getWriteRequestLength_SingleAndMultiple,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	ASSERT_EQ(BusTimeAccounting::getWriteRequestLength(1), 8);
+	ASSERT_EQ(BusTimeAccounting::getWriteRequestLength(3), 15);
+}
+
+TEST_TRAITS(BusTimeAccountingTests, record_ByCategory,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BusTimeAccounting busTime;
+	busTime.config(38400, 2625);
+	busTime.reset(1000);
+
+	busTime.record(BusTimeCategory::collection, 8, 19, 1000, 21000);
+	busTime.record(BusTimeCategory::collection, 8, 0, 30000, 130000);
+	busTime.record(BusTimeCategory::discovery, 8, 21, 150000, 170000);
+	busTime.update(201000);
+
+	ASSERT_EQ(busTime.getRequestCount(BusTimeCategory::collection), 2);
+	ASSERT_EQ(busTime.getRequestCount(BusTimeCategory::discovery), 1);
+	ASSERT_EQ(busTime.getRequestCount(BusTimeCategory::delivery), 0);
+	ASSERT_EQ(busTime.getWireTime(BusTimeCategory::collection), 35 * 286 + 3 * 2625);
+	ASSERT_EQ(busTime.getMeasuredTime(BusTimeCategory::collection), 120000);
+	ASSERT_EQ(busTime.getTotalMeasuredTime(), 140000);
+	ASSERT_EQ(busTime.getElapsedTime(), 200000);
+	ASSERT_EQ(busTime.getUtilization(), 70);
+	ASSERT_EQ(busTime.getWireUtilization(), 15);
+	ASSERT_EQ(busTime.getWireEfficiency(BusTimeCategory::discovery), 67);
+}
+
+TEST_TRAITS(BusTimeAccountingTests, update_MicrosOverflow,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	BusTimeAccounting busTime;
+	busTime.config(9600, 6013);
+	busTime.reset((unsigned long)-1000);
+
+	busTime.record(BusTimeCategory::delivery, 8, 8, (unsigned long)-500, 500);
+	busTime.update(4000);
+
+	ASSERT_EQ(busTime.getMeasuredTime(BusTimeCategory::delivery), 1000);
+	ASSERT_EQ(busTime.getElapsedTime(), 5000);
+	ASSERT_EQ(busTime.getUtilization(), 20);
+}
+
+TEST_TRAITS(BusTimeAccountingTests, reset_ClearsTotals,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BusTimeAccounting busTime;
+	busTime.config(9600, 6013);
+	busTime.record(BusTimeCategory::timeSync, 8, 0, 0, 10000);
+
+	busTime.reset(10000);
+
+	ASSERT_EQ(busTime.getRequestCount(BusTimeCategory::timeSync), 0);
+	ASSERT_EQ(busTime.getTotalWireTime(), 0);
+	ASSERT_EQ(busTime.getElapsedTime(), 0);
+	ASSERT_EQ(busTime.getUtilization(), 0);
+}
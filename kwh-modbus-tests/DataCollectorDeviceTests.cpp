@@ -18,6 +18,29 @@ public:
 	}
 };
 
+// Keeps a point per second in an array, and fills pages from it directly
+class _ArrayDataCollectorDevice : public DataCollectorDevice
+{
+public:
+	byte points[16];
+	int pointReads = 0;
+
+	virtual bool readDataPoint(uint32_t time, byte quarterSecondOffset, byte* dataBuffer, byte bufferSizeBits)
+	{
+		pointReads++;
+		return false;
+	}
+
+	virtual bool readDataPoints(uint32_t time, byte quarterSecondOffset, word count, word stride, byte* buffer, byte dataSizeBits)
+	{
+		for (word i = 0; i < count; i++)
+		{
+			buffer[i] = points[(time + i * stride) % 16];
+		}
+		return true;
+	}
+};
+
 class DataCollectorDeviceTests : public ::testing::Test
 {
 protected:
@@ -89,6 +112,18 @@ TEST_F_TRAITS(DataCollectorDeviceTests, getDataCollectorDeviceTypeFromParameters
 	ASSERT_EQ(devType, 0x7FF0);
 }
 
+TEST_F_TRAITS(DataCollectorDeviceTests, getDataCollectorDeviceTypeFromParameters_PageEncoding,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	word devType;
+	bool success = DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(true, TimeScale::min10, 63,
+		PageEncoding::zigzagVarint, devType);
+
+	ASSERT_TRUE(success);
+	ASSERT_EQ(devType, 0x73F1);
+	ASSERT_EQ(Device::getPageEncodingFromDeviceType(devType), PageEncoding::zigzagVarint);
+}
+
 TEST_F_TRAITS(DataCollectorDeviceTests, getDataCollectorDeviceTypeFromParameters_BadTimeScale,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
 {
@@ -191,12 +226,44 @@ TEST_F_TRAITS(DataCollectorDeviceTests, getParametersFromDataCollectorDeviceType
 	TimeScale scale;
 	bool accumulate;
 	byte dataSize;
-	word devType = 0x7FF1;
+	word devType = 0x7FF4;
 	bool success = DataCollectorDevice::getParametersFromDataCollectorDeviceType(devType, accumulate, scale, dataSize);
 
 	ASSERT_FALSE(success);
 }
 
+TEST_F_TRAITS(DataCollectorDeviceTests, getParametersFromDataCollectorDeviceType_PageEncoding,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	TimeScale scale;
+	bool accumulate;
+	byte dataSize;
+	PageEncoding pageEncoding;
+	word devType = 0x73F2;
+	bool success = DataCollectorDevice::getParametersFromDataCollectorDeviceType(devType, accumulate, scale, dataSize, pageEncoding);
+
+	ASSERT_TRUE(success);
+	ASSERT_TRUE(accumulate);
+	ASSERT_EQ(scale, TimeScale::min10);
+	ASSERT_EQ(dataSize, 63);
+	ASSERT_EQ(pageEncoding, PageEncoding::packedDelta);
+}
+
+TEST_F_TRAITS(DataCollectorDeviceTests, getParametersFromDataCollectorDeviceType_Deadband,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	TimeScale scale;
+	bool accumulate;
+	byte dataSize;
+	PageEncoding pageEncoding;
+	word devType = 0x73F3;
+	bool success = DataCollectorDevice::getParametersFromDataCollectorDeviceType(devType, accumulate, scale, dataSize, pageEncoding);
+
+	ASSERT_TRUE(success);
+	ASSERT_EQ(pageEncoding, PageEncoding::deadband);
+	ASSERT_EQ(Device::getPageEncodingFromDeviceType(devType), PageEncoding::deadband);
+}
+
 TEST_F_TRAITS(DataCollectorDeviceTests, getParametersFromDataCollectorDeviceType_Failure_NotDataCollector,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
 {
@@ -262,8 +329,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_1page_1sec_8bits,
 	auto type = device->getType();
 	byte* buffer = tracker.addArray(new byte[6]);
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 6, 0, buffer, 6, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -293,8 +360,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_1page_15sec_8bits,
 	device->init(false, TimeScale::sec15, 8);
 	byte* buffer = tracker.addArray(new byte[6]);
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 6, 0, buffer, 6, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -324,8 +391,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_1page_250ms_8bits,
 	device->init(false, TimeScale::ms250, 8);
 	byte* buffer = tracker.addArray(new byte[6]);
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 6, 0, buffer, 6, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -355,8 +422,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_1page_1sec_8bits_largeB
 	device->init(false, TimeScale::sec1, 8);
 	byte* buffer = tracker.addArray(new byte[9]);
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 6, 0, buffer, 9, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -386,8 +453,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_3page_1sec_8bits_page0,
 	device->init(false, TimeScale::sec1, 8);
 	byte* buffer = tracker.addArray(new byte[6]);
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 18, 0, buffer, 6, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -417,8 +484,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_3page_1sec_8bits_page1,
 	device->init(false, TimeScale::sec1, 8);
 	byte* buffer = tracker.addArray(new byte[6]);
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 18, 1, buffer, 6, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -448,8 +515,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_3page_1sec_8bits_page2,
 	device->init(false, TimeScale::sec1, 8);
 	byte* buffer = tracker.addArray(new byte[6]);
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 18, 2, buffer, 6, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -479,8 +546,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_3page_1sec_8bits_partia
 	device->init(false, TimeScale::sec1, 8);
 	byte* buffer = tracker.addArray(new byte[6]);
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 14, 2, buffer, 6, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -508,8 +575,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_2page_1sec_3bits_page0,
 	buffer[0] = 0;
 	buffer[1] = 0;
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 7, 0, buffer, 2, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -538,8 +605,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_2page_1sec_3bits_page1,
 	buffer[0] = 0;
 	buffer[1] = 0;
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 7, 1, buffer, 2, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -569,8 +636,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_3page_24hr_5bits_page0,
 	buffer[1] = 0;
 	buffer[2] = 0;
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 10, 0, buffer, 3, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -601,8 +668,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_3page_24hr_5bits_page1,
 	buffer[1] = 0;
 	buffer[2] = 0;
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 10, 1, buffer, 3, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -633,8 +700,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_3page_24hr_5bits_page2,
 	buffer[1] = 0;
 	buffer[2] = 0;
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 10, 2, buffer, 3, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -662,8 +729,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_1page_1min_8bits_timeOf
 	device->init(false, TimeScale::min1, 8);
 	byte* buffer = tracker.addArray(new byte[20]);
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(70, 8, 0, buffer, 20, 0, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -697,8 +764,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_3page_withMaxPoints_1se
 	buffer[0] = 0;
 	buffer[1] = 0;
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 7, 0, buffer, 2, 3, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -727,8 +794,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_3page_withMaxPoints_1se
 	buffer[0] = 0;
 	buffer[1] = 0;
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 7, 1, buffer, 2, 3, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -757,8 +824,8 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_3page_withMaxPoints_1se
 	buffer[0] = 0;
 	buffer[1] = 0;
 	byte dummy;
-	byte numDataPointsInPage;
-	byte pagesRemaining;
+	word numDataPointsInPage;
+	word pagesRemaining;
 	byte dataPointSize;
 
 	bool success = device->readData(0, 7, 2, buffer, 2, 3, numDataPointsInPage, pagesRemaining, dataPointSize);
@@ -770,4 +837,46 @@ TEST_F_TRAITS(DataCollectorDeviceTests, readData_Success_3page_withMaxPoints_1se
 	Verify(Method(mock, readDataPoint)).Exactly(1);
 	ASSERT_EQ(buffer[0], 6);
 	ASSERT_EQ(buffer[1], 0);
-}
\ No newline at end of file
+}
+TEST_F_TRAITS(DataCollectorDeviceTests, readDataPoints_Stride_QuarterSeconds,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	USE_MOCK;
+	When(Method(mock, readDataPoint)).AlwaysDo([](uint32_t time, byte quarterSecondOffset, byte* dataBuffer, byte dataSizeBits) {
+		dataBuffer[0] = (byte)(time * 4 + quarterSecondOffset);
+		return quarterSecondOffset != 1;
+	});
+
+	ASSERT_TRUE(device->init(false, TimeScale::ms250, 8));
+	byte buffer[3];
+
+	ASSERT_TRUE(device->readDataPoints(10, 3, 3, 2, buffer, 8));
+	ASSERT_EQ(buffer[0], 43);
+	// Not read, so all of its bits are set
+	ASSERT_EQ(buffer[1], 255);
+	ASSERT_EQ(buffer[2], 47);
+	Verify(Method(mock, readDataPoint)).Exactly(3);
+}
+
+TEST_TRAITS(DataCollectorDeviceArrayTests, readData_OverriddenReadDataPoints,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	_ArrayDataCollectorDevice device;
+	for (byte i = 0; i < 16; i++)
+	{
+		device.points[i] = i * 3;
+	}
+	device.init(false, TimeScale::sec1, 8);
+	byte buffer[4];
+	word numDataPointsInPage;
+	word pagesRemaining;
+	byte dataPointSize;
+
+	ASSERT_TRUE(device.readData(2, 10, 1, buffer, 4, 0, numDataPointsInPage, pagesRemaining, dataPointSize));
+
+	ASSERT_EQ(numDataPointsInPage, 4);
+	ASSERT_EQ(pagesRemaining, 1);
+	ASSERT_EQ(buffer[0], 18);
+	ASSERT_EQ(buffer[3], 27);
+	ASSERT_EQ(device.pointReads, 0);
+}
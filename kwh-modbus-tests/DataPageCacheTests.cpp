@@ -0,0 +1,216 @@
+#include "pch.h"
+#include "fakeit.hpp"
+#include "../kwh-modbus/libraries/dataPageCache/DataPageCache.hpp"
+#include "test_helpers.h"
+#include "../kwh-modbus/noArduino/ArduinoMacros.h"
+
+using namespace fakeit;
+
+TEST_TRAITS(DataPageCacheTests, init_Success,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	DataPageCache cache;
+
+	ASSERT_TRUE(cache.init(128, 4, 3));
+	ASSERT_EQ(cache._capacity, 128);
+	ASSERT_EQ(cache.getDeviceNameLength(), 4);
+	ASSERT_EQ(cache._maxDestinations, 3);
+	ASSERT_EQ(cache.getNumPages(), 0);
+}
+
+TEST_TRAITS(DataPageCacheTests, init_Failure_TooSmall,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	DataPageCache cache;
+
+	ASSERT_FALSE(cache.init(8, 4, 3));
+	ASSERT_FALSE(cache.init(128, 4, 0));
+}
+
+TEST_TRAITS(DataPageCacheTests, init_Failure_NotPowerOfTwo,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	DataPageCache cache;
+
+	ASSERT_FALSE(cache.init(100, 4, 3));
+}
+
+TEST_TRAITS(DataPageCacheTests, appendAndReadPage_Success,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	DataPageCache cache;
+	cache.init(128, 4, 3);
+	byte data0[3] = { 0x12, 0x34, 0x5 };
+	byte data1[2] = { 0xAB, 0xCD };
+
+	ASSERT_TRUE(cache.append((byte*)"dev0", 0x12345678, 5, TimeScale::min1, 4, data0));
+	ASSERT_TRUE(cache.append((byte*)"dev1", 1000, 8, TimeScale::sec1, 2, data1));
+
+	uint32_t cursor = 0;
+	DataPageCacheEntry entry;
+	byte name[4];
+	byte data[4];
+	ASSERT_TRUE(cache.readPage(cursor, entry, name, data, 4));
+	ASSERT_EQ(cursor, 15);
+	ASSERT_EQ(entry.startTime, 0x12345678);
+	ASSERT_EQ(entry.dataSize, 5);
+	ASSERT_EQ(entry.timeScale, TimeScale::min1);
+	ASSERT_EQ(entry.numPoints, 4);
+	ASSERT_EQ(stringifyCharArray(4, (char*)name), "dev0");
+	assertArrayEq<byte, byte, byte>(data, 0x12, 0x34, 0x5);
+	ASSERT_TRUE(cache.readPage(cursor, entry, name, data, 4));
+	ASSERT_EQ(cursor, 29);
+	ASSERT_EQ(entry.startTime, 1000);
+	ASSERT_EQ(stringifyCharArray(4, (char*)name), "dev1");
+	assertArrayEq<byte, byte>(data, 0xAB, 0xCD);
+	ASSERT_FALSE(cache.readPage(cursor, entry, name, data, 4));
+	ASSERT_EQ(cache.getNumPages(), 2);
+}
+
+TEST_TRAITS(DataPageCacheTests, readPage_SkipsPageTooLargeForBuffer,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	DataPageCache cache;
+	cache.init(128, 4, 3);
+	byte data0[6] = { 1, 2, 3, 4, 5, 6 };
+	byte data1[2] = { 0xAB, 0xCD };
+	cache.append((byte*)"dev0", 1000, 8, TimeScale::sec1, 6, data0);
+	cache.append((byte*)"dev1", 1006, 8, TimeScale::sec1, 2, data1);
+
+	uint32_t cursor = 0;
+	DataPageCacheEntry entry;
+	byte name[4];
+	byte data[4];
+	ASSERT_TRUE(cache.readPage(cursor, entry, name, data, 4));
+	ASSERT_EQ(entry.startTime, 1006);
+	ASSERT_EQ(stringifyCharArray(4, (char*)name), "dev1");
+	assertArrayEq<byte, byte>(data, 0xAB, 0xCD);
+	ASSERT_EQ(cursor, 32);
+	ASSERT_FALSE(cache.readPage(cursor, entry, name, data, 4));
+}
+
+TEST_TRAITS(DataPageCacheTests, append_DuplicatePageIgnored,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	DataPageCache cache;
+	cache.init(128, 4, 3);
+	byte data0[2] = { 0xAB, 0xCD };
+
+	ASSERT_TRUE(cache.append((byte*)"dev0", 1000, 8, TimeScale::sec1, 2, data0));
+	ASSERT_TRUE(cache.append((byte*)"dev0", 1000, 8, TimeScale::sec1, 2, data0));
+	ASSERT_TRUE(cache.append((byte*)"dev1", 1000, 8, TimeScale::sec1, 2, data0));
+
+	ASSERT_EQ(cache.getNumPages(), 2);
+	ASSERT_EQ(cache.findPage((byte*)"dev1", 1000), 14);
+	ASSERT_EQ(cache.findPage((byte*)"dev1", 1001), cache._head);
+}
+
+TEST_TRAITS(DataPageCacheTests, append_WrapsAndDropsOldest,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	DataPageCache cache;
+	cache.init(32, 4, 3);
+	byte data[4] = { 1, 2, 3, 4 };
+	uint32_t cursor;
+	cache.getCursor(5, 1, cursor);
+
+	// Each page takes 16 bytes
+	ASSERT_TRUE(cache.append((byte*)"dev0", 100, 8, TimeScale::sec1, 4, data));
+	ASSERT_TRUE(cache.append((byte*)"dev0", 104, 8, TimeScale::sec1, 4, data));
+	data[0] = 9;
+	data[3] = 7;
+	ASSERT_TRUE(cache.append((byte*)"dev0", 108, 8, TimeScale::sec1, 4, data));
+
+	ASSERT_EQ(cache.getNumPages(), 2);
+	ASSERT_EQ(cache.getDroppedPages(), 1);
+	ASSERT_EQ(cache._tail, 16);
+	ASSERT_EQ(cache._head, 48);
+
+	DataPageCacheEntry entry;
+	byte name[4];
+	byte outData[4];
+	ASSERT_TRUE(cache.readPage(cursor, entry, name, outData, 4));
+	ASSERT_EQ(entry.startTime, 104);
+	ASSERT_TRUE(cache.readPage(cursor, entry, name, outData, 4));
+	ASSERT_EQ(entry.startTime, 108);
+	ASSERT_EQ(stringifyCharArray(4, (char*)name), "dev0");
+	assertArrayEq<byte, byte, byte, byte>(outData, 9, 2, 3, 7);
+	ASSERT_FALSE(cache.readPage(cursor, entry, name, outData, 4));
+}
+
+TEST_TRAITS(DataPageCacheTests, append_PositionWrapsPast32Bits,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	DataPageCache cache;
+	cache.init(32, 4, 3);
+	cache._head = 0xFFFFFFF8;
+	cache._tail = 0xFFFFFFF8;
+	byte data[4] = { 1, 2, 3, 4 };
+	uint32_t cursor;
+	cache.getCursor(5, 1, cursor);
+
+	// The second page starts past 2^32
+	ASSERT_TRUE(cache.append((byte*)"dev0", 100, 8, TimeScale::sec1, 4, data));
+	data[0] = 9;
+	ASSERT_TRUE(cache.append((byte*)"dev1", 104, 8, TimeScale::sec1, 4, data));
+	ASSERT_EQ(cache._head, 0x18);
+	ASSERT_EQ(cache.findPage((byte*)"dev1", 104), 0x8);
+
+	DataPageCacheEntry entry;
+	byte name[4];
+	byte outData[4];
+	ASSERT_TRUE(cache.readPage(cursor, entry, name, outData, 4));
+	ASSERT_EQ(entry.startTime, 100);
+	ASSERT_EQ(stringifyCharArray(4, (char*)name), "dev0");
+	assertArrayEq<byte, byte, byte, byte>(outData, 1, 2, 3, 4);
+	ASSERT_TRUE(cache.readPage(cursor, entry, name, outData, 4));
+	ASSERT_EQ(entry.startTime, 104);
+	ASSERT_EQ(stringifyCharArray(4, (char*)name), "dev1");
+	assertArrayEq<byte, byte, byte, byte>(outData, 9, 2, 3, 4);
+	ASSERT_FALSE(cache.readPage(cursor, entry, name, outData, 4));
+}
+
+TEST_TRAITS(DataPageCacheTests, append_Failure_PageTooLarge,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	DataPageCache cache;
+	cache.init(16, 4, 3);
+	byte data[16];
+
+	ASSERT_FALSE(cache.append((byte*)"dev0", 100, 8, TimeScale::sec1, 16, data));
+	ASSERT_EQ(cache.getNumPages(), 0);
+}
+
+TEST_TRAITS(DataPageCacheTests, cursors_IndependentPerDestination,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	DataPageCache cache;
+	cache.init(128, 4, 2);
+	byte data[2] = { 0xAB, 0xCD };
+	cache.append((byte*)"dev0", 1000, 8, TimeScale::sec1, 2, data);
+
+	uint32_t cursor0;
+	uint32_t cursor1;
+	uint32_t cursor2;
+	ASSERT_TRUE(cache.getCursor(5, 1, cursor0));
+	ASSERT_TRUE(cache.getCursor(6, 1, cursor1));
+	ASSERT_FALSE(cache.getCursor(7, 1, cursor2));
+	ASSERT_EQ(cursor0, 0);
+	ASSERT_EQ(cursor1, 0);
+
+	ASSERT_TRUE(cache.setCursor(5, 1, 14));
+	ASSERT_TRUE(cache.getCursor(5, 1, cursor0));
+	ASSERT_TRUE(cache.getCursor(6, 1, cursor1));
+	ASSERT_EQ(cursor0, 14);
+	ASSERT_EQ(cursor1, 0);
+	ASSERT_FALSE(cache.hasPendingPages(cursor0));
+	ASSERT_TRUE(cache.hasPendingPages(cursor1));
+
+	cache.removeDestination(5, 1);
+	ASSERT_TRUE(cache.getCursor(7, 1, cursor2));
+	ASSERT_EQ(cursor2, 0);
+
+	cache.removeDestinationsForSlave(6);
+	ASSERT_EQ(cache._destinations[1].slaveId, 0);
+	ASSERT_EQ(cache._destinations[0].slaveId, 7);
+}
@@ -0,0 +1,231 @@
+#include "pch.h"
+#include "../kwh-modbus/libraries/deviceDirectory/DeviceDirectory.hpp"
+#include "../kwh-modbus/libraries/deviceDirectoryJournal/DeviceDirectoryJournal.hpp"
+#include "../kwh-modbus/libraries/deviceDirectoryJournal/FileJournalStorage.hpp"
+#include "test_helpers.h"
+#include "../kwh-modbus/noArduino/ArduinoMacros.h"
+
+#include <stdlib.h>
+#include <vector>
+
+using namespace std;
+
+// Erased EEPROM that counts writes, and can be made to fail them
+class MemoryJournalStorage : public JournalStorage
+{
+public:
+	vector<byte> cells;
+	uint32_t writes = 0;
+	bool failWrites = false;
+
+	MemoryJournalStorage(uint32_t size) : cells(size, 0xFF)
+	{
+	}
+
+	uint32_t getSize()
+	{
+		return cells.size();
+	}
+
+	bool read(uint32_t address, byte *data, word length)
+	{
+		for (word i = 0; i < length; i++)
+		{
+			data[i] = cells[address + i];
+		}
+		return true;
+	}
+
+	bool write(uint32_t address, byte *data, word length)
+	{
+		if (failWrites)
+			return false;
+		for (word i = 0; i < length; i++)
+		{
+			cells[address + i] = data[i];
+		}
+		writes++;
+		return true;
+	}
+};
+
+void assertSameRows(DeviceDirectory &expected, DeviceDirectory &actual)
+{
+	for (int row = 0; row < expected._maxDevices; row++)
+	{
+		ASSERT_EQ(actual._devices[row].slaveId, expected._devices[row].slaveId);
+		if (expected._devices[row].slaveId == 0)
+			continue;
+		ASSERT_EQ(actual._devices[row], expected._devices[row]);
+		ASSERT_EQ(memcmp(actual.getDeviceName(row), expected.getDeviceName(row), expected._deviceNameLength), 0);
+	}
+}
+
+TEST_TRAITS(DeviceDirectoryJournalTests, restoreFromJournal_ReplaysChanges,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	MemoryJournalStorage storage(2000);
+	DeviceDirectoryJournal journal;
+	ASSERT_TRUE(journal.init(&storage, 4, 8));
+	DeviceDirectory directory;
+	directory.init(4, 8);
+	directory.setJournal(&journal);
+
+	directory.addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 1, 10));
+	directory.addDevice((byte*)"dev1", DeviceDirectoryRow(2, 1, 2 << 14, 10));
+	uint32_t writes = storage.writes;
+	directory.addDevice((byte*)"dev2", DeviceDirectoryRow(3, 0, 1, 12));
+	directory.clearDeviceDirectoryRow(0);
+	directory.addOrReplaceDevice((byte*)"dev1", DeviceDirectoryRow(2, 1, 2 << 14, 20));
+	// One small record per change
+	ASSERT_EQ(storage.writes, writes + 3);
+
+	DeviceDirectoryJournal bootJournal;
+	ASSERT_TRUE(bootJournal.init(&storage, 4, 8));
+	DeviceDirectory restored;
+	restored.init(4, 8);
+	restored.setJournal(&bootJournal);
+	ASSERT_TRUE(restored.restoreFromJournal());
+
+	assertSameRows(directory, restored);
+	int row;
+	ASSERT_EQ(restored.findDeviceForName((byte*)"dev1", row)->deviceRegs, 20);
+	ASSERT_EQ(restored.findDeviceForName((byte*)"dev0", row), nullptr);
+}
+
+TEST_TRAITS(DeviceDirectoryJournalTests, restoreFromJournal_WrapsAroundStorage,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Room for 25 records of 20 bytes
+	MemoryJournalStorage storage(500);
+	DeviceDirectoryJournal journal;
+	ASSERT_TRUE(journal.init(&storage, 4, 6));
+	DeviceDirectory directory;
+	directory.init(4, 6);
+	directory.setJournal(&journal);
+
+	for (int i = 0; i < 300; i++)
+	{
+		byte name[4] = { 'd', 'e', 'v', (byte)('0' + i % 5) };
+		if (i % 7 == 3)
+			directory.clearDeviceDirectoryRow(i % 6);
+		else
+			directory.addOrReplaceDevice(name, DeviceDirectoryRow(2 + i % 5, 0, 1, i));
+	}
+	ASSERT_GT(journal._nextSequence, 10 * journal.getCapacity());
+
+	DeviceDirectoryJournal bootJournal;
+	ASSERT_TRUE(bootJournal.init(&storage, 4, 6));
+	DeviceDirectory restored;
+	restored.init(4, 6);
+	restored.setJournal(&bootJournal);
+	ASSERT_TRUE(restored.restoreFromJournal());
+
+	assertSameRows(directory, restored);
+}
+
+TEST_TRAITS(DeviceDirectoryJournalTests, restoreFromJournal_TornRecord,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	MemoryJournalStorage storage(2000);
+	DeviceDirectoryJournal journal;
+	journal.init(&storage, 4, 8);
+	DeviceDirectory directory;
+	directory.init(4, 8);
+	directory.setJournal(&journal);
+	directory.addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 1, 10));
+	directory.addDevice((byte*)"dev1", DeviceDirectoryRow(3, 0, 1, 10));
+
+	// Reset partway through writing the newest record
+	uint32_t newest = journal._nextSequence - 1;
+	storage.cells[journal.getAddress(newest) + 9] ^= 0x5A;
+
+	DeviceDirectoryJournal bootJournal;
+	bootJournal.init(&storage, 4, 8);
+	DeviceDirectory restored;
+	restored.init(4, 8);
+	restored.setJournal(&bootJournal);
+	ASSERT_TRUE(restored.restoreFromJournal());
+
+	int row;
+	ASSERT_NE(restored.findDeviceForName((byte*)"dev0", row), nullptr);
+	ASSERT_EQ(restored.findDeviceForName((byte*)"dev1", row), nullptr);
+	ASSERT_EQ(bootJournal._nextSequence, newest);
+}
+
+TEST_TRAITS(DeviceDirectoryJournalTests, restoreFromJournal_FailedWriteSavedByCheckpoint,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	MemoryJournalStorage storage(2000);
+	DeviceDirectoryJournal journal;
+	journal.init(&storage, 4, 8);
+	DeviceDirectory directory;
+	directory.init(4, 8);
+	directory.setJournal(&journal);
+	directory.addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 1, 10));
+
+	storage.failWrites = true;
+	directory.addDevice((byte*)"dev1", DeviceDirectoryRow(3, 0, 1, 10));
+	storage.failWrites = false;
+	ASSERT_EQ(journal.getWriteFailures(), 1);
+	ASSERT_TRUE(journal.needsCheckpoint(2));
+	directory.addDevice((byte*)"dev2", DeviceDirectoryRow(4, 0, 1, 10));
+	ASSERT_FALSE(journal.needsCheckpoint(3));
+
+	DeviceDirectoryJournal bootJournal;
+	bootJournal.init(&storage, 4, 8);
+	DeviceDirectory restored;
+	restored.init(4, 8);
+	restored.setJournal(&bootJournal);
+	ASSERT_TRUE(restored.restoreFromJournal());
+
+	assertSameRows(directory, restored);
+}
+
+TEST_TRAITS(DeviceDirectoryJournalTests, init_StorageTooSmall,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	MemoryJournalStorage storage(100);
+	DeviceDirectoryJournal journal;
+
+	ASSERT_FALSE(journal.init(&storage, 4, 8));
+	ASSERT_FALSE(journal.isReady());
+	ASSERT_FALSE(journal.append(JournalOp::put, 0, (byte*)"dev0", DeviceDirectoryRow()));
+}
+
+// Uses a file in /tmp, so it is only run on Linux
+#ifdef __linux__
+TEST_TRAITS(DeviceDirectoryJournalTests, FileJournalStorage_ReopenedFile,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	char path[32];
+	strcpy(path, "/tmp/kwhJournalXXXXXX");
+	int fd = mkstemp(path);
+	ASSERT_NE(fd, -1);
+	close(fd);
+	{
+		FileJournalStorage storage;
+		ASSERT_TRUE(storage.open(path, 1000));
+		DeviceDirectoryJournal journal;
+		ASSERT_TRUE(journal.init(&storage, 4, 8));
+		DeviceDirectory directory;
+		directory.init(4, 8);
+		directory.setJournal(&journal);
+		directory.addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 1, 10));
+		directory.addDevice((byte*)"dev1", DeviceDirectoryRow(3, 0, 1, 10));
+	}
+
+	FileJournalStorage storage;
+	ASSERT_TRUE(storage.open(path, 1000));
+	DeviceDirectoryJournal journal;
+	ASSERT_TRUE(journal.init(&storage, 4, 8));
+	DeviceDirectory restored;
+	restored.init(4, 8);
+	restored.setJournal(&journal);
+	ASSERT_TRUE(restored.restoreFromJournal());
+	int row;
+	ASSERT_NE(restored.findDeviceForName((byte*)"dev1", row), nullptr);
+	storage.close();
+	remove(path);
+}
+#endif
@@ -166,11 +166,46 @@ TEST_F_TRAITS(DeviceDirectoryTests, init_maxMemory,
 	Mock<DeviceDirectory> mock = getMock();
 	Fake(OverloadedMethod(mock, init, void(word, word)));
 
+	word numDevices;
+	deviceDirectory->init(2000, 11, numDevices);
+
+	ASSERT_EQ(numDevices, 35);
+	Verify(OverloadedMethod(mock, init, void(word, word)).Using(11, 35)).Once();
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, init_maxMemory_TooSmall,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	Mock<DeviceDirectory> mock = getMock();
+	Fake(OverloadedMethod(mock, init, void(word, word)));
+
 	word numDevices;
 	deviceDirectory->init(500, 11, numDevices);
 
-	ASSERT_EQ(numDevices, 26);
-	Verify(OverloadedMethod(mock, init, void(word, word)).Using(11, 26)).Once();
+	ASSERT_EQ(numDevices, 0);
+	Verify(OverloadedMethod(mock, init, void(word, word)).Using(11, 0)).Once();
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, init_maxMemory_PackedRows,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	word numDevices;
+	deviceDirectory->init(8192, 8, numDevices);
+
+	ASSERT_EQ(sizeof(DeviceDirectoryRow), 7);
+	ASSERT_EQ(numDevices, 190);
+	// Everything init allocated
+	uint32_t allocated = numDevices * (sizeof(DeviceDirectoryRow) + 8 + sizeof(uint32_t) + sizeof(byte));
+	allocated += ((uint32_t)deviceDirectory->_indexMask + 1) * sizeof(DeviceRowIndex);
+	allocated += numDevices * (7 * sizeof(DeviceRowIndex) + sizeof(byte)) + 256 * sizeof(DeviceRowIndex);
+	ASSERT_NE(deviceDirectory->_index, nullptr);
+	ASSERT_TRUE(deviceDirectory->_rowsTracked);
+	ASSERT_LE(allocated, 8192);
+	ASSERT_EQ(DeviceDirectory::getMemoryUsage(8, numDevices), allocated);
+	ASSERT_GT(DeviceDirectory::getMemoryUsage(8, numDevices + 1), 8192);
+	deviceDirectory->insertIntoRow(189, (byte*)"device01", DeviceDirectoryRow(9, 300, 0x8001, 12));
+	ASSERT_EQ(deviceDirectory->_devices[189], DeviceDirectoryRow(9, 300, 0x8001, 12));
+	ASSERT_EQ(deviceDirectory->_devices[189].deviceRegs, 12);
 }
 
 TEST_F_TRAITS(DeviceDirectoryTests, findDeviceForName_empty,
@@ -1185,4 +1220,358 @@ TEST_F_TRAITS(DeviceDirectoryTests, findNextDevice_NoCondition_Case2_2,
 	auto result = deviceDirectory->findNextDevice(resultName, row);
 	ASSERT_EQ(row, -1);
 	ASSERT_EQ(result, nullptr);
-}
\ No newline at end of file
+}
+TEST_F_TRAITS(DeviceDirectoryTests, recordDeviceNoResponse_Suspends,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	deviceDirectory->init(4, 3);
+	deviceDirectory->addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 1, 0));
+	deviceDirectory->addDevice((byte*)"dev1", DeviceDirectoryRow(3, 0, 1, 0));
+	auto device = deviceDirectory->_devices + 0;
+
+	ASSERT_EQ(deviceDirectory->recordDeviceNoResponse(device), DeviceLivenessState::live);
+	ASSERT_EQ(deviceDirectory->recordDeviceNoResponse(device), DeviceLivenessState::live);
+	auto version = deviceDirectory->getVersion();
+	ASSERT_EQ(deviceDirectory->recordDeviceNoResponse(device), DeviceLivenessState::suspended);
+	ASSERT_EQ(deviceDirectory->getVersion(), version + 1);
+
+	int row = 0;
+	byte *name;
+	ASSERT_EQ(deviceDirectory->findNextDevice(name, row), deviceDirectory->_devices + 1);
+	ASSERT_EQ(deviceDirectory->findNextDevice(name, row), nullptr);
+	row = 0;
+	ASSERT_EQ(deviceDirectory->findNextSuspendedDevice(name, row), device);
+	ASSERT_EQ(deviceDirectory->findNextSuspendedDevice(name, row), nullptr);
+	ASSERT_EQ(row, -1);
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, recordDeviceResponse_Readmits,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	deviceDirectory->init(4, 3);
+	deviceDirectory->addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 1, 0));
+	auto device = deviceDirectory->_devices + 0;
+	for (int i = 0; i < 3; i++)
+	{
+		deviceDirectory->recordDeviceNoResponse(device);
+	}
+
+	deviceDirectory->recordDeviceResponse(device, 1234);
+
+	int row = 0;
+	byte *name;
+	DeviceLiveness liveness;
+	ASSERT_EQ(deviceDirectory->findNextDevice(name, row), device);
+	ASSERT_TRUE(deviceDirectory->getDeviceLiveness(device, liveness));
+	ASSERT_EQ(liveness.lastSeen, 1234);
+	ASSERT_EQ(liveness.failures, 0);
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, recordDeviceNoResponse_Evicts,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	deviceDirectory->init(4, 3);
+	deviceDirectory->setLivenessThresholds(2, 4);
+	deviceDirectory->addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 1, 0));
+	auto device = deviceDirectory->_devices + 0;
+	for (int i = 0; i < 3; i++)
+	{
+		deviceDirectory->recordDeviceNoResponse(device);
+	}
+
+	ASSERT_EQ(deviceDirectory->recordDeviceNoResponse(device), DeviceLivenessState::evicted);
+	ASSERT_TRUE(deviceDirectory->isEmpty());
+
+	// Found again by discovery
+	deviceDirectory->addOrReplaceDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 1, 0));
+	int row = 0;
+	byte *name;
+	ASSERT_EQ(deviceDirectory->findNextDevice(name, row), device);
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, recordDeviceNoResponse_EvictedSlaveIdQuarantined,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	deviceDirectory->init(4, 3);
+	deviceDirectory->setLivenessThresholds(2, 4);
+	deviceDirectory->addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 1, 0));
+	deviceDirectory->addDevice((byte*)"dev1", DeviceDirectoryRow(3, 0, 1, 0));
+	deviceDirectory->addDevice((byte*)"dev2", DeviceDirectoryRow(3, 1, 1, 0));
+	for (int i = 0; i < 4; i++)
+	{
+		deviceDirectory->recordDeviceNoResponse(deviceDirectory->_devices + 0);
+		deviceDirectory->recordDeviceNoResponse(deviceDirectory->_devices + 1);
+	}
+
+	// The slaves still answer at 2 and 3, so neither is handed out
+	ASSERT_TRUE(deviceDirectory->isSlaveIdQuarantined(2));
+	ASSERT_TRUE(deviceDirectory->isSlaveIdQuarantined(3));
+	ASSERT_EQ(deviceDirectory->findFreeSlaveID(), 4);
+	// Slave 3 still has a live device, so only slave 2 needs to be sent back to discovery
+	ASSERT_EQ(deviceDirectory->findNextQuarantinedSlaveId(0), 2);
+	ASSERT_EQ(deviceDirectory->findNextQuarantinedSlaveId(2), 0);
+
+	deviceDirectory->releaseQuarantinedSlaveId(2);
+	ASSERT_EQ(deviceDirectory->findFreeSlaveID(), 2);
+	ASSERT_EQ(deviceDirectory->findNextQuarantinedSlaveId(0), 0);
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, recordDeviceNoResponse_ReservedSlaveIdNotQuarantined,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	deviceDirectory->init(4, 3);
+	deviceDirectory->setLivenessThresholds(2, 4);
+	deviceDirectory->reserveSlaveIds(20, 20);
+	deviceDirectory->addDevice((byte*)"dev0", DeviceDirectoryRow(20, 0, 1, 0));
+	for (int i = 0; i < 4; i++)
+	{
+		deviceDirectory->recordDeviceNoResponse(deviceDirectory->_devices + 0);
+	}
+
+	ASSERT_TRUE(deviceDirectory->isEmpty());
+	ASSERT_FALSE(deviceDirectory->isSlaveIdQuarantined(20));
+	ASSERT_EQ(deviceDirectory->findNextQuarantinedSlaveId(0), 0);
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, findDeviceForName_Indexed,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	for (word numRows : { 16, 256, 4096 })
+	{
+		DeviceDirectory directory;
+		directory.init(4, numRows);
+		ASSERT_TRUE(directory._index != nullptr);
+		byte name[4] = { 'd', 0, 0, 0 };
+		for (word i = 0; i < numRows; i++)
+		{
+			name[1] = (byte)i;
+			name[2] = (byte)(i >> 8);
+			ASSERT_EQ(directory.addDevice(name, DeviceDirectoryRow(2 + i % 200, i % 5, 1, 0)), i);
+		}
+
+		// Clearing every third row moves later entries back in their probe sequences
+		for (word i = 0; i < numRows; i += 3)
+		{
+			directory.clearDeviceDirectoryRow(i);
+		}
+		int row;
+		for (word i = 0; i < numRows; i++)
+		{
+			name[1] = (byte)i;
+			name[2] = (byte)(i >> 8);
+			auto device = directory.findDeviceForName(name, row);
+			if (i % 3 == 0)
+			{
+				ASSERT_EQ(device, nullptr);
+				ASSERT_EQ(row, -1);
+			}
+			else
+			{
+				ASSERT_EQ(device, directory._devices + i);
+				ASSERT_EQ(row, i);
+			}
+		}
+
+		// Row 1 gets a new name, and the name cleared from row 0 comes back in a free row
+		name[1] = 0;
+		name[2] = 0;
+		name[3] = 'x';
+		directory.insertIntoRow(1, name, DeviceDirectoryRow(2, 0, 1, 0));
+		name[3] = 0;
+		int freeRow = directory.findFreeRow();
+		ASSERT_EQ(directory.addOrReplaceDevice(name, DeviceDirectoryRow(3, 0, 1, 0)), freeRow);
+		ASSERT_EQ(directory.findDeviceForName(name, row), directory._devices + freeRow);
+		name[1] = 1;
+		ASSERT_EQ(directory.findDeviceForName(name, row), nullptr);
+		name[1] = 0;
+		name[3] = 'x';
+		ASSERT_EQ(directory.findDeviceForName(name, row), directory._devices + 1);
+	}
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, findFreeSlaveID_Tracked,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	deviceDirectory->init(4, 6);
+	deviceDirectory->addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 1, 0));
+	deviceDirectory->addDevice((byte*)"dev1", DeviceDirectoryRow(2, 1, 1, 0));
+	deviceDirectory->addDevice((byte*)"dev2", DeviceDirectoryRow(3, 0, 1, 0));
+	ASSERT_EQ(deviceDirectory->findFreeSlaveID(), 4);
+
+	// Slave 2 still has a device after one of its rows is cleared
+	deviceDirectory->clearDeviceDirectoryRow(0);
+	ASSERT_TRUE(deviceDirectory->isSlaveIdUsed(2));
+	ASSERT_EQ(deviceDirectory->findFreeSlaveID(), 4);
+	deviceDirectory->clearDeviceDirectoryRow(1);
+	ASSERT_FALSE(deviceDirectory->isSlaveIdUsed(2));
+	ASSERT_EQ(deviceDirectory->findFreeSlaveID(), 2);
+
+	// Replacing a row moves its slave to the new ID
+	deviceDirectory->insertIntoRow(2, (byte*)"dev2", DeviceDirectoryRow(5, 0, 1, 0));
+	ASSERT_FALSE(deviceDirectory->isSlaveIdUsed(3));
+	ASSERT_TRUE(deviceDirectory->isSlaveIdUsed(5));
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, findFreeSlaveID_ReservedAndPool,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	deviceDirectory->init(4, 6);
+	deviceDirectory->reserveSlaveIds(2, 9);
+	ASSERT_EQ(deviceDirectory->findFreeSlaveID(), 10);
+
+	// A second bus hands out 100 to 101
+	ASSERT_TRUE(deviceDirectory->setSlaveIdPool(100, 101));
+	ASSERT_FALSE(deviceDirectory->setSlaveIdPool(100, 247));
+	ASSERT_FALSE(deviceDirectory->setSlaveIdPool(1, 101));
+	deviceDirectory->addDevice((byte*)"dev0", DeviceDirectoryRow(100, 0, 1, 0));
+	ASSERT_EQ(deviceDirectory->findFreeSlaveID(), 101);
+	deviceDirectory->addDevice((byte*)"dev1", DeviceDirectoryRow(101, 0, 1, 0));
+	ASSERT_EQ(deviceDirectory->findFreeSlaveID(), 0);
+
+	deviceDirectory->setSlaveIdPool(2, 246);
+	deviceDirectory->reserveSlaveIds(2, 9, false);
+	ASSERT_EQ(deviceDirectory->findFreeSlaveID(), 2);
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, freeRows_ReusedAndSkipped,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	deviceDirectory->init(4, 6);
+	deviceDirectory->addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 1, 0));
+	deviceDirectory->addDevice((byte*)"dev1", DeviceDirectoryRow(2, 1, 1, 0));
+	deviceDirectory->addDevice((byte*)"dev2", DeviceDirectoryRow(3, 0, 1, 0));
+	deviceDirectory->addDevice((byte*)"dev3", DeviceDirectoryRow(4, 0, 1, 0));
+	deviceDirectory->clearDeviceDirectoryRow(1);
+	deviceDirectory->clearDeviceDirectoryRow(2);
+
+	// No markers are left in cleared rows
+	ASSERT_EQ(deviceDirectory->_devices[1], DeviceDirectoryRow());
+	ASSERT_EQ(deviceDirectory->_liveCount, 2);
+
+	int row = 0;
+	byte *name;
+	ASSERT_EQ(deviceDirectory->findNextDevice(name, row), deviceDirectory->_devices + 0);
+	ASSERT_EQ(deviceDirectory->findNextDevice(name, row), deviceDirectory->_devices + 3);
+	ASSERT_EQ(row, 4);
+	ASSERT_EQ(deviceDirectory->findNextDevice(name, row), nullptr);
+	ASSERT_EQ(row, -1);
+
+	// The most recently cleared row is used first
+	ASSERT_EQ(deviceDirectory->addDevice((byte*)"dev4", DeviceDirectoryRow(5, 0, 1, 0)), 2);
+	ASSERT_EQ(deviceDirectory->addDevice((byte*)"dev5", DeviceDirectoryRow(5, 1, 1, 0)), 1);
+	ASSERT_EQ(deviceDirectory->addDevice((byte*)"dev6", DeviceDirectoryRow(5, 2, 1, 0)), 4);
+	ASSERT_EQ(deviceDirectory->filterDevicesForSlave(nullptr, 0, 5), 3);
+	ASSERT_EQ(deviceDirectory->_liveCount, 2);
+	ASSERT_FALSE(deviceDirectory->isEmpty());
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, compact,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	deviceDirectory->init(4, 6);
+	for (byte i = 0; i < 6; i++)
+	{
+		byte name[4] = { 'd', 'e', 'v', (byte)('0' + i) };
+		deviceDirectory->addDevice(name, DeviceDirectoryRow(2 + i, 0, 1, 0));
+	}
+	deviceDirectory->clearDeviceDirectoryRow(0);
+	deviceDirectory->clearDeviceDirectoryRow(2);
+	deviceDirectory->recordDeviceResponse(deviceDirectory->_devices + 5, 1234);
+	auto version = deviceDirectory->getVersion();
+
+	ASSERT_EQ(deviceDirectory->compact(1), 1);
+	ASSERT_EQ(deviceDirectory->compact(5), 1);
+	ASSERT_EQ(deviceDirectory->compact(5), 0);
+	ASSERT_EQ(deviceDirectory->getVersion(), version + 2);
+
+	// dev5 moved to row 0 and dev4 to row 2
+	int row;
+	ASSERT_EQ(deviceDirectory->findDeviceForName((byte*)"dev5", row), deviceDirectory->_devices);
+	ASSERT_EQ(deviceDirectory->_devices[0].slaveId, 7);
+	ASSERT_EQ(deviceDirectory->findDeviceForName((byte*)"dev4", row), deviceDirectory->_devices + 2);
+	DeviceLiveness liveness;
+	ASSERT_TRUE(deviceDirectory->getDeviceLiveness(deviceDirectory->_devices, liveness));
+	ASSERT_EQ(liveness.lastSeen, 1234);
+	ASSERT_EQ(deviceDirectory->findFreeRow(), 4);
+	ASSERT_EQ(deviceDirectory->_devices[5], DeviceDirectoryRow());
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, findNextByRole,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	word sec1, min1, hr1;
+	DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(false, TimeScale::sec1, 8, sec1);
+	DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(false, TimeScale::min1, 8, min1);
+	DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(true, TimeScale::hr1, 8, hr1);
+	deviceDirectory->init(4, 8);
+	deviceDirectory->addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, min1, 0));
+	deviceDirectory->addDevice((byte*)"dev1", DeviceDirectoryRow(2, 1, 2 << 14, 0));
+	deviceDirectory->addDevice((byte*)"dev2", DeviceDirectoryRow(3, 0, sec1, 0));
+	deviceDirectory->addDevice((byte*)"dev3", DeviceDirectoryRow(3, 1, 1, 0));
+	deviceDirectory->addDevice((byte*)"dev4", DeviceDirectoryRow(4, 0, hr1, 0));
+	deviceDirectory->addDevice((byte*)"dev5", DeviceDirectoryRow(4, 1, 2 << 14, 0));
+	deviceDirectory->addDevice((byte*)"dev6", DeviceDirectoryRow(2, 2, sec1, 0));
+	byte *name;
+	int cursor = 0;
+
+	ASSERT_EQ(deviceDirectory->findNextTransmitter(name, cursor), deviceDirectory->_devices + 1);
+	ASSERT_EQ(deviceDirectory->findNextTransmitter(name, cursor), deviceDirectory->_devices + 5);
+	ASSERT_EQ(deviceDirectory->findNextTransmitter(name, cursor), nullptr);
+	ASSERT_EQ(cursor, -1);
+
+	cursor = 0;
+	ASSERT_EQ(deviceDirectory->findNextTimeServer(name, cursor), deviceDirectory->_devices + 3);
+	ASSERT_EQ(deviceDirectory->findNextTimeServer(name, cursor), nullptr);
+
+	// One timescale at a time, up to the last one in the range
+	cursor = 0;
+	ASSERT_EQ(deviceDirectory->findNextCollector(name, cursor, TimeScale::ms250, TimeScale::min1), deviceDirectory->_devices + 2);
+	ASSERT_EQ(deviceDirectory->findNextCollector(name, cursor, TimeScale::ms250, TimeScale::min1), deviceDirectory->_devices + 6);
+	ASSERT_TRUE(deviceDirectory->compareName(cursor - 1, (byte*)"dev6"));
+	ASSERT_EQ(deviceDirectory->findNextCollector(name, cursor, TimeScale::ms250, TimeScale::min1), deviceDirectory->_devices + 0);
+	ASSERT_EQ(deviceDirectory->findNextCollector(name, cursor, TimeScale::ms250, TimeScale::min1), nullptr);
+	ASSERT_EQ(cursor, -1);
+
+	cursor = 0;
+	ASSERT_EQ(deviceDirectory->findNextDeviceForSlave(2, name, cursor), deviceDirectory->_devices + 0);
+	ASSERT_EQ(deviceDirectory->findNextDeviceForSlave(2, name, cursor), deviceDirectory->_devices + 1);
+	ASSERT_EQ(deviceDirectory->findNextDeviceForSlave(2, name, cursor), deviceDirectory->_devices + 6);
+	ASSERT_EQ(deviceDirectory->findNextDeviceForSlave(2, name, cursor), nullptr);
+
+	// A device that changes role moves to its new list
+	deviceDirectory->insertIntoRow(6, (byte*)"dev6", DeviceDirectoryRow(4, 2, 2 << 14, 0));
+	cursor = 0;
+	ASSERT_EQ(deviceDirectory->findNextTransmitter(name, cursor), deviceDirectory->_devices + 1);
+	ASSERT_EQ(deviceDirectory->findNextTransmitter(name, cursor), deviceDirectory->_devices + 5);
+	ASSERT_EQ(deviceDirectory->findNextTransmitter(name, cursor), deviceDirectory->_devices + 6);
+	cursor = 0;
+	ASSERT_EQ(deviceDirectory->findNextCollector(name, cursor, TimeScale::sec1, TimeScale::sec1), deviceDirectory->_devices + 2);
+	ASSERT_EQ(deviceDirectory->findNextCollector(name, cursor, TimeScale::sec1, TimeScale::sec1), nullptr);
+	ASSERT_EQ(deviceDirectory->filterDevicesForSlave(nullptr, 0, 4), 3);
+	cursor = 0;
+	ASSERT_EQ(deviceDirectory->findNextDeviceForSlave(4, name, cursor), nullptr);
+}
+
+TEST_F_TRAITS(DeviceDirectoryTests, findNextByRole_RemovedWhileIterating,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	deviceDirectory->init(4, 6);
+	deviceDirectory->setLivenessThresholds(1, 2);
+	for (byte i = 0; i < 5; i++)
+	{
+		byte name[4] = { 'd', 'e', 'v', (byte)('0' + i) };
+		deviceDirectory->addDevice(name, DeviceDirectoryRow(2 + i, 0, 2 << 14, 0));
+	}
+	byte *name;
+	int cursor = 0;
+
+	ASSERT_EQ(deviceDirectory->findNextTransmitter(name, cursor), deviceDirectory->_devices + 0);
+	ASSERT_EQ(deviceDirectory->findNextTransmitter(name, cursor), deviceDirectory->_devices + 1);
+	// The row a scan is on can be evicted, and suspended rows are skipped
+	deviceDirectory->clearDeviceDirectoryRow(1);
+	deviceDirectory->clearDeviceDirectoryRow(2);
+	ASSERT_EQ(deviceDirectory->recordDeviceNoResponse(deviceDirectory->_devices + 3), DeviceLivenessState::suspended);
+	ASSERT_EQ(deviceDirectory->findNextTransmitter(name, cursor), deviceDirectory->_devices + 4);
+	ASSERT_EQ(deviceDirectory->findNextTransmitter(name, cursor), nullptr);
+	ASSERT_EQ(cursor, -1);
+}
@@ -324,7 +324,7 @@ TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_checkForN
 	ASSERT_TRUE(modbusMaster->isReadRegsResponse(count, regs));
 	ASSERT_EQ(count, 8);
 	assertArrayEq<word, byte, byte, word, word, word, word, word, word>(regs,
-		sIdle, 0, 1, 2, 5, 13, 0, 0, 0);
+		sIdle, 1, 1, 2, 5, 13, 0, 0, 0);
 	ASSERT_TRUE(slaveSuccess);
 	ASSERT_TRUE(masterSuccess);
 	ASSERT_EQ(task.result(), found);
@@ -472,7 +472,7 @@ TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_broadcast
 TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_transferPendingData_SinglePage_SlaveTimeNotSet,
 	Type, Integration, Threading, Multi, Determinism, Volatile, Case, Edge)
 {
-	MockNewMethod(mockReadData, uint32_t startTime, word numPoints, byte page, word bufferSize, byte maxPoints);
+	MockNewMethod(mockReadData, uint32_t startTime, word numPoints, word page, word bufferSize, word maxPoints);
 	MockNewMethod(mockPrepareReceiveData, word nameLength, uint32_t startTime,
 		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount);
 	MockNewMethod(mockRecieveData, byte dataPointsInPage, byte dataPointSize,
@@ -495,14 +495,14 @@ TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_transferP
 	string sendingDeviceName;
 
 	When(Method(device0, prepareReceiveData)).AlwaysDo([&mockPrepareReceiveData, &sendingDeviceName](word nameLength, byte* name, uint32_t startTime,
-		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, byte &outDataPointsPerPage) {
+		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, word &outDataPointsPerPage) {
 		mockPrepareReceiveData.get().method(nameLength, startTime, dataPointSize, dataTimeScale, dataPointsCount);
 		sendingDeviceName = stringifyCharArray(nameLength, (char*)name);
 		outDataPointsPerPage = 4;
 		return RecieveDataStatus::success;
 	});
-	When(Method(device0, receiveDeviceData)).AlwaysDo([&mockRecieveData](byte dataPointsInPage, byte dataPointSize,
-		TimeScale timeScale, byte pageNumber, byte* dataPoints)
+	When(Method(device0, receiveDeviceData)).AlwaysDo([&mockRecieveData](word dataPointsInPage, byte dataPointSize,
+		TimeScale timeScale, word pageNumber, byte* dataPoints)
 	{
 		uint32_t data = 0;
 		for (int i = 0; i < dataPointsInPage; i++)
@@ -513,8 +513,8 @@ TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_transferP
 		mockRecieveData.get().method(dataPointsInPage, dataPointSize, timeScale, pageNumber, data);
 		return RecieveDataStatus::success;
 	});
-	When(Method(device1, readData)).AlwaysDo([&mockReadData] (uint32_t startTime, word numPoints, byte page,
-		byte* buffer, word bufferSize, byte maxPoints, byte &outDataPointsCount, byte &outPagesRemaining, byte &outDataPointSize) {
+	When(Method(device1, readData)).AlwaysDo([&mockReadData] (uint32_t startTime, word numPoints, word page,
+		byte* buffer, word bufferSize, word maxPoints, word &outDataPointsCount, word &outPagesRemaining, byte &outDataPointSize) {
 		mockReadData.get().method(startTime, numPoints, page, bufferSize, maxPoints);
 		outDataPointsCount = 4;
 		outPagesRemaining = 0;
@@ -535,7 +535,7 @@ TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_transferP
 	T_Master::processNewSlave_Task task1(&T_Master::processNewSlave, master, false);
 	auto task2 = tracker.addPointer(getNewSetTestConditionsTask());
 	task2->isLongTest = true;
-	T_Master::transferPendingData_Task task3(&T_Master::transferPendingData, master, TimeScale::sec1, 6);
+	T_Master::transferPendingData_Task task3(&T_Master::transferPendingData, master, TimeScale::ms250, TimeScale::sec1, 6);
 
 	stack<ITask*> tasks;
 	tasks.push(&task3);
@@ -573,7 +573,7 @@ TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_transferP
 	ASSERT_TRUE(masterSuccess);
 	ASSERT_TRUE(timeSet);
 	ASSERT_EQ(sendingDeviceName, "dev01");
-	Verify(Method(mockReadData, method).Using(2, 4, 0, 20, 16)).AtLeastOnce();
+	Verify(Method(mockReadData, method).Using(2, 4, 0, 20, 26)).AtLeastOnce();
 	Verify(Method(mockPrepareReceiveData, method).Using(5, 2, 8, TimeScale::sec1, 4)).AtLeastOnce();
 	// Data pages recieved by the slave should match {{0, 1, 2}, {3}}, {{4, 5, 6}, {7}}
 	Verify(Method(mockRecieveData, method).Using(4, 8, TimeScale::sec1, 0,
@@ -586,7 +586,7 @@ TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_transferP
 TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_transferPendingData_MultiPage,
 	Type, Integration, Threading, Multi, Determinism, Volatile, Case, Typical)
 {
-	MockNewMethod(mockReadData, uint32_t startTime, word numPoints, byte page, word bufferSize, byte maxPoints);
+	MockNewMethod(mockReadData, uint32_t startTime, word numPoints, word page, word bufferSize, word maxPoints);
 	MockNewMethod(mockPrepareReceiveData, word nameLength, uint32_t startTime,
 		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount);
 	MockNewMethod(mockRecieveData, byte dataPointsInPage, byte dataPointSize,
@@ -598,14 +598,14 @@ TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_transferP
 	string sendingDeviceName;
 
 	When(Method(device0, prepareReceiveData)).AlwaysDo([&mockPrepareReceiveData, &sendingDeviceName](word nameLength, byte* name, uint32_t startTime,
-		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, byte &outDataPointsPerPage) {
+		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, word &outDataPointsPerPage) {
 		mockPrepareReceiveData.get().method(nameLength, startTime, dataPointSize, dataTimeScale, dataPointsCount);
 		sendingDeviceName = stringifyCharArray(nameLength, (char*)name);
 		outDataPointsPerPage = 3;
 		return RecieveDataStatus::success;
 	});
-	When(Method(device0, receiveDeviceData)).AlwaysDo([&mockRecieveData](byte dataPointsInPage, byte dataPointSize,
-		TimeScale timeScale, byte pageNumber, byte* dataPoints)
+	When(Method(device0, receiveDeviceData)).AlwaysDo([&mockRecieveData](word dataPointsInPage, byte dataPointSize,
+		TimeScale timeScale, word pageNumber, byte* dataPoints)
 	{
 		uint32_t data = 0;
 		for (int i = 0; i < dataPointsInPage; i++)
@@ -616,8 +616,8 @@ TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_transferP
 		mockRecieveData.get().method(dataPointsInPage, dataPointSize, timeScale, pageNumber, data);
 		return RecieveDataStatus::success;
 	});
-	When(Method(device1, readData)).AlwaysDo([&mockReadData](uint32_t startTime, word numPoints, byte page,
-		byte* buffer, word bufferSize, byte maxPoints, byte &outDataPointsCount, byte &outPagesRemaining, byte &outDataPointSize) {
+	When(Method(device1, readData)).AlwaysDo([&mockReadData](uint32_t startTime, word numPoints, word page,
+		byte* buffer, word bufferSize, word maxPoints, word &outDataPointsCount, word &outPagesRemaining, byte &outDataPointSize) {
 		mockReadData.get().method(startTime, numPoints, page, bufferSize, maxPoints);
 		outDataPointsCount = 4;
 		outPagesRemaining = 1 - page;
@@ -637,7 +637,7 @@ TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_transferP
 	T_Master::processNewSlave_Task task1(&T_Master::processNewSlave, master, false);
 	auto task2 = tracker.addPointer(getNewSetTestConditionsTask());
 	task2->isLongTest = true;
-	T_Master::transferPendingData_Task task3(&T_Master::transferPendingData, master, TimeScale::sec1, 10);
+	T_Master::transferPendingData_Task task3(&T_Master::transferPendingData, master, TimeScale::ms250, TimeScale::sec1, 10);
 
 	stack<ITask*> tasks;
 	tasks.push(&task3);
@@ -675,7 +675,7 @@ TEST_P_TRAITS(MasterSlaveIntegrationTests, MasterSlaveIntegrationTests_transferP
 	ASSERT_TRUE(slaveSuccess);
 	ASSERT_TRUE(masterSuccess);
 	ASSERT_EQ(sendingDeviceName, "dev01");
-	Verify(Method(mockReadData, method).Using(2, 8, 0, 20, 16)).AtLeastOnce();
+	Verify(Method(mockReadData, method).Using(2, 8, 0, 20, 26)).AtLeastOnce();
 	Verify(Method(mockPrepareReceiveData, method).Using(5, 2, 8, TimeScale::sec1, 4)).AtLeastOnce();
 	// Data pages recieved by the slave should match {{0, 1, 2}, {3}}, {{4, 5, 6}, {7}}
 	Verify(Method(mockRecieveData, method).Using(3, 8, TimeScale::sec1, 0,
@@ -12,6 +12,7 @@
 
 #include <queue>
 #include <tuple>
+#include <functional>
 
 using namespace fakeit;
 
@@ -49,10 +50,11 @@ protected:
 		master->config(system, modbus, &mockDeviceDirectory.get(), 10, 15);
 	}
 
-	word DataCollectorDeviceType(bool accumulateData, TimeScale timeScale, byte dataPacketSize)
+	word DataCollectorDeviceType(bool accumulateData, TimeScale timeScale, byte dataPacketSize,
+		PageEncoding pageEncoding = PageEncoding::raw)
 	{
 		word devType;
-		DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(accumulateData, timeScale, dataPacketSize, devType);
+		DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(accumulateData, timeScale, dataPacketSize, pageEncoding, devType);
 		return devType;
 	}
 
@@ -61,6 +63,49 @@ protected:
 		return 2 << 14;
 	}
 
+	// The filtered finders return the matching devices in the order they are in the vector
+	void Setup_FilteredFinders(vector<tuple<byte*, DeviceDirectoryRow>>* devices)
+	{
+		auto findNext = [devices](byte* &devName, int &row, function<bool(DeviceDirectoryRow&)> matches)
+		{
+			while (row < devices->size())
+			{
+				row++;
+				if (matches(get<1>((*devices)[row - 1])))
+				{
+					devName = get<0>((*devices)[row - 1]);
+					return &get<1>((*devices)[row - 1]);
+				}
+			}
+			row = -1;
+			return (DeviceDirectoryRow*)nullptr;
+		};
+
+		When(Method(mockDeviceDirectory, findNextTransmitter)).AlwaysDo([findNext](byte* &devName, int &row)
+		{
+			return findNext(devName, row, [](DeviceDirectoryRow &device) { return Device::isDataTransmitterDeviceType(device.deviceType); });
+		});
+		When(Method(mockDeviceDirectory, findNextTimeServer)).AlwaysDo([findNext](byte* &devName, int &row)
+		{
+			return findNext(devName, row, [](DeviceDirectoryRow &device) { return Device::isTimeServerDeviceType(device.deviceType); });
+		});
+		When(Method(mockDeviceDirectory, findNextCollector)).AlwaysDo([findNext](byte* &devName, int &row, TimeScale minTimeScale, TimeScale maxTimeScale)
+		{
+			return findNext(devName, row, [minTimeScale, maxTimeScale](DeviceDirectoryRow &device)
+			{
+				bool accumulateData;
+				TimeScale timeScale;
+				byte dataSize;
+				return DataCollectorDevice::getParametersFromDataCollectorDeviceType(device.deviceType, accumulateData, timeScale, dataSize) &&
+					timeScale >= minTimeScale && timeScale <= maxTimeScale;
+			});
+		});
+		When(Method(mockDeviceDirectory, findNextDeviceForSlave)).AlwaysDo([findNext](byte slaveId, byte* &devName, int &row)
+		{
+			return findNext(devName, row, [slaveId](DeviceDirectoryRow &device) { return device.slaveId == slaveId; });
+		});
+	}
+
 	vector<tuple<byte*, DeviceDirectoryRow>>* Setup_DataCollectorsAndTransmitters()
 	{
 		auto devices = new vector<tuple<byte*, DeviceDirectoryRow>>();
@@ -90,6 +135,7 @@ protected:
 				return (DeviceDirectoryRow*)nullptr;
 			}
 		});
+		Setup_FilteredFinders(devices);
 
 		return devices;
 	}
@@ -119,6 +165,7 @@ protected:
 				return (DeviceDirectoryRow*)nullptr;
 			}
 		});
+		Setup_FilteredFinders(devices);
 
 		return devices;
 	}
@@ -193,6 +240,7 @@ public:
 		modbus->init(registerArray, 0, 12, 20);
 		master->config(system, modbus, &mockDeviceDirectory.get(), 10, 20);
 		modbus->config(serial, system, 1200);
+		Fake(Method(mockDeviceDirectory, recordDeviceResponse), Method(mockDeviceDirectory, recordDeviceNoResponse));
 		tracker.addPointers(modbus, master, serial, system);
 		tracker.addArrays(registerArray);
 	}
@@ -204,6 +252,7 @@ public:
 		T_MASTER::completeModbusReadRegisters_Task::mock = nullptr;
 		T_MASTER::completeModbusWriteRegisters_Task::mock = nullptr;
 		T_MASTER::readAndSendDeviceData_Task::mock = nullptr;
+		T_MASTER::sendDataToDevice_Task::mock = nullptr;
 	}
 };
 
@@ -235,6 +284,20 @@ TEST_F_TRAITS(MasterTests, calculateMaxPointsPerReadPage_dataLimited_partialPoin
 	ASSERT_EQ(result, 9);
 }
 
+TEST_F_TRAITS(MasterTests, calculateMaxPointsPerReadPage_fullFrame,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	auto result = T_MASTER::calculateMaxPointsPerReadPage(1000, 123, 1);
+	ASSERT_EQ(result, 1856);
+}
+
+TEST_F_TRAITS(MasterTests, calculatePointsPerBroadcastPage_fullFrame,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	auto result = T_MASTER::calculatePointsPerBroadcastPage(123, 3);
+	ASSERT_EQ(result, 624);
+}
+
 TEST_F_TRAITS(MasterTests, ensureTaskNotStarted_NeedsReset_Doesnt,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
@@ -467,6 +530,53 @@ TEST_F_TRAITS(MasterTests, completeModbusWriteRegisters_single_CompletesImmediat
 	Verify(Method(modbusBaseMock, isWriteRegResponse)).Once();
 }
 
+TEST_F_TRAITS(MasterTests, completeModbusWriteRegisters_single_RecordsBusTime,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	modbus->config(serial, system, 9600);
+	MOCK_MASTER;
+	MOCK_MODBUS;
+	When(OverloadedMethod(masterMock, ensureTaskNotStarted, bool(T_MASTER::ensureTaskNotStarted_Param&))).Return(true);
+	When(OverloadedMethod(modbusTaskMock, work, bool())).AlwaysReturn(true);
+	When(Method(modbusTaskMock, getStatus)).AlwaysReturn(TaskComplete);
+	When(Method(modbusBaseMock, setRequest_WriteRegister)).AlwaysReturn(true);
+	When(Method(modbusBaseMock, isWriteRegResponse)).Return(true);
+	master->_busTimeCategory = BusTimeCategory::delivery;
+
+	word val = 6;
+	T_MASTER::completeModbusWriteRegisters_Task task(&T_MASTER::completeModbusWriteRegisters, master, 2, 3, 1, &val);
+	ASSERT_TRUE(task());
+
+	// 8 byte request and response, at 1145 us per character plus 6013 us frame delay
+	auto &busTime = master->getBusTimeAccounting();
+	ASSERT_EQ(busTime.getRequestCount(BusTimeCategory::delivery), 1);
+	ASSERT_EQ(busTime.getWireTime(BusTimeCategory::delivery), 2 * (8 * 1145 + 6013));
+	ASSERT_EQ(busTime.getRequestCount(BusTimeCategory::collection), 0);
+}
+
+TEST_F_TRAITS(MasterTests, completeModbusWriteRegisters_multiple_Broadcast_RecordsBusTime,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	modbus->config(serial, system, 38400);
+	MOCK_MASTER;
+	MOCK_MODBUS;
+	When(OverloadedMethod(masterMock, ensureTaskNotStarted, bool(T_MASTER::ensureTaskNotStarted_Param&))).Return(true);
+	When(OverloadedMethod(modbusTaskMock, work, bool())).AlwaysReturn(true);
+	When(Method(modbusTaskMock, getStatus)).AlwaysReturn(TaskComplete);
+	When(Method(modbusBaseMock, setRequest_WriteRegisters)).AlwaysReturn(true);
+	master->_busTimeCategory = BusTimeCategory::timeSync;
+
+	word vals[4] = { 1, 2, 3, 4 };
+	T_MASTER::completeModbusWriteRegisters_Task task(&T_MASTER::completeModbusWriteRegisters, master, 0, 0, 4, vals);
+	ASSERT_TRUE(task());
+
+	// 17 byte request and no response, at 286 us per character plus the fixed 2625 us frame delay
+	auto &busTime = master->getBusTimeAccounting();
+	ASSERT_EQ(task.result(), success);
+	ASSERT_EQ(busTime.getRequestCount(BusTimeCategory::timeSync), 1);
+	ASSERT_EQ(busTime.getWireTime(BusTimeCategory::timeSync), 17 * 286 + 2625);
+}
+
 TEST_F_TRAITS(MasterTests, completeModbusWriteRegisters_single_CompletesWithSomeAttempts,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
@@ -871,12 +981,21 @@ TEST_F_TRAITS(MasterTests, processNewSlave_Reject_DeviceStopsResponding,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(8, 0, 1 << 8, 3, 6, 22, 0, 0, 0));
+	readRegs.push(REGS(8, 0, (1 << 8) | 1, 3, 6, 22, 0, 0, 0));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
+	// Left over from a slave that had the ID before
+	DataPageCache cache;
+	cache.init(128, 6, 4);
+	uint32_t cursor;
+	cache.getCursor(13, 1, cursor);
+	master->setDataCache(&cache);
+
 	T_MASTER::processNewSlave_Task task(&T_MASTER::processNewSlave, master, false);
 	ASSERT_TRUE(task());
 	ASSERT_FALSE(master->_timeUpdatePending);
+	ASSERT_EQ(cache._destinations[0].slaveId, 0);
+	master->setDataCache(nullptr);
 
 
 
@@ -912,7 +1031,7 @@ TEST_F_TRAITS(MasterTests, processNewSlave_Reject_ByRequest,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue regsQueue;
-	regsQueue.push(REGS(7, 0, 1 << 8, 3, 6, 0, 0, 0));
+	regsQueue.push(REGS(7, 0, (1 << 8) | 1, 3, 6, 0, 0, 0));
 	isRegsResponse_UseMockData(modbusBaseMock, regsQueue);
 
 	T_MASTER::processNewSlave_Task task(&T_MASTER::processNewSlave, master, true);
@@ -926,6 +1045,32 @@ TEST_F_TRAITS(MasterTests, processNewSlave_Reject_ByRequest,
 	assertPopRegsQueue(writtenRegs, REGS(3, 1, 1, 255));
 }
 
+TEST_F_TRAITS(MasterTests, processNewSlave_NotIdle,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	MOCK_MODBUS;
+
+	When(Method(mockDeviceDirectory, findFreeSlaveID)).Return(13);
+	When(Method(modbusBaseMock, getRecipientId)).Return(1);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	When(Method(completeWriteRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	// Showing a broadcast receipt instead of its version and devices
+	RegsQueue regsQueue;
+	regsQueue.push(REGS(7, 11, 9, 0, 0, 0, 0, 0));
+	isRegsResponse_UseMockData(modbusBaseMock, regsQueue);
+
+	T_MASTER::processNewSlave_Task task(&T_MASTER::processNewSlave, master, false);
+	ASSERT_TRUE(task());
+
+	// Neither onboarded nor rejected
+	ASSERT_FALSE(master->_timeUpdatePending);
+	Verify(Method(completeWriteRegsMock, func)).Never();
+}
+
 TEST_F_TRAITS(MasterTests, processNewSlave_Reject_DirectoryAlreadyFull,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
 {
@@ -946,7 +1091,7 @@ TEST_F_TRAITS(MasterTests, processNewSlave_Reject_DirectoryAlreadyFull,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue regsQueue;
-	regsQueue.push(REGS(7, 0, 1 << 8, 3, 6, 0, 0, 0 ));
+	regsQueue.push(REGS(7, 0, (1 << 8) | 1, 3, 6, 0, 0, 0 ));
 	isRegsResponse_UseMockData(modbusBaseMock, regsQueue);
 
 	T_MASTER::processNewSlave_Task task(&T_MASTER::processNewSlave, master, false);
@@ -994,6 +1139,41 @@ TEST_F_TRAITS(MasterTests, processNewSlave_Reject_SlaveVersionMismatch,
 	assertPopRegsQueue(writtenRegs, REGS(3, 1, 1, 255));
 }
 
+TEST_F_TRAITS(MasterTests, processNewSlave_Reject_SlaveVersionTooOld,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	MOCK_MODBUS;
+
+	When(Method(mockDeviceDirectory, findFreeSlaveID)).Return(13);
+	When(Method(modbusBaseMock, getRecipientId)).Return(5);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	// Version 1.0
+	RegsQueue regsQueue;
+	regsQueue.push(REGS(7, 0, 1 << 8, 3, 6, 0, 0, 0));
+	isRegsResponse_UseMockData(modbusBaseMock, regsQueue);
+
+	T_MASTER::processNewSlave_Task task(&T_MASTER::processNewSlave, master, false);
+	ASSERT_TRUE(task());
+	ASSERT_FALSE(master->_timeUpdatePending);
+
+	// Three requests for device data, plus write new slave ID
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 3, Any<word*>())).Once();
+
+	// Slave ID set to 255, rejected
+	assertPopRegsQueue(writtenRegs, REGS(3, 1, 1, 255));
+}
+
 TEST_F_TRAITS(MasterTests, processNewSlave_Reject_ZeroDevices,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Rare)
 {
@@ -1014,7 +1194,7 @@ TEST_F_TRAITS(MasterTests, processNewSlave_Reject_ZeroDevices,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue regsQueue;
-	regsQueue.push(REGS(7,0, 1 << 8, 0, 6, 0, 0, 0));
+	regsQueue.push(REGS(7,0, (1 << 8) | 1, 0, 6, 0, 0, 0));
 	isRegsResponse_UseMockData(modbusBaseMock, regsQueue);
 
 	T_MASTER::processNewSlave_Task task(&T_MASTER::processNewSlave, master, false);
@@ -1060,7 +1240,7 @@ TEST_F_TRAITS(MasterTests, processNewSlave_Reject_DirectoryGetsFilled,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue regsQueue;
-	regsQueue.push(REGS(8, 0, 1 << 8, 3, 6, 47, 0, 0, 0));
+	regsQueue.push(REGS(8, 0, (1 << 8) | 1, 3, 6, 47, 0, 0, 0));
 	regsQueue.push(withString(REGS(3, 2, 1, 7), "TEAM A"));
 	regsQueue.push(withString(REGS(3, 2, 1, 8), "TEAM C"));
 	regsQueue.push(withString(REGS(3, 2, 1, 9), "TEAM B"));
@@ -1152,7 +1332,7 @@ TEST_F_TRAITS(MasterTests, transferPendingData_AllTimescales_Success,
 		master->lastUpdateTimes[i] = i + 5;
 	}
 
-	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::hr24, 120);
+	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::ms250, TimeScale::hr24, 120);
 	ASSERT_TRUE(task());
 
 	Verify(Method(readAndSendDeviceDataMock, func).Using(getDevicePtr(devices, 0), 7, getDeviceNamePtr(devices, 0), 5, 120) +
@@ -1181,7 +1361,7 @@ TEST_F_TRAITS(MasterTests, transferPendingData_AllTimescales_FullDay_Success,
 		master->lastUpdateTimes[i] = i + 5;
 	}
 
-	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::hr24, 86500);
+	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::ms250, TimeScale::hr24, 86500);
 	ASSERT_TRUE(task());
 
 	Verify(Method(readAndSendDeviceDataMock, func).Using(getDevicePtr(devices, 0), 7, getDeviceNamePtr(devices, 0), 86250, 86500) +
@@ -1195,6 +1375,62 @@ TEST_F_TRAITS(MasterTests, transferPendingData_AllTimescales_FullDay_Success,
 		master->lastUpdateTimes, 86500, 86500, 86497, 86468, 86409, 86410, 86411, 86412);
 }
 
+TEST_F_TRAITS(MasterTests, transferPendingData_SingleTimescale_Success,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	MOCK_MODBUS;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<void, DeviceDirectoryRow*, word, byte*, uint32_t, uint32_t>> readAndSendDeviceDataMock;
+	T_MASTER::readAndSendDeviceData_Task::mock = &readAndSendDeviceDataMock.get();
+	When(Method(readAndSendDeviceDataMock, func)).AlwaysReturn(true);
+	Fake(Method(readAndSendDeviceDataMock, result));
+
+	for (int i = 0; i < 8; i++)
+	{
+		master->lastUpdateTimes[i] = i + 5;
+	}
+
+	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::min1, TimeScale::min1, 120);
+	ASSERT_TRUE(task());
+
+	Verify(Method(readAndSendDeviceDataMock, func).Using(getDevicePtr(devices, 5), 7, getDeviceNamePtr(devices, 5), 8, 68)).Once();
+	Verify(Method(readAndSendDeviceDataMock, func)).Once();
+	assertArrayEq<uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t>(
+		master->lastUpdateTimes, 5, 6, 7, 68, 9, 10, 11, 12);
+}
+
+TEST_F_TRAITS(MasterTests, scheduleTransfers_PeriodsAndOffsets,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	master->scheduleTransfers(100);
+
+	ASSERT_EQ(master->getTransferPeriodForTimeScale(TimeScale::ms250), 4);
+	ASSERT_EQ(master->getTransferPeriodForTimeScale(TimeScale::sec1), 4);
+	ASSERT_EQ(master->getTransferPeriodForTimeScale(TimeScale::sec15), 15);
+	ASSERT_EQ(master->getTransferPeriodForTimeScale(TimeScale::min1), 60);
+	ASSERT_EQ(master->getTransferPeriodForTimeScale(TimeScale::hr24), 86400);
+	ASSERT_EQ(master->getTransferScheduler().getCount(), 8);
+
+	TimeScale timeScale;
+	ASSERT_FALSE(master->getTransferScheduler().popDue(103, timeScale));
+	ASSERT_TRUE(master->getTransferScheduler().popDue(105, timeScale));
+	ASSERT_EQ(timeScale, TimeScale::ms250);
+	ASSERT_TRUE(master->getTransferScheduler().popDue(105, timeScale));
+	ASSERT_EQ(timeScale, TimeScale::sec1);
+	ASSERT_FALSE(master->getTransferScheduler().popDue(105, timeScale));
+}
+
+TEST_F_TRAITS(MasterTests, setClock_ClearsTransferSchedule,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	master->scheduleTransfers(100);
+	master->setClock(50);
+
+	ASSERT_TRUE(master->getTransferScheduler().isEmpty());
+}
+
 TEST_F_TRAITS(MasterTests, transferPendingData_30MinMax_Success_Partial,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
 {
@@ -1212,7 +1448,7 @@ TEST_F_TRAITS(MasterTests, transferPendingData_30MinMax_Success_Partial,
 		master->lastUpdateTimes[i] = i + 5;
 	}
 
-	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::min30, 25);
+	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::ms250, TimeScale::min30, 25);
 	ASSERT_TRUE(task());
 
 	Verify(Method(readAndSendDeviceDataMock, func).Using(getDevicePtr(devices, 0), 7, getDeviceNamePtr(devices, 0), 5, 25) +
@@ -1239,7 +1475,7 @@ TEST_F_TRAITS(MasterTests, transferPendingData_1SecMax_Success,
 		master->lastUpdateTimes[i] = i + 5;
 	}
 
-	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::sec1, 20);
+	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::ms250, TimeScale::sec1, 20);
 	ASSERT_TRUE(task());
 
 	Verify(Method(readAndSendDeviceDataMock, func).Using(getDevicePtr(devices, 0), 7, getDeviceNamePtr(devices, 0), 5, 20) +
@@ -1266,7 +1502,7 @@ TEST_F_TRAITS(MasterTests, transferPendingData_1SecMax_MaxBitTransfer_Success,
 		master->lastUpdateTimes[i] = i + 5;
 	}
 
-	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::sec1, 20);
+	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::ms250, TimeScale::sec1, 20);
 	ASSERT_TRUE(task());
 
 	Verify(Method(readAndSendDeviceDataMock, func).Using(getDevicePtr(devices, 0), 7, getDeviceNamePtr(devices, 0), 18, 20) +
@@ -1275,6 +1511,122 @@ TEST_F_TRAITS(MasterTests, transferPendingData_1SecMax_MaxBitTransfer_Success,
 		master->lastUpdateTimes, 20, 20, 7, 8, 9, 10, 11, 12);
 }
 
+TEST_F_TRAITS(MasterTests, transferPendingData_1SecMax_MaxBitTransfer_QueuesBackfill,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	MOCK_MODBUS;
+	master->_maxTransferSize = 9;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<void, DeviceDirectoryRow*, word, byte*, uint32_t, uint32_t>> readAndSendDeviceDataMock;
+	T_MASTER::readAndSendDeviceData_Task::mock = &readAndSendDeviceDataMock.get();
+	When(Method(readAndSendDeviceDataMock, func)).AlwaysReturn(true);
+	Fake(Method(readAndSendDeviceDataMock, result));
+
+	for (int i = 0; i < 8; i++)
+	{
+		master->lastUpdateTimes[i] = i + 5;
+	}
+
+	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::ms250, TimeScale::sec1, 20);
+	ASSERT_TRUE(task());
+
+	auto &queue = master->getBackfillQueue();
+	ASSERT_EQ(queue.getCount(), 2);
+	ASSERT_EQ(queue._ranges[0].slaveId, 6);
+	ASSERT_EQ(queue._ranges[0].deviceNumber, 1);
+	ASSERT_EQ(queue._ranges[0].timeScale, TimeScale::ms250);
+	ASSERT_EQ(queue._ranges[0].startTime, 5);
+	ASSERT_EQ(queue._ranges[0].endTime, 18);
+	ASSERT_EQ(queue._ranges[1].slaveId, 6);
+	ASSERT_EQ(queue._ranges[1].deviceNumber, 0);
+	ASSERT_EQ(queue._ranges[1].timeScale, TimeScale::sec1);
+	ASSERT_EQ(queue._ranges[1].startTime, 6);
+	ASSERT_EQ(queue._ranges[1].endTime, 11);
+}
+
+TEST_F_TRAITS(MasterTests, backfillPendingData_ReadsOneChunk,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	MOCK_MODBUS;
+	master->_maxTransferSize = 9;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<void, DeviceDirectoryRow*, word, byte*, uint32_t, uint32_t>> readAndSendDeviceDataMock;
+	T_MASTER::readAndSendDeviceData_Task::mock = &readAndSendDeviceDataMock.get();
+	When(Method(readAndSendDeviceDataMock, func)).AlwaysReturn(true);
+	Fake(Method(readAndSendDeviceDataMock, result));
+
+	master->getBackfillQueue().push(6, 1, TimeScale::ms250, 5, 18);
+
+	T_MASTER::backfillPendingData_Task task(&T_MASTER::backfillPendingData, master);
+	ASSERT_TRUE(task());
+
+	Verify(Method(readAndSendDeviceDataMock, func).Using(getDevicePtr(devices, 0), 7, getDeviceNamePtr(devices, 0), 5, 7)).Once();
+	ASSERT_EQ(master->getBackfillQueue().getCount(), 1);
+	ASSERT_EQ(master->getBackfillQueue().front()->startTime, 7);
+}
+
+TEST_F_TRAITS(MasterTests, transferPendingData_LiveBudgetSpent_QueuesBackfill,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	MOCK_MODBUS;
+	master->_maxTransferSize = 480;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<void, DeviceDirectoryRow*, word, byte*, uint32_t, uint32_t>> readAndSendDeviceDataMock;
+	T_MASTER::readAndSendDeviceData_Task::mock = &readAndSendDeviceDataMock.get();
+	When(Method(readAndSendDeviceDataMock, func)).AlwaysReturn(true);
+	Fake(Method(readAndSendDeviceDataMock, result));
+
+	for (int i = 0; i < 8; i++)
+	{
+		master->lastUpdateTimes[i] = i + 5;
+	}
+	master->_preemptible = true;
+	master->_busPriority = BusPriority::liveData;
+	master->_priorityBudget.setBudget(BusPriority::liveData, 1000);
+	master->_priorityBudget.reset(master->_system->micros());
+	master->_priorityBudget.charge(BusPriority::liveData, 1000);
+
+	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::sec1, TimeScale::sec1, 20);
+	ASSERT_TRUE(task());
+
+	Verify(Method(readAndSendDeviceDataMock, func)).Never();
+	auto &queue = master->getBackfillQueue();
+	ASSERT_EQ(queue.getCount(), 1);
+	ASSERT_EQ(queue._ranges[0].slaveId, 6);
+	ASSERT_EQ(queue._ranges[0].deviceNumber, 0);
+	ASSERT_EQ(queue._ranges[0].startTime, 6);
+	ASSERT_EQ(queue._ranges[0].endTime, 20);
+	ASSERT_EQ(master->lastUpdateTimes[1], 20);
+}
+
+TEST_F_TRAITS(MasterTests, backfillPendingData_DeviceGone,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	MOCK_MODBUS;
+	master->_maxTransferSize = 9;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<void, DeviceDirectoryRow*, word, byte*, uint32_t, uint32_t>> readAndSendDeviceDataMock;
+	T_MASTER::readAndSendDeviceData_Task::mock = &readAndSendDeviceDataMock.get();
+	When(Method(readAndSendDeviceDataMock, func)).AlwaysReturn(true);
+	Fake(Method(readAndSendDeviceDataMock, result));
+
+	master->getBackfillQueue().push(9, 1, TimeScale::sec1, 5, 100);
+
+	T_MASTER::backfillPendingData_Task task(&T_MASTER::backfillPendingData, master);
+	ASSERT_TRUE(task());
+
+	Verify(Method(readAndSendDeviceDataMock, func)).Never();
+	ASSERT_TRUE(master->getBackfillQueue().isEmpty());
+}
+
 TEST_F_TRAITS(MasterTests, transferPendingData_1SecMax_0MaxBitTransfer_Success,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Rare)
 {
@@ -1293,7 +1645,7 @@ TEST_F_TRAITS(MasterTests, transferPendingData_1SecMax_0MaxBitTransfer_Success,
 		master->lastUpdateTimes[i] = i + 5;
 	}
 
-	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::sec1, 20);
+	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::ms250, TimeScale::sec1, 20);
 	ASSERT_TRUE(task());
 
 	Verify(Method(readAndSendDeviceDataMock, func)).Never();
@@ -1319,7 +1671,7 @@ TEST_F_TRAITS(MasterTests, transferPendingData_1SecMax_NoDevices,
 		master->lastUpdateTimes[i] = i + 5;
 	}
 
-	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::sec1, 20);
+	T_MASTER::transferPendingData_Task task(&T_MASTER::transferPendingData, master, TimeScale::ms250, TimeScale::sec1, 20);
 	ASSERT_TRUE(task());
 
 	Verify(Method(readAndSendDeviceDataMock, func)).Never();
@@ -1359,7 +1711,7 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_OneReadPage,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(6, 3, 0, 15000, 0, 8, 0));
+	readRegs.push(REGS(7, 3, 0, 15000, 0, 8, 0, 0));
 	readRegs.push(REGS(4, 0x4182, 0xB0E1, 0x4468, 0x26));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
@@ -1370,8 +1722,8 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_OneReadPage,
 	ASSERT_TRUE(task());
 
 	// Assert
-	assertPopRegsQueue(writtenRegs, REGS(7, 1, 3, 3, 15000, 0, 8, 11 << 8));
-	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 7, Any<word*>())).Once();
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 3, 3, 15000, 0, 8, 0, 11));
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>())).Once();
 	Verify(Method(sendDataToSlavesMock, func).Using(15000, 7, TimeScale::min10, 8, Any<byte*>(), Any<byte*>())).Once();
 	Verify(Method(deviceNameSentToSlaves, method).Using("Meter 001")).Once();
 	Verify(Method(dataByteSentToSlaves, method).Using(0x82) +
@@ -1383,21 +1735,19 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_OneReadPage,
 		Method(dataByteSentToSlaves, method).Using(0x26)).Once();
 }
 
-TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_TwoReadPages,
+TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_OneReadPage_PackedDelta,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
 	// Arrange
 	MOCK_MODBUS;
-	MockNewMethod(deviceNameSentToSlaves, string name);
 	MockNewMethod(dataByteSentToSlaves, byte data);
 
 	Mock<IMockedTask<void, uint32_t, byte, TimeScale, word, byte*, byte*>> sendDataToSlavesMock;
 	T_MASTER::sendDataToSlaves_Task::mock = &sendDataToSlavesMock.get();
-	When(Method(sendDataToSlavesMock, func)).AlwaysDo([&deviceNameSentToSlaves, &dataByteSentToSlaves](uint32_t startTime,
+	When(Method(sendDataToSlavesMock, func)).AlwaysDo([&dataByteSentToSlaves](uint32_t startTime,
 		byte dataSize, TimeScale timeScale, word numDataPoints, byte* name, byte* data)
 	{
-		deviceNameSentToSlaves.get().method(stringifyCharArray(9, (char*)name));
-		for (int i = 0; i < BitFunctions::bitsToBytes(dataSize * numDataPoints); i++)
+		for (int i = 0; i < 8; i++)
 			dataByteSentToSlaves.get().method(data[i]);
 		return true;
 	});
@@ -1414,45 +1764,45 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_TwoReadPages,
 	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
+	// Width 3, first point 100, then zigzagged deltas 2, 0, 4, 2, 0, 2, 4
 	RegsQueue readRegs;
-	readRegs.push(REGS(6, 3, 0, 15000, 0, 5, 1 << 8));
-	readRegs.push(REGS(3, 0x4182, 0xB0E1, 0x0));
-	readRegs.push(REGS(6, 3, 0, 15000, 0, 3, 1));
-	readRegs.push(REGS(2, 0xC88D, 0x4));
+	readRegs.push(REGS(8, 3, 0, 15000, 0, 8, 0, 0, 3 + ((word)PageEncoding::packedDelta << 12)));
+	readRegs.push(REGS(3, 0x6403, 0x0502, 0x0011));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
 	// Act
-	DeviceDirectoryRow inputDeviceRow = DeviceDirectoryRow(5, 3, DataCollectorDeviceType(true, TimeScale::min10, 7), 14);
+	DeviceDirectoryRow inputDeviceRow = DeviceDirectoryRow(5, 3,
+		DataCollectorDeviceType(true, TimeScale::min10, 8, PageEncoding::packedDelta), 14);
 	auto name = (byte*)"Meter 001";
 	T_MASTER::readAndSendDeviceData_Task task(&T_MASTER::readAndSendDeviceData, master, &inputDeviceRow, 9, name, 15000, 20000);
 	ASSERT_TRUE(task());
 
 	// Assert
-	assertPopRegsQueue(writtenRegs, REGS(7, 1, 3, 3, 15000, 0, 8, 11 << 8));
-	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 7, Any<word*>())).Twice();
-	Verify(Method(sendDataToSlavesMock, func).Using(15000, 7, TimeScale::min10, 5, Any<byte*>(), Any<byte*>()) +
-		Method(sendDataToSlavesMock, func).Using(18000, 7, TimeScale::min10, 3, Any<byte*>(), Any<byte*>())).Once();
-	Verify(Method(deviceNameSentToSlaves, method).Using("Meter 001")).Twice();
-	Verify(Method(dataByteSentToSlaves, method).Using(0x82) +
-		Method(dataByteSentToSlaves, method).Using(0x41) +
-		Method(dataByteSentToSlaves, method).Using(0xE1) +
-		Method(dataByteSentToSlaves, method).Using(0xB0) +
-		Method(dataByteSentToSlaves, method).Using(0x0) +
-		Method(dataByteSentToSlaves, method).Using(0x8D) +
-		Method(dataByteSentToSlaves, method).Using(0xC8) +
-		Method(dataByteSentToSlaves, method).Using(0x4)).Once();
-}
-
-TEST_F_TRAITS(MasterTests, readAndSendDeviceData_SendEmptyPacket_DeviceNotResponding,
-	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 3, 3, 15000, 0, 8, 0, 10));
+	Verify(Method(completeReadRegsMock, func).Using(5, 0, 8)).Once();
+	Verify(Method(completeReadRegsMock, func).Using(5, 8, 3)).Once();
+	Verify(Method(sendDataToSlavesMock, func).Using(15000, 8, TimeScale::min10, 8, Any<byte*>(), Any<byte*>())).Once();
+	Verify(Method(dataByteSentToSlaves, method).Using(100) +
+		Method(dataByteSentToSlaves, method).Using(101) +
+		Method(dataByteSentToSlaves, method).Using(101) +
+		Method(dataByteSentToSlaves, method).Using(103) +
+		Method(dataByteSentToSlaves, method).Using(104) +
+		Method(dataByteSentToSlaves, method).Using(104) +
+		Method(dataByteSentToSlaves, method).Using(105) +
+		Method(dataByteSentToSlaves, method).Using(107)).Once();
+}
+
+TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Malfunction_PayloadLongerThanRawPage,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
 {
 	// Arrange
 	MOCK_MODBUS;
-
+	MOCK_MASTER;
 	Mock<IMockedTask<void, uint32_t, byte, TimeScale, word, byte*, byte*>> sendDataToSlavesMock;
 	T_MASTER::sendDataToSlaves_Task::mock = &sendDataToSlavesMock.get();
 	When(Method(sendDataToSlavesMock, func)).AlwaysReturn(true);
 	Fake(Method(sendDataToSlavesMock, result));
+	Fake(Method(masterMock, reportMalfunction));
 
 	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
 	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
@@ -1461,35 +1811,179 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_SendEmptyPacket_DeviceNotRespon
 
 	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
 	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
-	RegsQueue writtenRegs;
-	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, func)).AlwaysReturn(true);
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(6, 3, 2, 0, 0, 0, 0));
+	readRegs.push(REGS(8, 3, 0, 15000, 0, 8, 0, 0, 5 + ((word)PageEncoding::zigzagVarint << 12)));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
 	// Act
-	DeviceDirectoryRow inputDeviceRow = DeviceDirectoryRow(5, 3, DataCollectorDeviceType(true, TimeScale::min10, 7), 14);
+	DeviceDirectoryRow inputDeviceRow = DeviceDirectoryRow(5, 3,
+		DataCollectorDeviceType(true, TimeScale::min10, 8, PageEncoding::zigzagVarint), 14);
 	auto name = (byte*)"Meter 001";
 	T_MASTER::readAndSendDeviceData_Task task(&T_MASTER::readAndSendDeviceData, master, &inputDeviceRow, 9, name, 15000, 20000);
 	ASSERT_TRUE(task());
 
 	// Assert
-	assertPopRegsQueue(writtenRegs, REGS(7, 1, 3, 3, 15000, 0, 8, 11 << 8));
-	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 7, Any<word*>())).Once();
+	Verify(Method(masterMock, reportMalfunction)).Once();
+	Verify(Method(completeReadRegsMock, func).Using(5, 8, _)).Never();
 	Verify(Method(sendDataToSlavesMock, func)).Never();
 }
 
-TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Skip_UnsupportedDevice,
+TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_TwoReadPages,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
 	// Arrange
 	MOCK_MODBUS;
+	MockNewMethod(deviceNameSentToSlaves, string name);
+	MockNewMethod(dataByteSentToSlaves, byte data);
 
 	Mock<IMockedTask<void, uint32_t, byte, TimeScale, word, byte*, byte*>> sendDataToSlavesMock;
 	T_MASTER::sendDataToSlaves_Task::mock = &sendDataToSlavesMock.get();
-	When(Method(sendDataToSlavesMock, func)).AlwaysReturn(true);
+	When(Method(sendDataToSlavesMock, func)).AlwaysDo([&deviceNameSentToSlaves, &dataByteSentToSlaves](uint32_t startTime,
+		byte dataSize, TimeScale timeScale, word numDataPoints, byte* name, byte* data)
+	{
+		deviceNameSentToSlaves.get().method(stringifyCharArray(9, (char*)name));
+		for (int i = 0; i < BitFunctions::bitsToBytes(dataSize * numDataPoints); i++)
+			dataByteSentToSlaves.get().method(data[i]);
+		return true;
+	});
+	Fake(Method(sendDataToSlavesMock, result));
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	RegsQueue readRegs;
+	readRegs.push(REGS(7, 3, 0, 15000, 0, 5, 0, 1));
+	readRegs.push(REGS(3, 0x4182, 0xB0E1, 0x0));
+	readRegs.push(REGS(7, 3, 0, 15000, 0, 3, 1, 0));
+	readRegs.push(REGS(2, 0xC88D, 0x4));
+	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
+
+	// Act
+	DeviceDirectoryRow inputDeviceRow = DeviceDirectoryRow(5, 3, DataCollectorDeviceType(true, TimeScale::min10, 7), 14);
+	auto name = (byte*)"Meter 001";
+	T_MASTER::readAndSendDeviceData_Task task(&T_MASTER::readAndSendDeviceData, master, &inputDeviceRow, 9, name, 15000, 20000);
+	ASSERT_TRUE(task());
+
+	// Assert
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 3, 3, 15000, 0, 8, 0, 11));
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>())).Twice();
+	Verify(Method(sendDataToSlavesMock, func).Using(15000, 7, TimeScale::min10, 5, Any<byte*>(), Any<byte*>()) +
+		Method(sendDataToSlavesMock, func).Using(18000, 7, TimeScale::min10, 3, Any<byte*>(), Any<byte*>())).Once();
+	Verify(Method(deviceNameSentToSlaves, method).Using("Meter 001")).Twice();
+	Verify(Method(dataByteSentToSlaves, method).Using(0x82) +
+		Method(dataByteSentToSlaves, method).Using(0x41) +
+		Method(dataByteSentToSlaves, method).Using(0xE1) +
+		Method(dataByteSentToSlaves, method).Using(0xB0) +
+		Method(dataByteSentToSlaves, method).Using(0x0) +
+		Method(dataByteSentToSlaves, method).Using(0x8D) +
+		Method(dataByteSentToSlaves, method).Using(0xC8) +
+		Method(dataByteSentToSlaves, method).Using(0x4)).Once();
+}
+
+TEST_F_TRAITS(MasterTests, readAndSendDeviceData_TwoReadPages_PreemptedAtPageBoundary,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Arrange
+	MOCK_MODBUS;
+
+	Mock<IMockedTask<void, uint32_t, byte, TimeScale, word, byte*, byte*>> sendDataToSlavesMock;
+	T_MASTER::sendDataToSlaves_Task::mock = &sendDataToSlavesMock.get();
+	When(Method(sendDataToSlavesMock, func)).AlwaysReturn(true);
+	Fake(Method(sendDataToSlavesMock, result));
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	RegsQueue readRegs;
+	readRegs.push(REGS(7, 3, 0, 15000, 0, 5, 0, 1));
+	readRegs.push(REGS(3, 0x4182, 0xB0E1, 0x0));
+	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
+
+	// Backfill has used up its bus time for this cycle
+	master->_preemptible = true;
+	master->_busPriority = BusPriority::backfill;
+	master->_priorityBudget.setBudget(BusPriority::backfill, 1000);
+	master->_priorityBudget.reset(master->_system->micros());
+	master->_priorityBudget.charge(BusPriority::backfill, 1000);
+
+	// Act
+	DeviceDirectoryRow inputDeviceRow = DeviceDirectoryRow(5, 3, DataCollectorDeviceType(true, TimeScale::min10, 7), 14);
+	auto name = (byte*)"Meter 001";
+	T_MASTER::readAndSendDeviceData_Task task(&T_MASTER::readAndSendDeviceData, master, &inputDeviceRow, 9, name, 15000, 20000);
+	ASSERT_TRUE(task());
+
+	// Assert
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>())).Once();
+	Verify(Method(sendDataToSlavesMock, func).Using(15000, 7, TimeScale::min10, 5, Any<byte*>(), Any<byte*>())).Once();
+	ASSERT_EQ(master->_preemptedAt, 18000);
+}
+
+TEST_F_TRAITS(MasterTests, readAndSendDeviceData_SendEmptyPacket_DeviceNotResponding,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Arrange
+	MOCK_MODBUS;
+
+	Mock<IMockedTask<void, uint32_t, byte, TimeScale, word, byte*, byte*>> sendDataToSlavesMock;
+	T_MASTER::sendDataToSlaves_Task::mock = &sendDataToSlavesMock.get();
+	When(Method(sendDataToSlavesMock, func)).AlwaysReturn(true);
+	Fake(Method(sendDataToSlavesMock, result));
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	RegsQueue readRegs;
+	readRegs.push(REGS(7, 3, 2, 0, 0, 0, 0, 0));
+	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
+
+	// Act
+	DeviceDirectoryRow inputDeviceRow = DeviceDirectoryRow(5, 3, DataCollectorDeviceType(true, TimeScale::min10, 7), 14);
+	auto name = (byte*)"Meter 001";
+	T_MASTER::readAndSendDeviceData_Task task(&T_MASTER::readAndSendDeviceData, master, &inputDeviceRow, 9, name, 15000, 20000);
+	ASSERT_TRUE(task());
+
+	// Assert
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 3, 3, 15000, 0, 8, 0, 11));
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>())).Once();
+	Verify(Method(sendDataToSlavesMock, func)).Never();
+}
+
+TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Skip_UnsupportedDevice,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Arrange
+	MOCK_MODBUS;
+
+	Mock<IMockedTask<void, uint32_t, byte, TimeScale, word, byte*, byte*>> sendDataToSlavesMock;
+	T_MASTER::sendDataToSlaves_Task::mock = &sendDataToSlavesMock.get();
+	When(Method(sendDataToSlavesMock, func)).AlwaysReturn(true);
 	Fake(Method(sendDataToSlavesMock, result));
 
 	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
@@ -1504,7 +1998,7 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Skip_UnsupportedDevice,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(6, 3, 2, 0, 0, 0, 0));
+	readRegs.push(REGS(7, 3, 2, 0, 0, 0, 0, 0));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
 	// Act
@@ -1514,8 +2008,8 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Skip_UnsupportedDevice,
 	ASSERT_TRUE(task());
 
 	// Assert
-	assertPopRegsQueue(writtenRegs, REGS(7, 1, 3, 3, 15000, 0, 8, 11 << 8));
-	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 7, Any<word*>())).Once();
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 3, 3, 15000, 0, 8, 0, 11));
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>())).Once();
 	Verify(Method(sendDataToSlavesMock, func)).Never();
 }
 
@@ -1553,7 +2047,7 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_OneReadPage_Malfunction
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(6, 3, 8, 0, 0, 0, 0));
+	readRegs.push(REGS(7, 3, 8, 0, 0, 0, 0, 0));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
 	master->setClock(0x12345678);
@@ -1565,8 +2059,8 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_OneReadPage_Malfunction
 	ASSERT_TRUE(task());
 
 	// Assert
-	assertPopRegsQueue(writtenRegs, REGS(7, 1, 3, 3, 15000, 0, 8, 11 << 8));
-	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 7, Any<word*>())).Once();
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 3, 3, 15000, 0, 8, 0, 11));
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>())).Once();
 	Verify(Method(sendDataToSlavesMock, func)).Never();
 	Verify(Method(masterMock, reportMalfunction));
 }
@@ -1603,8 +2097,8 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_OneReadPage_TimeRequest
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(6, 3, 1, 0, 0, 0, 0));
-	readRegs.push(REGS(6, 3, 0, 15000, 0, 8, 0));
+	readRegs.push(REGS(7, 3, 1, 0, 0, 0, 0, 0));
+	readRegs.push(REGS(7, 3, 0, 15000, 0, 8, 0, 0));
 	readRegs.push(REGS(4, 0x4182, 0xB0E1, 0x4468, 0x26));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
@@ -1617,10 +2111,10 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_OneReadPage_TimeRequest
 	ASSERT_TRUE(task());
 
 	// Assert
-	assertPopRegsQueue(writtenRegs, REGS(7, 1, 3, 3, 15000, 0, 8, 11 << 8));
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 3, 3, 15000, 0, 8, 0, 11));
 	assertPopRegsQueue(writtenRegs, REGS(4, 1, 32770, 0x5678, 0x1234));
-	assertPopRegsQueue(writtenRegs, REGS(7, 1, 3, 3, 15000, 0, 8, 11 << 8));
-	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 7, Any<word*>())).Twice();
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 3, 3, 15000, 0, 8, 0, 11));
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>())).Twice();
 	Verify(Method(sendDataToSlavesMock, func).Using(15000, 7, TimeScale::min10, 8, Any<byte*>(), Any<byte*>())).Once();
 	Verify(Method(deviceNameSentToSlaves, method).Using("Meter 001")).Once();
 	Verify(Method(dataByteSentToSlaves, method).Using(0x82) +
@@ -1661,7 +2155,7 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Alert_DeviceNotResponding,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(noResponse);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(6, 3, 0, 15000, 0, 8, 0));
+	readRegs.push(REGS(7, 3, 0, 15000, 0, 8, 0, 0));
 	readRegs.push(REGS(4, 0x4182, 0xB0E1, 0x4468, 0x26));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 	master->setClock(5);
@@ -1673,12 +2167,148 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Alert_DeviceNotResponding,
 	ASSERT_TRUE(task());
 
 	// Assert
-	assertPopRegsQueue(writtenRegs, REGS(7, 1, 3, 3, 15000, 0, 8, 11 << 8));
-	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 7, Any<word*>())).Once();
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 3, 3, 15000, 0, 8, 0, 11));
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>())).Once();
 	Verify(Method(sendDataToSlavesMock, func).Using(5, 0, TimeScale::ms250, 0, Any<byte*>(), Any<byte*>())).Once();
 	Verify(Method(deviceNameSentToSlaves, method).Using("Meter 001")).Once();
 }
 
+TEST_F_TRAITS(MasterTests, readAndSendDeviceData_DeviceNotResponding_Evicted,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	// Arrange
+	MOCK_MODBUS;
+
+	Mock<IMockedTask<void, uint32_t, byte, TimeScale, word, byte*, byte*>> sendDataToSlavesMock;
+	T_MASTER::sendDataToSlaves_Task::mock = &sendDataToSlavesMock.get();
+	When(Method(sendDataToSlavesMock, func)).AlwaysReturn(true);
+	Fake(Method(sendDataToSlavesMock, result));
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	When(Method(completeWriteRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(noResponse);
+	When(Method(mockDeviceDirectory, recordDeviceNoResponse)).AlwaysReturn(DeviceLivenessState::evicted);
+
+	master->getBackfillQueue().push(5, 3, TimeScale::min10, 3000, 9000);
+	master->getBackfillQueue().push(5, 4, TimeScale::min10, 3000, 9000);
+	DataPageCache cache;
+	cache.init(128, 9, 4);
+	uint32_t cursor;
+	cache.getCursor(5, 3, cursor);
+	cache.getCursor(5, 4, cursor);
+	master->setDataCache(&cache);
+
+	// Act
+	DeviceDirectoryRow inputDeviceRow = DeviceDirectoryRow(5, 3, DataCollectorDeviceType(true, TimeScale::min10, 7), 14);
+	auto name = (byte*)"Meter 001";
+	T_MASTER::readAndSendDeviceData_Task task(&T_MASTER::readAndSendDeviceData, master, &inputDeviceRow, 9, name, 15000, 20000);
+	ASSERT_TRUE(task());
+
+	// Assert
+	Verify(Method(mockDeviceDirectory, recordDeviceNoResponse).Using(&inputDeviceRow)).Once();
+	Verify(Method(mockDeviceDirectory, recordDeviceResponse)).Never();
+	ASSERT_EQ(master->getBackfillQueue().getCount(), 1);
+	ASSERT_EQ(master->getBackfillQueue().front()->deviceNumber, 4);
+	// Only the evicted device's cursor is forgotten
+	ASSERT_EQ(cache._destinations[0].slaveId, 0);
+	ASSERT_EQ(cache._destinations[1].deviceNumber, 4);
+	master->setDataCache(nullptr);
+}
+
+TEST_F_TRAITS(MasterTests, probeSuspendedDevice_Responds,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	MOCK_MODBUS;
+	DeviceDirectoryRow suspended = DeviceDirectoryRow(5, 3, DataCollectorDeviceType(true, TimeScale::min10, 7), 14);
+	When(Method(mockDeviceDirectory, findNextSuspendedDevice)).AlwaysDo([&suspended](byte* &devName, int &row)
+	{
+		devName = (byte*)"Meter 001";
+		row = 1;
+		return &suspended;
+	});
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(exceptionResponse);
+	master->setClock(77);
+
+	T_MASTER::probeSuspendedDevice_Task task(&T_MASTER::probeSuspendedDevice, master);
+	ASSERT_TRUE(task());
+
+	Verify(Method(completeReadRegsMock, func).Using(5, 0, 1)).Once();
+	Verify(Method(mockDeviceDirectory, recordDeviceResponse).Using(&suspended, 77)).Once();
+	ASSERT_EQ(master->_probeRow, 1);
+}
+
+TEST_F_TRAITS(MasterTests, probeSuspendedDevice_NoneSuspended,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	MOCK_MODBUS;
+	When(Method(mockDeviceDirectory, findNextSuspendedDevice)).AlwaysDo([](byte* &devName, int &row)
+	{
+		row = -1;
+		return (DeviceDirectoryRow*)nullptr;
+	});
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	T_MASTER::probeSuspendedDevice_Task task(&T_MASTER::probeSuspendedDevice, master);
+	ASSERT_TRUE(task());
+
+	Verify(Method(completeReadRegsMock, func)).Never();
+	Verify(Method(mockDeviceDirectory, findNextSuspendedDevice)).Twice();
+}
+
+TEST_F_TRAITS(MasterTests, resetQuarantinedSlave_SlaveAnswers,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	MOCK_MODBUS;
+	When(Method(mockDeviceDirectory, findNextQuarantinedSlaveId).Using(0)).AlwaysReturn(7);
+	Fake(Method(mockDeviceDirectory, releaseQuarantinedSlaveId));
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	T_MASTER::resetQuarantinedSlave_Task task(&T_MASTER::resetQuarantinedSlave, master);
+	ASSERT_TRUE(task());
+
+	// Back to slave ID 1, where discovery finds it
+	Verify(Method(completeWriteRegsMock, func).Using(7, 0, 3, Any<word*>())).Once();
+	assertPopRegsQueue(writtenRegs, REGS(3, 1, 1, 1));
+	Verify(Method(mockDeviceDirectory, releaseQuarantinedSlaveId).Using(7)).Once();
+	ASSERT_EQ(master->_quarantineProbeId, 7);
+}
+
+TEST_F_TRAITS(MasterTests, resetQuarantinedSlave_NoResponse,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	MOCK_MODBUS;
+	master->_quarantineProbeId = 7;
+	When(Method(mockDeviceDirectory, findNextQuarantinedSlaveId).Using(7)).AlwaysReturn(0);
+	When(Method(mockDeviceDirectory, findNextQuarantinedSlaveId).Using(0)).AlwaysReturn(7);
+	Fake(Method(mockDeviceDirectory, releaseQuarantinedSlaveId));
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	When(Method(completeWriteRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(noResponse);
+
+	T_MASTER::resetQuarantinedSlave_Task task(&T_MASTER::resetQuarantinedSlave, master);
+	ASSERT_TRUE(task());
+
+	// Wrapped around to the only one, which stays quarantined
+	Verify(Method(completeWriteRegsMock, func).Using(7, 0, 3, Any<word*>())).Once();
+	Verify(Method(mockDeviceDirectory, releaseQuarantinedSlaveId)).Never();
+}
+
 TEST_F_TRAITS(MasterTests, readAndSendDeviceData_DoNothing_ZeroTimeSpan,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Rare)
 {
@@ -1708,7 +2338,7 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_DoNothing_ZeroTimeSpan,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(noResponse);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(6, 3, 0, 15000, 0, 8, 0));
+	readRegs.push(REGS(7, 3, 0, 15000, 0, 8, 0, 0));
 	readRegs.push(REGS(4, 0x4182, 0xB0E1, 0x4468, 0x26));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 	master->setClock(5);
@@ -1757,7 +2387,7 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_DoNothing_ZeroPoints,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(6, 3, 0, 15000, 0, 0, 0));
+	readRegs.push(REGS(7, 3, 0, 15000, 0, 0, 0, 0));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
 	// Act
@@ -1767,8 +2397,8 @@ TEST_F_TRAITS(MasterTests, readAndSendDeviceData_DoNothing_ZeroPoints,
 	ASSERT_TRUE(task());
 
 	// Assert
-	assertPopRegsQueue(writtenRegs, REGS(7, 1, 3, 3, 15000, 0, 8, 11 << 8));
-	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 7, Any<word*>())).Once();
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 3, 3, 15000, 0, 8, 0, 11));
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>())).Once();
 	Verify(Method(sendDataToSlavesMock, func)).Never();
 	Verify(Method(deviceNameSentToSlaves, method)).Never();
 	Verify(Method(dataByteSentToSlaves, method)).Never();
@@ -1794,8 +2424,8 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_OnePageEach,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(2, 4, 8 << 8));
-	readRegs.push(REGS(2, 4, 8 << 8));
+	readRegs.push(REGS(3, 4, 0, 8));
+	readRegs.push(REGS(3, 4, 0, 8));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
 	// Act
@@ -1806,26 +2436,29 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_OnePageEach,
 
 	// Assert
 	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
-	assertPopRegsQueue(writtenRegs, REGS(8, 1, 5, 1, 8 + (5 << 8), 6, 0x8821, 0x5051, 0xAB));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 5, 1, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
 	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 2, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
-	assertPopRegsQueue(writtenRegs, REGS(8, 1, 5, 2, 8 + (5 << 8), 6, 0x8821, 0x5051, 0xAB));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 5, 2, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
 	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 12, Any<word*>()) +
 		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(5, 0, 9, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
 		Method(completeWriteRegsMock, result) +
 		Method(completeWriteRegsMock, func).Using(6, 0, 12, Any<word*>()) +
 		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(6, 0, 8, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(6, 0, 9, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
 		Method(completeWriteRegsMock, result)).Once();
 }
 
-TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_TwoAndThreePages,
+TEST_F_TRAITS(MasterTests, sendDataToDevice_Success_PackedDeltaTransmitter,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
 	// Arrange
 	MOCK_MODBUS;
 	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
-	auto devices = Setup_DataCollectorsAndTransmitters();
 
 	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
 	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
@@ -1839,47 +2472,30 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_TwoAndThreePages,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(2, 4, 4 << 8));
-	readRegs.push(REGS(2, 4, 3 << 8));
+	readRegs.push(REGS(3, 4, 0, 8));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
 	// Act
+	DeviceDirectoryRow device = DeviceDirectoryRow(5, 1, DataTransmitterDeviceType() + (word)PageEncoding::packedDelta, 10);
 	auto name = (byte*)"Meter01";
-	auto data = tracker.addArray(new byte[5]{ 0x21, 0x88, 0x51, 0x50, 0xAB });
-	T_MASTER::sendDataToSlaves_Task task(&T_MASTER::sendDataToSlaves, master, 0x12345678, 5, TimeScale::hr1, 8, name, data);
+	auto data = tracker.addArray(new byte[8]{ 100, 101, 101, 103, 104, 104, 105, 107 });
+	T_MASTER::sendDataToDevice_Task task(&T_MASTER::sendDataToDevice, master, &device, 0x12345678, 8, TimeScale::hr1, 8, name, data);
 	ASSERT_TRUE(task());
 
 	// Assert
-	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
-	assertPopRegsQueue(writtenRegs, REGS(7, 1, 5, 1, 4 + (5 << 8), 6, 0x8821, 0x1));
-	assertPopRegsQueue(writtenRegs, REGS(7, 1, 5, 1, 4 + (5 << 8), 6 + (1 << 8), 0xB505, 0xA));
-	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 2, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
-	assertPopRegsQueue(writtenRegs, REGS(6, 1, 5, 2, 3 + (5 << 8), 6, 0x821));
-	assertPopRegsQueue(writtenRegs, REGS(6, 1, 5, 2, 3 + (5 << 8), 6 + (1 << 8), 0x20A3));
-	assertPopRegsQueue(writtenRegs, REGS(6, 1, 5, 2, 2 + (5 << 8), 6 + (2 << 8), 0x2AD));
-	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 12, Any<word*>()) +
-		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(5, 0, 7, Any<word*>()) +
-		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(5, 0, 7, Any<word*>()) +
-		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(6, 0, 12, Any<word*>()) +
-		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(6, 0, 6, Any<word*>()) +
-		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(6, 0, 6, Any<word*>()) +
-		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(6, 0, 6, Any<word*>()) +
-		Method(completeWriteRegsMock, result)).Once();
+	ASSERT_EQ(task.result(), success);
+	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 8 + (6 << 8), 8), "Meter01"));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 5, 1, 8, 8 + ((word)PageEncoding::packedDelta << 6) + (6 << 8), 0,
+		0x6403, 0x0502, 0x0011));
+	ASSERT_TRUE(writtenRegs.empty());
 }
 
-TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_OnePageEach_TimeRequested,
+TEST_F_TRAITS(MasterTests, sendDataToDevice_Success_DeadbandTransmitter,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
 	// Arrange
 	MOCK_MODBUS;
 	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
-	auto devices = Setup_DataCollectorsAndTransmitters();
 
 	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
 	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
@@ -1893,47 +2509,32 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_OnePageEach_TimeRequested,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(2, 4, 3)); // Time requested
-	readRegs.push(REGS(2, 4, 8 << 8));
-	readRegs.push(REGS(2, 4, 8 << 8));
+	readRegs.push(REGS(3, 4, 0, 8));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
-	master->setClock(0x23456781);
-
 	// Act
+	DeviceDirectoryRow device = DeviceDirectoryRow(5, 1, DataTransmitterDeviceType() + (word)PageEncoding::deadband, 10);
 	auto name = (byte*)"Meter01";
-	auto data = tracker.addArray(new byte[5]{ 0x21, 0x88, 0x51, 0x50, 0xAB });
-	T_MASTER::sendDataToSlaves_Task task(&T_MASTER::sendDataToSlaves, master, 0x12345678, 5, TimeScale::hr1, 8, name, data);
+	auto data = tracker.addArray(new byte[8]{ 100, 100, 100, 100, 100, 100, 100, 107 });
+	T_MASTER::sendDataToDevice_Task task(&T_MASTER::sendDataToDevice, master, &device, 0x12345678, 8, TimeScale::hr1, 8, name, data);
 	ASSERT_TRUE(task());
 
 	// Assert
-	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
-	assertPopRegsQueue(writtenRegs, REGS(4, 1, 32770, 0x6781, 0x2345));
-	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
-	assertPopRegsQueue(writtenRegs, REGS(8, 1, 5, 1, 8 + (5 << 8), 6, 0x8821, 0x5051, 0xAB));
-	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 2, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
-	assertPopRegsQueue(writtenRegs, REGS(8, 1, 5, 2, 8 + (5 << 8), 6, 0x8821, 0x5051, 0xAB));
-	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 12, Any<word*>()) +
-		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(0, 0, 4, Any<word*>()) +
-		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(5, 0, 12, Any<word*>()) +
-		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>()) +
-		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(6, 0, 12, Any<word*>()) +
-		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(6, 0, 8, Any<word*>()) +
-		Method(completeWriteRegsMock, result)).Once();
+	ASSERT_EQ(task.result(), success);
+	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 8 + (6 << 8), 8), "Meter01"));
+	// Bitmap 0x81, then only the first and last points
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 5, 1, 8, 8 + ((word)PageEncoding::deadband << 6) + (6 << 8), 0,
+		0x6481, 0x006B));
+	ASSERT_TRUE(writtenRegs.empty());
 }
 
-TEST_F_TRAITS(MasterTests, sendDataToSlaves_Skip_OnePageEach_DeviceError,
-	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+TEST_F_TRAITS(MasterTests, sendDataToDevice_NoResponseToWrite,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
 {
 	// Arrange
 	MOCK_MODBUS;
 	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
-	auto devices = Setup_DataCollectorsAndTransmitters();
+	When(Method(mockDeviceDirectory, recordDeviceNoResponse)).AlwaysReturn(DeviceLivenessState::live);
 
 	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
 	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
@@ -1942,13 +2543,106 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Skip_OnePageEach_DeviceError,
 
 	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
 	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
-	RegsQueue writtenRegs;
-	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
-	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+	When(Method(completeWriteRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(noResponse);
+
+	// Act
+	DeviceDirectoryRow device = DeviceDirectoryRow(5, 1, DataTransmitterDeviceType(), 10);
+	auto name = (byte*)"Meter01";
+	auto data = tracker.addArray(new byte[2]{ 100, 101 });
+	T_MASTER::sendDataToDevice_Task task(&T_MASTER::sendDataToDevice, master, &device, 0x12345678, 8, TimeScale::hr1, 2, name, data);
+	ASSERT_TRUE(task());
+
+	// Assert
+	ASSERT_EQ(task.result(), noResponse);
+	Verify(Method(completeReadRegsMock, func)).Never();
+	Verify(Method(mockDeviceDirectory, recordDeviceNoResponse).Using(&device)).Once();
+}
+
+TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_TwoAndThreePages,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Arrange
+	MOCK_MODBUS;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	RegsQueue readRegs;
+	readRegs.push(REGS(3, 4, 0, 4));
+	readRegs.push(REGS(3, 4, 0, 3));
+	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
+
+	// Act
+	auto name = (byte*)"Meter01";
+	auto data = tracker.addArray(new byte[5]{ 0x21, 0x88, 0x51, 0x50, 0xAB });
+	T_MASTER::sendDataToSlaves_Task task(&T_MASTER::sendDataToSlaves, master, 0x12345678, 5, TimeScale::hr1, 8, name, data);
+	ASSERT_TRUE(task());
+
+	// Assert
+	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 5, 1, 4, 5 + (6 << 8), 0, 0x8821, 0x1));
+	assertPopRegsQueue(writtenRegs, REGS(8, 1, 5, 1, 4, 5 + (6 << 8), 1, 0xB505, 0xA));
+	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 2, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
+	assertPopRegsQueue(writtenRegs, REGS(7, 1, 5, 2, 3, 5 + (6 << 8), 0, 0x821));
+	assertPopRegsQueue(writtenRegs, REGS(7, 1, 5, 2, 3, 5 + (6 << 8), 1, 0x20A3));
+	assertPopRegsQueue(writtenRegs, REGS(7, 1, 5, 2, 2, 5 + (6 << 8), 2, 0x2AD));
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 12, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(5, 0, 8, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(6, 0, 12, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(6, 0, 7, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(6, 0, 7, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(6, 0, 7, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result)).Once();
+}
+
+TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_OnePageEach_TimeRequested,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Arrange
+	MOCK_MODBUS;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(2, 4, 2)); // Name is too long. Currently all errors are skipped.
-	readRegs.push(REGS(2, 4, 8 << 8));
+	readRegs.push(REGS(3, 4, 3, 0)); // Time requested
+	readRegs.push(REGS(3, 4, 0, 8));
+	readRegs.push(REGS(3, 4, 0, 8));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
 	master->setClock(0x23456781);
@@ -1961,13 +2655,73 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Skip_OnePageEach_DeviceError,
 
 	// Assert
 	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
+	assertPopRegsQueue(writtenRegs, REGS(4, 1, 32770, 0x6781, 0x2345));
+	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 5, 1, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
 	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 2, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
-	assertPopRegsQueue(writtenRegs, REGS(8, 1, 5, 2, 8 + (5 << 8), 6, 0x8821, 0x5051, 0xAB));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 5, 2, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
 	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 12, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(0, 0, 4, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(5, 0, 12, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(5, 0, 9, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
 		Method(completeWriteRegsMock, result) +
 		Method(completeWriteRegsMock, func).Using(6, 0, 12, Any<word*>()) +
 		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(6, 0, 8, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(6, 0, 9, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result)).Once();
+}
+
+TEST_F_TRAITS(MasterTests, sendDataToSlaves_Skip_OnePageEach_DeviceError,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Arrange
+	MOCK_MODBUS;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	RegsQueue readRegs;
+	readRegs.push(REGS(3, 4, 2, 0)); // Name is too long. Currently all errors are skipped.
+	readRegs.push(REGS(3, 4, 0, 8));
+	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
+
+	master->setClock(0x23456781);
+
+	// Act
+	auto name = (byte*)"Meter01";
+	auto data = tracker.addArray(new byte[5]{ 0x21, 0x88, 0x51, 0x50, 0xAB });
+	T_MASTER::sendDataToSlaves_Task task(&T_MASTER::sendDataToSlaves, master, 0x12345678, 5, TimeScale::hr1, 8, name, data);
+	ASSERT_TRUE(task());
+
+	// Assert
+	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
+	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 2, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 5, 2, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 12, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(6, 0, 12, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(6, 0, 9, Any<word*>()) +
 		Method(completeWriteRegsMock, result)).Once();
 }
 
@@ -1991,8 +2745,8 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Failure_OnePageEach_Malfunction,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(2, 4, 6)); // Bad response
-	readRegs.push(REGS(2, 4, 8 << 8));
+	readRegs.push(REGS(3, 4, 6, 0)); // Bad response
+	readRegs.push(REGS(3, 4, 0, 8));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
 	master->setClock(0x23456781);
@@ -2030,8 +2784,8 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Failure_NameTooLongForRegisterBuffer
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(2, 4, 6)); // Bad response
-	readRegs.push(REGS(2, 4, 8 << 8));
+	readRegs.push(REGS(3, 4, 6, 0)); // Bad response
+	readRegs.push(REGS(3, 4, 0, 8));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
 	master->setClock(0x23456781);
@@ -2068,8 +2822,8 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_ReportDeviceNotResponding,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(2, 4, 0));
-	readRegs.push(REGS(2, 4, 0));
+	readRegs.push(REGS(3, 4, 0, 0));
+	readRegs.push(REGS(3, 4, 0, 0));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
 	// Act
@@ -2082,8 +2836,10 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_ReportDeviceNotResponding,
 	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 0, 0), "Meter01"));
 	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 2, 7, 0x5678, 0x1234, 0, 0), "Meter01"));
 	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 12, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
 		Method(completeWriteRegsMock, result) +
 		Method(completeWriteRegsMock, func).Using(6, 0, 12, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
 		Method(completeWriteRegsMock, result)).Once();
 }
 
@@ -2098,7 +2854,8 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_FirstDeviceDoesntRespond,
 	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
 	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
 	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
-	When(Method(completeReadRegsMock, result)).Return(noResponse).AlwaysReturn(success);
+	// Checked twice for a malfunction, then once for no response
+	When(Method(completeReadRegsMock, result)).Return(noResponse, noResponse, noResponse).AlwaysReturn(success);
 
 	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
 	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
@@ -2107,8 +2864,8 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_FirstDeviceDoesntRespond,
 	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
 
 	RegsQueue readRegs;
-	readRegs.push(REGS(2, 4, 8 << 8));
-	readRegs.push(REGS(2, 4, 8 << 8));
+	readRegs.push(REGS(3, 4, 0, 8));
+	readRegs.push(REGS(3, 4, 0, 8));
 	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
 
 	// Act
@@ -2120,15 +2877,406 @@ TEST_F_TRAITS(MasterTests, sendDataToSlaves_Success_FirstDeviceDoesntRespond,
 	// Assert
 	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
 	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 2, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
-	assertPopRegsQueue(writtenRegs, REGS(8, 1, 5, 2, 8 + (5 << 8), 6, 0x8821, 0x5051, 0xAB));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 5, 2, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 12, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(6, 0, 12, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(6, 0, 9, Any<word*>()) +
+		Method(completeWriteRegsMock, result)).Once();
+}
+
+TEST_F_TRAITS(MasterTests, sendDataToSlaves_Broadcast_AllPagesReceived,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Arrange
+	MOCK_MODBUS;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	RegsQueue readRegs;
+	readRegs.push(REGS(6, 11, 1, 0x2, 0, 0x1, 0));
+	readRegs.push(REGS(6, 11, 1, 0x4, 0, 0x1, 0));
+	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
+
+	master->setBroadcastDataDistribution(true);
+
+	// Act
+	auto name = (byte*)"Meter01";
+	auto data = tracker.addArray(new byte[5]{ 0x21, 0x88, 0x51, 0x50, 0xAB });
+	T_MASTER::sendDataToSlaves_Task task(&T_MASTER::sendDataToSlaves, master, 0x12345678, 5, TimeScale::hr1, 8, name, data);
+	ASSERT_TRUE(task());
+
+	// Assert
+	assertPopRegsQueue(writtenRegs, withString(REGS(9, 1, 0x8004, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8, 44), "Meter01"));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 0x8005, 1, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
+	ASSERT_TRUE(writtenRegs.empty());
+	Verify(Method(completeWriteRegsMock, func).Using(0, 0, 13, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(0, 0, 9, Any<word*>()) +
+		Method(completeWriteRegsMock, result)).Once();
+	Verify(Method(completeReadRegsMock, func).Using(5, 0, 6)).Once();
+	Verify(Method(completeReadRegsMock, func).Using(6, 0, 6)).Once();
+}
+
+TEST_F_TRAITS(MasterTests, sendDataToSlaves_Broadcast_ResendMissedPageAndFallBack,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Arrange
+	MOCK_MODBUS;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	RegsQueue readRegs;
+	readRegs.push(REGS(6, 11, 1, 0x2, 0, 0, 0)); // accepted, but missed the only page
+	readRegs.push(REGS(6, 11, 1, 0x2, 0, 0x1, 0)); // got the page when it was resent
+	readRegs.push(REGS(6, 0, 1, 8, 0, 0, 0)); // missed the broadcast entirely
+	readRegs.push(REGS(3, 4, 0, 8));
+	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
+
+	master->setBroadcastDataDistribution(true);
+
+	// Act
+	auto name = (byte*)"Meter01";
+	auto data = tracker.addArray(new byte[5]{ 0x21, 0x88, 0x51, 0x50, 0xAB });
+	T_MASTER::sendDataToSlaves_Task task(&T_MASTER::sendDataToSlaves, master, 0x12345678, 5, TimeScale::hr1, 8, name, data);
+	ASSERT_TRUE(task());
+
+	// Assert
+	assertPopRegsQueue(writtenRegs, withString(REGS(9, 1, 0x8004, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8, 44), "Meter01"));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 0x8005, 1, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 0x8005, 1, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
+	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 2, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 5, 2, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
+	Verify(Method(completeWriteRegsMock, func).Using(0, 0, 13, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(0, 0, 9, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(5, 0, 9, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(6, 0, 12, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, result) +
+		Method(completeWriteRegsMock, func).Using(6, 0, 9, Any<word*>()) +
+		Method(completeWriteRegsMock, result)).Once();
+}
+
+TEST_F_TRAITS(MasterTests, sendDataToSlaves_Broadcast_ResentPageStillMissing,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	// Arrange
+	MOCK_MODBUS;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	RegsQueue readRegs;
+	readRegs.push(REGS(6, 11, 1, 0x2, 0, 0, 0));
+	readRegs.push(REGS(6, 11, 1, 0x2, 0, 0, 0)); // dropped the resent page too
+	readRegs.push(REGS(3, 4, 0, 8));
+	readRegs.push(REGS(6, 11, 1, 0x4, 0, 0x1, 0));
+	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
+
+	master->setBroadcastDataDistribution(true);
+
+	// Act
+	auto name = (byte*)"Meter01";
+	auto data = tracker.addArray(new byte[5]{ 0x21, 0x88, 0x51, 0x50, 0xAB });
+	T_MASTER::sendDataToSlaves_Task task(&T_MASTER::sendDataToSlaves, master, 0x12345678, 5, TimeScale::hr1, 8, name, data);
+	ASSERT_TRUE(task());
+
+	// Assert
+	assertPopRegsQueue(writtenRegs, withString(REGS(9, 1, 0x8004, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8, 44), "Meter01"));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 0x8005, 1, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 0x8005, 1, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
+	// Sent to the device on its own instead
+	assertPopRegsQueue(writtenRegs, withString(REGS(8, 1, 4, 1, 7, 0x5678, 0x1234, 5 + (6 << 8), 8), "Meter01"));
+	assertPopRegsQueue(writtenRegs, REGS(9, 1, 5, 1, 8, 5 + (6 << 8), 0, 0x8821, 0x5051, 0xAB));
+	ASSERT_TRUE(writtenRegs.empty());
+	Verify(Method(completeReadRegsMock, func).Using(5, 0, 6)).Twice();
+}
+
+TEST_F_TRAITS(MasterTests, sendDataToSlaves_Broadcast_TooManyPages,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	// Arrange
+	MOCK_MODBUS;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(7);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	RegsQueue readRegs;
+	readRegs.push(REGS(3, 4, 2, 0));
+	readRegs.push(REGS(3, 4, 2, 0));
+	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
+
+	master->setBroadcastDataDistribution(true);
+
+	// Act
+	auto name = (byte*)"Meter01";
+	auto data = tracker.addArray(new byte[5]{ 0x21, 0x88, 0x51, 0x50, 0xAB });
+	T_MASTER::sendDataToSlaves_Task task(&T_MASTER::sendDataToSlaves, master, 0x12345678, 5, TimeScale::hr1, 44 * 32 + 1, name, data);
+	ASSERT_TRUE(task());
+
+	// Assert
+	Verify(Method(completeWriteRegsMock, func).Using(0, _, _, _)).Never();
 	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 12, Any<word*>()) +
+		Method(completeWriteRegsMock, result) +
 		Method(completeWriteRegsMock, result) +
 		Method(completeWriteRegsMock, func).Using(6, 0, 12, Any<word*>()) +
 		Method(completeWriteRegsMock, result) +
-		Method(completeWriteRegsMock, func).Using(6, 0, 8, Any<word*>()) +
 		Method(completeWriteRegsMock, result)).Once();
 }
 
+TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_OneReadPage_Cached,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Arrange
+	MOCK_MODBUS;
+	Mock<IMockedTask<void, uint32_t, byte, TimeScale, word, byte*, byte*>> sendDataToSlavesMock;
+	T_MASTER::sendDataToSlaves_Task::mock = &sendDataToSlavesMock.get();
+	When(Method(sendDataToSlavesMock, func)).AlwaysReturn(true);
+	Fake(Method(sendDataToSlavesMock, result));
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	RegsQueue readRegs;
+	readRegs.push(REGS(7, 3, 0, 15000, 0, 8, 0, 0));
+	readRegs.push(REGS(4, 0x4182, 0xB0E1, 0x4468, 0x26));
+	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
+
+	DataPageCache cache;
+	cache.init(128, 9, 4);
+	master->setDataCache(&cache);
+
+	// Act
+	DeviceDirectoryRow inputDeviceRow = DeviceDirectoryRow(5, 3, DataCollectorDeviceType(true, TimeScale::min10, 7), 14);
+	auto name = (byte*)"Meter 001";
+	T_MASTER::readAndSendDeviceData_Task task(&T_MASTER::readAndSendDeviceData, master, &inputDeviceRow, 9, name, 15000, 20000);
+	ASSERT_TRUE(task());
+
+	// Assert
+	Verify(Method(sendDataToSlavesMock, func)).Never();
+	ASSERT_EQ(cache.getNumPages(), 1);
+	uint32_t cursor = 0;
+	DataPageCacheEntry entry;
+	byte cachedName[9];
+	byte cachedData[7];
+	ASSERT_TRUE(cache.readPage(cursor, entry, cachedName, cachedData, 7));
+	ASSERT_EQ(entry.startTime, 15000);
+	ASSERT_EQ(entry.dataSize, 7);
+	ASSERT_EQ(entry.timeScale, TimeScale::min10);
+	ASSERT_EQ(entry.numPoints, 8);
+	ASSERT_EQ(stringifyCharArray(9, (char*)cachedName), "Meter 001");
+	assertArrayEq<byte, byte, byte, byte, byte, byte, byte>(cachedData,
+		0x82, 0x41, 0xE1, 0xB0, 0x68, 0x44, 0x26);
+	master->setDataCache(nullptr);
+}
+
+TEST_F_TRAITS(MasterTests, readAndSendDeviceData_Success_OneReadPage_Archived,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Arrange
+	MOCK_MODBUS;
+	Mock<IMockedTask<void, uint32_t, byte, TimeScale, word, byte*, byte*>> sendDataToSlavesMock;
+	T_MASTER::sendDataToSlaves_Task::mock = &sendDataToSlavesMock.get();
+	When(Method(sendDataToSlavesMock, func)).AlwaysReturn(true);
+	Fake(Method(sendDataToSlavesMock, result));
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	completeWriteRegs_UseRegsQueue(completeWriteRegsMock, writtenRegs);
+	When(Method(completeWriteRegsMock, result)).AlwaysReturn(success);
+
+	RegsQueue readRegs;
+	readRegs.push(REGS(7, 3, 0, 15000, 0, 8, 0, 0));
+	readRegs.push(REGS(4, 0x4182, 0xB0E1, 0x4468, 0x26));
+	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
+
+	Mock<DataArchive> archiveMock;
+	string archivedName;
+	byte archivedData[7];
+	When(Method(archiveMock, append)).AlwaysDo([&](byte *deviceName, uint32_t startTime, byte dataSize,
+		TimeScale timeScale, word numPoints, byte *data)
+	{
+		archivedName = stringifyCharArray(9, (char*)deviceName);
+		memcpy(archivedData, data, 7);
+		return true;
+	});
+	master->setDataArchive(&archiveMock.get());
+
+	// Act
+	DeviceDirectoryRow inputDeviceRow = DeviceDirectoryRow(5, 3, DataCollectorDeviceType(true, TimeScale::min10, 7), 14);
+	auto name = (byte*)"Meter 001";
+	T_MASTER::readAndSendDeviceData_Task task(&T_MASTER::readAndSendDeviceData, master, &inputDeviceRow, 9, name, 15000, 20000);
+	ASSERT_TRUE(task());
+
+	// Assert
+	Verify(Method(sendDataToSlavesMock, func)).Once();
+	Verify(Method(archiveMock, append).Using(_, 15000, 7, TimeScale::min10, 8, _)).Once();
+	ASSERT_EQ(archivedName, "Meter 001");
+	assertArrayEq<byte, byte, byte, byte, byte, byte, byte>(archivedData,
+		0x82, 0x41, 0xE1, 0xB0, 0x68, 0x44, 0x26);
+	master->setDataArchive(nullptr);
+}
+
+TEST_F_TRAITS(MasterTests, deliverCachedData_Success_DeferNonResponding,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Arrange
+	MockNewMethod(deliveredPage, byte slaveId, word deviceNumber, uint32_t startTime, string name);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<ModbusRequestStatus, DeviceDirectoryRow*, uint32_t, byte, TimeScale, word, byte*, byte*>> sendDataToDeviceMock;
+	T_MASTER::sendDataToDevice_Task::mock = &sendDataToDeviceMock.get();
+	ModbusRequestStatus lastResult = success;
+	When(Method(sendDataToDeviceMock, func)).AlwaysDo([&deliveredPage, &lastResult](DeviceDirectoryRow* device, uint32_t startTime,
+		byte dataSize, TimeScale timeScale, word numDataPoints, byte* name, byte* data)
+	{
+		deliveredPage.get().method(device->slaveId, device->deviceNumber, startTime, stringifyCharArray(4, (char*)name));
+		lastResult = device->slaveId == 6 ? noResponse : success;
+		return true;
+	});
+	When(Method(sendDataToDeviceMock, result)).AlwaysDo([&lastResult]() { return lastResult; });
+
+	DataPageCache cache;
+	cache.init(128, 4, 4);
+	byte data[2] = { 0xAB, 0xCD };
+	cache.append((byte*)"dev0", 1000, 8, TimeScale::sec1, 2, data);
+	cache.append((byte*)"dev1", 1002, 8, TimeScale::sec1, 2, data);
+	master->setDataCache(&cache);
+
+	// Act
+	T_MASTER::deliverCachedData_Task task(&T_MASTER::deliverCachedData, master);
+	ASSERT_TRUE(task());
+
+	// Assert
+	Verify(Method(deliveredPage, method).Using(5, 1, 1000, "dev0") +
+		Method(deliveredPage, method).Using(5, 1, 1002, "dev1") +
+		Method(deliveredPage, method).Using(6, 2, 1000, "dev0")).Once();
+	uint32_t cursor;
+	cache.getCursor(5, 1, cursor);
+	ASSERT_FALSE(cache.hasPendingPages(cursor));
+	cache.getCursor(6, 2, cursor);
+	ASSERT_EQ(cursor, 0);
+	master->setDataCache(nullptr);
+}
+
+TEST_F_TRAITS(MasterTests, deliverCachedData_PageWriteTimesOut_CursorKept,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	// Arrange
+	MOCK_MODBUS;
+	When(Method(mockDeviceDirectory, getDeviceNameLength)).AlwaysReturn(4);
+	auto devices = Setup_DataCollectorsAndTransmitters();
+
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word>> completeReadRegsMock;
+	T_MASTER::completeModbusReadRegisters_Task::mock = &completeReadRegsMock.get();
+	When(Method(completeReadRegsMock, func)).AlwaysReturn(true);
+	When(Method(completeReadRegsMock, result)).AlwaysReturn(success);
+
+	// Slave 5 doesn't answer the write of the second of three pages
+	Mock<IMockedTask<ModbusRequestStatus, byte, word, word, word*>> completeWriteRegsMock;
+	T_MASTER::completeModbusWriteRegisters_Task::mock = &completeWriteRegsMock.get();
+	RegsQueue writtenRegs;
+	ModbusRequestStatus lastResult = success;
+	completeWriteRegs_UseRegsQueue_Passthrough(completeWriteRegsMock, writtenRegs, [&lastResult](byte slaveId, word start, word count, word* data)
+	{
+		lastResult = (slaveId == 5 && data[1] == 5 && data[5] == 1) ? noResponse : success;
+		return true;
+	});
+	When(Method(completeWriteRegsMock, result)).AlwaysDo([&lastResult]() { return lastResult; });
+
+	RegsQueue readRegs;
+	readRegs.push(REGS(3, 4, 0, 1));
+	readRegs.push(REGS(3, 4, 0, 1));
+	isRegsResponse_UseMockData(modbusBaseMock, readRegs);
+
+	DataPageCache cache;
+	cache.init(128, 4, 4);
+	byte data[3] = { 0x11, 0x22, 0x33 };
+	cache.append((byte*)"dev0", 1000, 8, TimeScale::sec1, 3, data);
+	master->setDataCache(&cache);
+
+	// Act
+	T_MASTER::deliverCachedData_Task task(&T_MASTER::deliverCachedData, master);
+	ASSERT_TRUE(task());
+
+	// Assert
+	// The third page isn't sent to slave 5 after the second times out
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 10, Any<word*>())).Once();
+	Verify(Method(completeWriteRegsMock, func).Using(5, 0, 7, Any<word*>())).Twice();
+	Verify(Method(completeWriteRegsMock, func).Using(6, 0, 10, Any<word*>())).Once();
+	Verify(Method(completeWriteRegsMock, func).Using(6, 0, 7, Any<word*>())).Exactly(3);
+	Verify(Method(mockDeviceDirectory, recordDeviceNoResponse)).Once();
+	uint32_t cursor;
+	cache.getCursor(5, 1, cursor);
+	ASSERT_EQ(cursor, 0);
+	ASSERT_TRUE(cache.hasPendingPages(cursor));
+	cache.getCursor(6, 2, cursor);
+	ASSERT_FALSE(cache.hasPendingPages(cursor));
+	master->setDataCache(nullptr);
+}
+
 TEST_F_TRAITS(MasterTests, requestTime_Success_First,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
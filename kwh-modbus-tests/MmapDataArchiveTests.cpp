@@ -0,0 +1,183 @@
+#include "pch.h"
+
+// The archive is memory mapped with POSIX calls, so it is only tested on Linux
+#ifdef __linux__
+#include "../kwh-modbus/libraries/mmapDataArchive/MmapDataArchive.hpp"
+#include "test_helpers.h"
+
+#include <stdlib.h>
+
+using namespace std;
+
+class MmapDataArchiveTests : public ::testing::Test
+{
+protected:
+	char directory[32];
+	MmapDataArchive archive;
+
+public:
+	void SetUp()
+	{
+		strcpy(directory, "/tmp/kwhArchiveXXXXXX");
+		ASSERT_NE(mkdtemp(directory), nullptr);
+		ASSERT_TRUE(archive.init(directory, 4, 16, 2));
+	}
+
+	void TearDown()
+	{
+		archive.clear();
+		string command = string("rm -rf ") + directory;
+		system(command.c_str());
+	}
+
+	string getSegmentPath(const char *name, TimeScale timeScale, uint32_t segmentIndex)
+	{
+		char path[256];
+		archive.getSegmentPath((byte*)name, timeScale, segmentIndex, path, sizeof(path));
+		return string(path);
+	}
+};
+
+TEST_F_TRAITS(MmapDataArchiveTests, append_Success_IndexedByTimeCode,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// 10 bit points 1, 2, 1023, 4 starting 10 minutes past epoch, which is time code 10
+	byte data[5] = { 0x01, 0x08, 0xF0, 0x3F, 0x01 };
+	auto name = (byte*)"Mtr1";
+
+	ASSERT_TRUE(archive.append(name, 600, 10, TimeScale::min1, 4, data));
+
+	uint64_t value;
+	ASSERT_TRUE(archive.getPoint(name, TimeScale::min1, 10, value));
+	ASSERT_EQ(value, 1);
+	ASSERT_TRUE(archive.getPoint(name, TimeScale::min1, 12, value));
+	ASSERT_EQ(value, 1023);
+	ASSERT_TRUE(archive.getPoint(name, TimeScale::min1, 13, value));
+	ASSERT_EQ(value, 4);
+	ASSERT_FALSE(archive.getPoint(name, TimeScale::min1, 9, value));
+	ASSERT_FALSE(archive.getPoint(name, TimeScale::sec15, 10, value));
+}
+
+TEST_F_TRAITS(MmapDataArchiveTests, append_Success_SpansSegments,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	// 8 bit points at time codes 14 through 18, across the segment boundary at 16
+	byte data[5] = { 10, 11, 12, 13, 14 };
+	auto name = (byte*)"Mtr1";
+
+	ASSERT_TRUE(archive.append(name, 840, 8, TimeScale::min1, 5, data));
+
+	uint64_t value;
+	ASSERT_TRUE(archive.getPoint(name, TimeScale::min1, 15, value));
+	ASSERT_EQ(value, 11);
+	ASSERT_TRUE(archive.getPoint(name, TimeScale::min1, 16, value));
+	ASSERT_EQ(value, 12);
+	ASSERT_TRUE(archive.getPoint(name, TimeScale::min1, 18, value));
+	ASSERT_EQ(value, 14);
+}
+
+TEST_F_TRAITS(MmapDataArchiveTests, getRange_Success_PointsIntoMapping,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	byte data[4] = { 1, 2, 3, 4 };
+	auto name = (byte*)"Mtr1";
+	ASSERT_TRUE(archive.append(name, 780, 8, TimeScale::min1, 4, data));
+
+	const MmapDataArchiveRecord *records = nullptr;
+	const MmapDataArchiveRecord *sameRecords = nullptr;
+	auto count = archive.getRange(name, TimeScale::min1, 12, 10, records);
+	archive.getRange(name, TimeScale::min1, 13, 1, sameRecords);
+
+	// Stops at the end of the segment, and includes the points never archived
+	ASSERT_EQ(count, 4);
+	ASSERT_EQ(sameRecords, records + 1);
+	ASSERT_FALSE(records[0].isValid());
+	ASSERT_TRUE(records[1].isValid());
+	ASSERT_EQ(records[1].timeCode, 13);
+	ASSERT_EQ(records[1].value, 1);
+	ASSERT_EQ(records[3].value, 3);
+}
+
+TEST_F_TRAITS(MmapDataArchiveTests, getRange_Empty_NoSegment,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	const MmapDataArchiveRecord *records = nullptr;
+	auto count = archive.getRange((byte*)"Mtr1", TimeScale::min1, 12, 10, records);
+
+	ASSERT_EQ(count, 0);
+}
+
+TEST_F_TRAITS(MmapDataArchiveTests, init_Success_Reopen,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	byte data[2] = { 0x34, 0x12 };
+	auto name = (byte*)"Mtr1";
+	ASSERT_TRUE(archive.append(name, 900, 16, TimeScale::sec15, 1, data));
+
+	archive.clear();
+	ASSERT_TRUE(archive.init(directory, 4, 16, 2));
+
+	uint64_t value;
+	ASSERT_TRUE(archive.getPoint(name, TimeScale::sec15, 60, value));
+	ASSERT_EQ(value, 0x1234);
+	ASSERT_EQ(archive.getRecoveredRecords(), 0);
+}
+
+TEST_F_TRAITS(MmapDataArchiveTests, init_Success_TornRecordRecovered,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	byte data[3] = { 7, 8, 9 };
+	auto name = (byte*)"Mtr1";
+	ASSERT_TRUE(archive.append(name, 60, 8, TimeScale::min1, 3, data));
+	auto path = getSegmentPath("Mtr1", TimeScale::min1, 0);
+	archive.clear();
+
+	// Crash while writing the third point: value written, check not
+	FILE *file = fopen(path.c_str(), "r+b");
+	ASSERT_NE(file, nullptr);
+	uint32_t check = 0;
+	fseek(file, sizeof(MmapDataArchiveSegmentHeader) + 3 * sizeof(MmapDataArchiveRecord) + 12, SEEK_SET);
+	fwrite(&check, sizeof(check), 1, file);
+	fclose(file);
+	ASSERT_TRUE(archive.init(directory, 4, 16, 2));
+
+	uint64_t value;
+	ASSERT_TRUE(archive.getPoint(name, TimeScale::min1, 2, value));
+	ASSERT_EQ(value, 8);
+	ASSERT_FALSE(archive.getPoint(name, TimeScale::min1, 3, value));
+	ASSERT_EQ(archive.getRecoveredRecords(), 1);
+	const MmapDataArchiveRecord *records = nullptr;
+	archive.getRange(name, TimeScale::min1, 3, 1, records);
+	ASSERT_EQ(records[0].value, 0);
+}
+
+TEST_F_TRAITS(MmapDataArchiveTests, append_Failure_DataSizeChanged,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	byte data[2] = { 1, 2 };
+	auto name = (byte*)"Mtr1";
+	ASSERT_TRUE(archive.append(name, 120, 8, TimeScale::min1, 1, data));
+
+	ASSERT_FALSE(archive.append(name, 180, 16, TimeScale::min1, 1, data));
+}
+
+TEST_F_TRAITS(MmapDataArchiveTests, append_Success_EvictsSegments,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	// Three devices with only two segments open at a time
+	byte data[1] = { 5 };
+	ASSERT_TRUE(archive.append((byte*)"Mtr1", 60, 8, TimeScale::min1, 1, data));
+	data[0] = 6;
+	ASSERT_TRUE(archive.append((byte*)"Mtr2", 60, 8, TimeScale::min1, 1, data));
+	data[0] = 7;
+	ASSERT_TRUE(archive.append((byte*)"Mtr3", 60, 8, TimeScale::min1, 1, data));
+
+	uint64_t value;
+	ASSERT_TRUE(archive.getPoint((byte*)"Mtr1", TimeScale::min1, 1, value));
+	ASSERT_EQ(value, 5);
+	ASSERT_TRUE(archive.getPoint((byte*)"Mtr2", TimeScale::min1, 1, value));
+	ASSERT_EQ(value, 6);
+	ASSERT_TRUE(archive.getPoint((byte*)"Mtr3", TimeScale::min1, 1, value));
+	ASSERT_EQ(value, 7);
+}
+#endif
@@ -210,6 +210,57 @@ TEST_F_TRAITS(ModbusSlaveTests, ModbusSlave_ReceivePDU_ReadRegisters_SlaveFailur
 		MB_EX_SLAVE_FAILURE);
 }
 
+TEST_F_TRAITS(ModbusSlaveTests, ModbusSlave_ReceivePDU_ReadRegisters_ProviderCalled,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	Mock<IRegisterProvider> provider;
+	When(Method(provider, provideRegisters)).AlwaysDo([&](word startReg, word numRegs)
+	{
+		modbus->Hreg(6, 555);
+		return true;
+	});
+	modbus->setRegisterProvider(&provider.get());
+	modbus->resetFrame(5);
+	setup_FourRegisters();
+	byte *frame = modbus->getFramePtr();
+
+	setArray(frame,
+		(byte)MB_FC_READ_REGS,
+		revBytes<word>(5),
+		revBytes<word>(4));
+
+	bool success = modbus->receivePDU(frame);
+
+	ASSERT_TRUE(success);
+	Verify(Method(provider, provideRegisters).Using(5, 4)).Once();
+	ASSERT_EQ(modbus->getFrameReg(1, 1), 555);
+}
+
+TEST_F_TRAITS(ModbusSlaveTests, ModbusSlave_ReceivePDU_ReadRegisters_ProviderFailure,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	Mock<IRegisterProvider> provider;
+	When(Method(provider, provideRegisters)).Return(false);
+	modbus->setRegisterProvider(&provider.get());
+	modbus->resetFrame(5);
+	setup_FourRegisters();
+	byte *frame = modbus->getFramePtr();
+
+	setArray(frame,
+		(byte)MB_FC_READ_REGS,
+		revBytes<word>(5),
+		revBytes<word>(4));
+
+	bool success = modbus->receivePDU(frame);
+
+	frame = modbus->getFramePtr();
+
+	ASSERT_FALSE(success);
+	assertArrayEq<byte, byte>(frame,
+		MB_FC_READ_REGS + 0x80,
+		MB_EX_SLAVE_FAILURE);
+}
+
 TEST_F_TRAITS(ModbusSlaveTests, ModbusSlave_ReceivePDU_WriteRegisters_Success,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
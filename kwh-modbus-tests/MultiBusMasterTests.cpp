@@ -0,0 +1,123 @@
+#include "pch.h"
+#include "../kwh-modbus/libraries/modbus/ModbusArray.h"
+#include "../kwh-modbus/libraries/multiBusMaster/MultiBusMaster.hpp"
+#include "../kwh-modbus/libraries/resilientModbusMaster/ResilientModbusMaster.hpp"
+#include "../kwh-modbus/mock/MockSerialStream.h"
+#include "../kwh-modbus/mock/MockableResilientModbusMaster.hpp"
+#include "../kwh-modbus/libraries/deviceDirectory/DeviceDirectory.hpp"
+#include "WindowsSystemFunctions.h"
+#include "test_helpers.h"
+
+typedef MockableResilientModbusMaster<MockSerialStream, WindowsSystemFunctions, ModbusArray> T_MODBUS;
+typedef MultiBusMaster<T_MODBUS, WindowsSystemFunctions, DeviceDirectory> T_MULTI;
+
+class MultiBusMasterTests : public ::testing::Test
+{
+protected:
+	WindowsSystemFunctions system;
+	T_MODBUS modbus[3];
+	DeviceDirectory directories[3];
+	T_MULTI multi;
+
+public:
+	void SetUp()
+	{
+		ASSERT_TRUE(multi.init(3, 4, 10, 10, 15, 128, 4, 2));
+		for (byte i = 0; i < 3; i++)
+		{
+			directories[i].init(4, 5);
+			multi.configBus(i, &system, modbus + i, directories + i);
+		}
+	}
+};
+
+TEST_F_TRAITS(MultiBusMasterTests, forwardPage_ToOtherBuses,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	byte data[3] = { 0x12, 0x34, 0x56 };
+	auto archive = multi.getMaster(0).getDataArchive();
+
+	ASSERT_TRUE(archive->append((byte*)"mtr0", 1500, 8, TimeScale::min1, 3, data));
+
+	ASSERT_EQ(multi.receiveForwardedPages(0), 0);
+	ASSERT_EQ(multi.receiveForwardedPages(1), 1);
+	ASSERT_EQ(multi.receiveForwardedPages(2), 1);
+	ASSERT_EQ(multi.getDataCache(0).getNumPages(), 0);
+	ASSERT_EQ(multi.getDataCache(2).getNumPages(), 1);
+
+	uint32_t cursor = 0;
+	DataPageCacheEntry entry;
+	byte name[4];
+	byte cachedData[3];
+	ASSERT_TRUE(multi.getDataCache(1).readPage(cursor, entry, name, cachedData, 3));
+	ASSERT_EQ(entry.startTime, 1500);
+	ASSERT_EQ(entry.numPoints, 3);
+	ASSERT_EQ(entry.dataSize, 8);
+	ASSERT_EQ(entry.timeScale, TimeScale::min1);
+	ASSERT_EQ(stringifyCharArray(4, (char*)name), "mtr0");
+	assertArrayEq<byte, byte, byte>(cachedData, 0x12, 0x34, 0x56);
+}
+
+TEST_F_TRAITS(MultiBusMasterTests, forwardPage_QueueFull,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	byte data[1] = { 1 };
+	auto archive = multi.getMaster(2).getDataArchive();
+
+	archive->append((byte*)"mtr2", 60, 8, TimeScale::min1, 1, data);
+	archive->append((byte*)"mtr2", 120, 8, TimeScale::min1, 1, data);
+	multi.receiveForwardedPages(0);
+	archive->append((byte*)"mtr2", 180, 8, TimeScale::min1, 1, data);
+
+	// Two slots per queue, and bus 1 hasn't received anything
+	ASSERT_EQ(multi.getDroppedPages(2), 1);
+	ASSERT_EQ(multi.receiveForwardedPages(1), 2);
+	ASSERT_EQ(multi.receiveForwardedPages(0), 1);
+}
+
+TEST_F_TRAITS(MultiBusMasterTests, forwardPage_ChainsArchive,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	DataPageCache archived;
+	class CacheArchive : public DataArchive
+	{
+	public:
+		DataPageCache *cache;
+		bool append(byte *deviceName, uint32_t startTime, byte dataSize, TimeScale timeScale, word numPoints, byte *data)
+		{
+			return cache->append(deviceName, startTime, dataSize, timeScale, numPoints, data);
+		}
+	} archive;
+	archived.init(128, 4, 1);
+	archive.cache = &archived;
+	multi.setDataArchive(1, &archive);
+	byte data[1] = { 1 };
+
+	multi.getMaster(1).getDataArchive()->append((byte*)"mtr1", 60, 8, TimeScale::min1, 1, data);
+
+	ASSERT_EQ(archived.getNumPages(), 1);
+	ASSERT_EQ(multi.receiveForwardedPages(0), 1);
+}
+
+TEST_F_TRAITS(MultiBusMasterTests, publishDeviceDirectory_OnlyWhenChanged,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	directories[1].addDevice((byte*)"dev1", DeviceDirectoryRow(2, 0, 0x8000, 1));
+
+	multi.publishDeviceDirectory(1);
+	ASSERT_EQ(multi.getDeviceDirectory().getDeviceCount(), 1);
+
+	// Changes go through the directory of the bus, so the shared copy isn't touched again until then
+	multi.getDeviceDirectory().clear();
+	multi.getDeviceDirectory().init(4, 10);
+	multi.publishDeviceDirectory(1);
+	ASSERT_EQ(multi.getDeviceDirectory().getDeviceCount(), 0);
+
+	directories[1].addDevice((byte*)"dev2", DeviceDirectoryRow(3, 0, 0x8000, 1));
+	multi.publishDeviceDirectory(1);
+	byte bus;
+	DeviceDirectoryRow device;
+	ASSERT_EQ(multi.getDeviceDirectory().getDeviceCount(), 2);
+	ASSERT_TRUE(multi.getDeviceDirectory().findDevice((byte*)"dev2", bus, device));
+	ASSERT_EQ(bus, 1);
+}
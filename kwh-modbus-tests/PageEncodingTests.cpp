@@ -0,0 +1,193 @@
+#include "pch.h"
+#include "../kwh-modbus/libraries/pageEncoding/PageEncoding.hpp"
+#include "test_helpers.h"
+#include "../kwh-modbus/noArduino/ArduinoMacros.h"
+
+TEST_TRAITS(PageEncodingTests, zigzagVarint_Encode_SmallDeltas,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// 8 bit points 5, 6, 6, 4
+	byte points[4] = { 5, 6, 6, 4 };
+	byte encoded[8] = { 0 };
+
+	auto bits = PageEncoder::encode(PageEncoding::zigzagVarint, points, 0, 4, 8, encoded, 0, 64);
+
+	ASSERT_EQ(bits, 32);
+	assertArrayEq<byte, byte, byte, byte>(encoded, 10, 2, 0, 3);
+}
+
+TEST_TRAITS(PageEncodingTests, zigzagVarint_Encode_MultiByteDelta,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	word points[2] = { 0, 300 };
+	byte encoded[4] = { 0 };
+
+	auto bits = PageEncoder::encode(PageEncoding::zigzagVarint, points, 0, 2, 16, encoded, 0, 32);
+
+	// 600 = 0b100 1011000
+	ASSERT_EQ(bits, 24);
+	assertArrayEq<byte, byte, byte>(encoded, 0, 0xD8, 0x04);
+}
+
+TEST_TRAITS(PageEncodingTests, zigzagVarint_Encode_TooLong,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	byte points[2] = { 200, 10 };
+	byte encoded[4] = { 0 };
+
+	auto bits = PageEncoder::encode(PageEncoding::zigzagVarint, points, 0, 2, 8, encoded, 0, 15);
+
+	ASSERT_EQ(bits, 0);
+}
+
+TEST_TRAITS(PageEncodingTests, zigzagVarint_RoundTrip_Wraparound,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	// 12 bit meter rolling over from 4094 to 3
+	byte src[6] = { 0 };
+	word values[4] = { 4094, 4095, 1, 3 };
+	for (int i = 0; i < 4; i++)
+		BitFunctions::copyBits<word, byte, uint32_t>(values + i, src, 0, i * 12, 12);
+	byte encoded[8] = { 0 };
+	byte decoded[6] = { 0 };
+
+	auto bits = PageEncoder::encode(PageEncoding::zigzagVarint, src, 0, 4, 12, encoded, 0, 64);
+	bool success = PageEncoder::decode(PageEncoding::zigzagVarint, encoded, 0, bits, 4, 12, decoded);
+
+	// First point is a large delta from 0 (-2 wrapped), then deltas of 1, 2 and 2
+	ASSERT_EQ(bits, 32);
+	ASSERT_TRUE(success);
+	assertArrayEq<byte, byte, byte, byte, byte, byte>(decoded, src[0], src[1], src[2], src[3], src[4], src[5]);
+}
+
+TEST_TRAITS(PageEncodingTests, zigzagVarint_Decode_Truncated,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	byte encoded[2] = { 0xD8, 0x84 };
+	word decoded[2] = { 0 };
+
+	bool success = PageEncoder::decode(PageEncoding::zigzagVarint, encoded, 0, 16, 1, 16, decoded);
+
+	ASSERT_FALSE(success);
+}
+
+TEST_TRAITS(PageEncodingTests, packedDelta_Encode_AccumulatingSeries,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// 16 bit points 1000, 1001, 1003, 1003, 1002
+	word points[5] = { 1000, 1001, 1003, 1003, 1002 };
+	byte encoded[8] = { 0 };
+
+	auto bits = PageEncoder::encode(PageEncoding::packedDelta, points, 0, 5, 16, encoded, 0, 80);
+
+	// Zigzagged deltas 2, 4, 0, 1 need 3 bits each
+	ASSERT_EQ(bits, 8 + 16 + 4 * 3);
+	ASSERT_EQ(encoded[0], 3);
+	ASSERT_EQ(encoded[1] + (encoded[2] << 8), 1000);
+	ASSERT_EQ(encoded[3], 0x22);
+	ASSERT_EQ(encoded[4], 0x02);
+}
+
+TEST_TRAITS(PageEncodingTests, packedDelta_RoundTrip_WithOffsets,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Second page of 5 bit points, encoded after a 96 bit header, as in a data page write
+	byte src[5] = { 0x21, 0x88, 0x51, 0x50, 0xAB };
+	word registers[10] = { 0 };
+	byte decoded[4] = { 0 };
+	byte expected[4] = { 0 };
+	BitFunctions::copyBits<byte, byte, uint32_t>(src, expected, 20, 0, 20);
+
+	auto bits = PageEncoder::encode(PageEncoding::packedDelta, src, 20, 4, 5, registers, 96, 64);
+	bool success = PageEncoder::decode(PageEncoding::packedDelta, registers, 96, bits, 4, 5, decoded);
+
+	ASSERT_GT(bits, 0);
+	ASSERT_TRUE(success);
+	assertArrayEq<byte, byte, byte>(decoded, expected[0], expected[1], expected[2]);
+}
+
+TEST_TRAITS(PageEncodingTests, packedDelta_Encode_ConstantSeries,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	word points[4] = { 77, 77, 77, 77 };
+	byte encoded[4] = { 0 };
+	word decoded[4] = { 0 };
+
+	auto bits = PageEncoder::encode(PageEncoding::packedDelta, points, 0, 4, 16, encoded, 0, 64);
+	bool success = PageEncoder::decode(PageEncoding::packedDelta, encoded, 0, bits, 4, 16, decoded);
+
+	ASSERT_EQ(bits, 24);
+	ASSERT_TRUE(success);
+	assertArrayEq<word, word, word, word>(decoded, 77, 77, 77, 77);
+}
+
+TEST_TRAITS(PageEncodingTests, packedDelta_Decode_BadWidth,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	byte encoded[4] = { 9, 1, 0, 0 };
+	byte decoded[2] = { 0 };
+
+	bool success = PageEncoder::decode(PageEncoding::packedDelta, encoded, 0, 32, 2, 8, decoded);
+
+	ASSERT_FALSE(success);
+}
+
+TEST_TRAITS(PageEncodingTests, raw_RoundTrip,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	byte src[3] = { 0x21, 0x88, 0x51 };
+	byte encoded[3] = { 0 };
+	byte decoded[3] = { 0 };
+
+	auto bits = PageEncoder::encode(PageEncoding::raw, src, 0, 4, 5, encoded, 0, 24);
+	bool success = PageEncoder::decode(PageEncoding::raw, encoded, 0, bits, 4, 5, decoded);
+
+	ASSERT_EQ(bits, 20);
+	ASSERT_TRUE(success);
+	assertArrayEq<byte, byte, byte>(decoded, 0x21, 0x88, 0x01);
+}
+
+TEST_TRAITS(PageEncodingTests, deadband_RoundTrip_RepeatsOnly,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	word points[6] = { 500, 500, 500, 501, 501, 500 };
+	byte encoded[12] = { 0 };
+	word decoded[6] = { 0 };
+
+	auto bits = PageEncoder::encode(PageEncoding::deadband, points, 0, 6, 16, encoded, 0, 96);
+	bool success = PageEncoder::decode(PageEncoding::deadband, encoded, 0, bits, 6, 16, decoded);
+
+	// Points 0, 3 and 5 are carried
+	ASSERT_EQ(bits, 6 + 3 * 16);
+	ASSERT_EQ(encoded[0] & 0x3F, 0x29);
+	ASSERT_TRUE(success);
+	assertArrayEq<word, word, word, word, word, word>(decoded, 500, 500, 500, 501, 501, 500);
+}
+
+TEST_TRAITS(PageEncodingTests, deadband_RoundTrip_Threshold,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	// Small drift is left out, but is measured from the last carried point so it can't build up.
+	// Missing points are always carried.
+	byte points[8] = { 50, 51, 52, 53, 255, 255, 53, 54 };
+	byte encoded[8] = { 0 };
+	byte decoded[8] = { 0 };
+
+	auto bits = PageEncoder::encode(PageEncoding::deadband, points, 0, 8, 8, encoded, 0, 64, 2);
+	bool success = PageEncoder::decode(PageEncoding::deadband, encoded, 0, bits, 8, 8, decoded);
+
+	ASSERT_EQ(bits, 8 + 4 * 8);
+	ASSERT_TRUE(success);
+	assertArrayEq<byte, byte, byte, byte, byte, byte, byte, byte>(decoded, 50, 50, 50, 53, 255, 255, 53, 53);
+}
+
+TEST_TRAITS(PageEncodingTests, deadband_Decode_FirstPointNotCarried,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	byte encoded[3] = { 0x02, 0x10, 0x00 };
+	byte decoded[2] = { 0 };
+
+	bool success = PageEncoder::decode(PageEncoding::deadband, encoded, 0, 24, 2, 8, decoded);
+
+	ASSERT_FALSE(success);
+}
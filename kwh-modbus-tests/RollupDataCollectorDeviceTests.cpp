@@ -0,0 +1,72 @@
+#include "pch.h"
+#include "../kwh-modbus/libraries/device/RollupDataCollectorDevice.h"
+#include "test_helpers.h"
+
+TEST_TRAITS(RollupDataCollectorDeviceTests, readData_SummedWhenAccumulating,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BufferedDataCollectorDevice source;
+	ASSERT_TRUE(source.init(true, TimeScale::sec15, 8, 16));
+	for (uint32_t time = 600; time < 780; time += 15)
+	{
+		if (time != 735)
+			source.recordAt(time, 0, time / 15 - 39);
+	}
+	RollupDataCollectorDevice rollup;
+	ASSERT_TRUE(rollup.init(&source, TimeScale::min1, 16));
+	ASSERT_EQ(rollup.getType(), 0x6D00);
+	byte buffer[8];
+	word numDataPointsInPage;
+	word pagesRemaining;
+	byte dataPointSize;
+
+	ASSERT_TRUE(rollup.readData(600, 4, 0, buffer, 8, 0, numDataPointsInPage, pagesRemaining, dataPointSize));
+
+	ASSERT_EQ(numDataPointsInPage, 4);
+	ASSERT_EQ(dataPointSize, 16);
+	ASSERT_EQ(buffer[0], 1 + 2 + 3 + 4);
+	ASSERT_EQ(buffer[1], 0);
+	ASSERT_EQ(buffer[2], 5 + 6 + 7 + 8);
+	// One of its points is missing, so the sum would be wrong
+	ASSERT_EQ(buffer[4], 255);
+	ASSERT_EQ(buffer[5], 255);
+	// Newer than anything recorded
+	ASSERT_EQ(buffer[6], 255);
+}
+
+TEST_TRAITS(RollupDataCollectorDeviceTests, readDataPoint_AveragedOverPresentPoints,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	BufferedDataCollectorDevice source;
+	ASSERT_TRUE(source.init(false, TimeScale::min1, 12, 60));
+	for (uint32_t minute = 0; minute < 60; minute++)
+	{
+		if (minute % 10 == 0)
+			source.recordMissingAt(7200 + minute * 60, 0);
+		else
+			source.recordAt(7200 + minute * 60, 0, minute < 30 ? 100 : 3000);
+	}
+	RollupDataCollectorDevice rollup;
+	ASSERT_TRUE(rollup.init(&source, TimeScale::min30, 12));
+	byte point[2];
+
+	ASSERT_TRUE(rollup.readDataPoint(7200, 0, point, 12));
+	ASSERT_EQ(point[0] | (point[1] << 8), 100);
+	// Times within the period give the same point
+	ASSERT_TRUE(rollup.readDataPoint(9000 + 45, 0, point, 12));
+	ASSERT_EQ(point[0] | (point[1] << 8), 3000);
+	ASSERT_FALSE(rollup.readDataPoint(10800, 0, point, 12));
+}
+
+TEST_TRAITS(RollupDataCollectorDeviceTests, init_TimeScaleNotCoarser,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	BufferedDataCollectorDevice source;
+	ASSERT_TRUE(source.init(true, TimeScale::min10, 8, 16));
+	RollupDataCollectorDevice rollup;
+
+	ASSERT_FALSE(rollup.init(&source, TimeScale::min10, 8));
+	ASSERT_FALSE(rollup.init(&source, TimeScale::min1, 8));
+	ASSERT_FALSE(rollup.init(nullptr, TimeScale::hr1, 8));
+	ASSERT_TRUE(rollup.init(&source, TimeScale::hr1, 8));
+}
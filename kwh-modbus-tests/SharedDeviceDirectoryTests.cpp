@@ -0,0 +1,160 @@
+#include "pch.h"
+#include "../kwh-modbus/libraries/sharedDeviceDirectory/SharedDeviceDirectory.hpp"
+#include "../kwh-modbus/libraries/deviceDirectory/DeviceDirectory.hpp"
+#include "test_helpers.h"
+#include "../kwh-modbus/noArduino/ArduinoMacros.h"
+
+#include <atomic>
+#include <thread>
+
+TEST_TRAITS(SharedDeviceDirectoryTests, publish_TwoBuses,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	SharedDeviceDirectory shared;
+	shared.init(4, 10);
+	DeviceDirectory bus0;
+	DeviceDirectory bus1;
+	bus0.init(4, 5);
+	bus1.init(4, 5);
+	bus0.addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 0x4000, 1));
+	bus1.addDevice((byte*)"dev1", DeviceDirectoryRow(2, 0, 0x8000, 1));
+	bus1.addDevice((byte*)"dev2", DeviceDirectoryRow(3, 1, 0x8000, 1));
+
+	ASSERT_TRUE(shared.publish(0, bus0));
+	ASSERT_TRUE(shared.publish(1, bus1));
+
+	byte bus;
+	DeviceDirectoryRow device;
+	ASSERT_EQ(shared.getDeviceCount(), 3);
+	ASSERT_TRUE(shared.findDevice((byte*)"dev2", bus, device));
+	ASSERT_EQ(bus, 1);
+	ASSERT_EQ(device, DeviceDirectoryRow(3, 1, 0x8000, 1));
+	ASSERT_TRUE(shared.findDevice((byte*)"dev0", bus, device));
+	ASSERT_EQ(bus, 0);
+	ASSERT_FALSE(shared.findDevice((byte*)"dev3", bus, device));
+}
+
+TEST_TRAITS(SharedDeviceDirectoryTests, publish_ReplacesBusDevices,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	SharedDeviceDirectory shared;
+	shared.init(4, 10);
+	DeviceDirectory bus0;
+	DeviceDirectory bus1;
+	bus0.init(4, 5);
+	bus1.init(4, 5);
+	bus0.addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 0x4000, 1));
+	bus0.addDevice((byte*)"dev1", DeviceDirectoryRow(3, 0, 0x4000, 1));
+	bus1.addDevice((byte*)"dev2", DeviceDirectoryRow(2, 0, 0x8000, 1));
+	shared.publish(0, bus0);
+	shared.publish(1, bus1);
+
+	bus0.clearDeviceDirectoryRow(0);
+	ASSERT_TRUE(shared.publish(0, bus0));
+
+	byte bus;
+	DeviceDirectoryRow device;
+	byte name[4];
+	ASSERT_EQ(shared.getDeviceCount(), 2);
+	ASSERT_FALSE(shared.findDevice((byte*)"dev0", bus, device));
+	ASSERT_TRUE(shared.getDevice(0, bus, device, name));
+	ASSERT_EQ(bus, 1);
+	ASSERT_EQ(stringifyCharArray(4, (char*)name), "dev2");
+	ASSERT_TRUE(shared.getDevice(1, bus, device, name));
+	ASSERT_EQ(stringifyCharArray(4, (char*)name), "dev1");
+}
+
+TEST_TRAITS(SharedDeviceDirectoryTests, publish_Full,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	SharedDeviceDirectory shared;
+	shared.init(4, 1);
+	DeviceDirectory bus0;
+	bus0.init(4, 5);
+	bus0.addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 0x4000, 1));
+	bus0.addDevice((byte*)"dev1", DeviceDirectoryRow(3, 0, 0x4000, 1));
+
+	ASSERT_FALSE(shared.publish(0, bus0));
+	ASSERT_EQ(shared.getDeviceCount(), 1);
+}
+
+TEST_TRAITS(SharedDeviceDirectoryTests, acquireSnapshot_UnchangedByPublish,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	SharedDeviceDirectory shared;
+	shared.init(4, 10);
+	DeviceDirectory bus0;
+	bus0.init(4, 5);
+	bus0.addDevice((byte*)"dev0", DeviceDirectoryRow(2, 0, 0x4000, 1));
+	shared.publish(0, bus0);
+
+	auto snapshot = shared.acquireSnapshot();
+	bus0.addDevice((byte*)"dev1", DeviceDirectoryRow(3, 0, 0x4000, 1));
+	ASSERT_TRUE(shared.publish(0, bus0));
+
+	byte bus;
+	DeviceDirectoryRow device;
+	ASSERT_EQ(snapshot->numDevices, 1);
+	ASSERT_FALSE(snapshot->findDevice((byte*)"dev1", bus, device));
+	ASSERT_TRUE(shared.findDevice((byte*)"dev1", bus, device));
+	ASSERT_EQ(shared.getDeviceCount(), 2);
+	// The held snapshot can't be reused, so another is made
+	ASSERT_TRUE(shared.publish(0, bus0));
+	ASSERT_EQ(shared._numSnapshots, 3);
+	ASSERT_EQ(snapshot->numDevices, 1);
+
+	shared.releaseSnapshot(snapshot);
+	ASSERT_TRUE(shared.publish(0, bus0));
+	ASSERT_TRUE(shared.publish(0, bus0));
+	ASSERT_EQ(shared._numSnapshots, 3);
+}
+
+TEST_TRAITS(SharedDeviceDirectoryTests, acquireSnapshot_ReadersDuringPublish,
+	Type, Unit, Threading, Multi, Determinism, Dynamic, Case, Typical)
+{
+	SharedDeviceDirectory shared;
+	shared.init(4, 10);
+	std::atomic<bool> running(true);
+	std::atomic<int> torn(0);
+	std::atomic<int> reads(0);
+
+	// Every publish has n devices, all with n registers, so a snapshot that is changed while it is
+	// read shows up as a mismatch
+	auto reader = [&]()
+	{
+		while (running.load())
+		{
+			auto snapshot = shared.acquireSnapshot();
+			for (word i = 0; i < snapshot->numDevices; i++)
+			{
+				if (snapshot->devices[i].deviceRegs != snapshot->numDevices)
+					torn++;
+			}
+			shared.releaseSnapshot(snapshot);
+			reads++;
+		}
+	};
+	std::thread readers[3] = { std::thread(reader), std::thread(reader), std::thread(reader) };
+
+	for (int i = 0; i < 2000; i++)
+	{
+		word count = 1 + i % 5;
+		DeviceDirectory bus0;
+		bus0.init(4, 5);
+		for (word k = 0; k < count; k++)
+		{
+			byte name[4] = { 'd', 'e', 'v', (byte)('0' + k) };
+			bus0.addDevice(name, DeviceDirectoryRow(2 + k, 0, 0x4000, count));
+		}
+		ASSERT_TRUE(shared.publish(0, bus0));
+	}
+	running.store(false);
+	for (auto &thread : readers)
+	{
+		thread.join();
+	}
+
+	ASSERT_EQ(torn.load(), 0);
+	ASSERT_GT(reads.load(), 0);
+	ASSERT_LE(shared._numSnapshots, 5);
+}
@@ -2,11 +2,15 @@
 #include "fakeit.hpp"
 #include "../kwh-modbus/libraries/modbus/ModbusArray.h"
 #include "../kwh-modbus/libraries/slave/Slave.hpp"
+#include "../kwh-modbus/libraries/slave/StaticSlave.hpp"
+#include "../kwh-modbus/libraries/device/DataCollectorDevice.h"
 #include "../kwh-modbus/libraries/modbusSlave/ModbusSlave.hpp"
 #include "../kwh-modbus/mock/MockSerialStream.h"
 #include "WindowsSystemFunctions.h"
 #include "test_helpers.h"
 #include "PointerTracker.h"
+#include <stdlib.h>
+#include <new>
 
 using namespace fakeit;
 
@@ -16,6 +20,50 @@ typedef Slave<ModbusSlave<MockSerialStream, WindowsSystemFunctions, ModbusArray>
 #define MOCK_SLAVE Mock<T_SLAVE> mock(*slave); \
 T_SLAVE & mSlave = mock.get()
 
+// Counts heap allocations while enabled, to check that StaticSlave never allocates
+static bool countAllocations = false;
+static int allocationCount = 0;
+
+void *operator new(size_t size)
+{
+	if (countAllocations)
+		allocationCount++;
+	void *ptr = malloc(size == 0 ? 1 : size);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+// Sends two pages of 8 data points, packed delta encoded
+class TwoPageDevice : public Device
+{
+public:
+	word getType()
+	{
+		word type;
+		DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(true, TimeScale::sec15, 8, PageEncoding::packedDelta, type);
+		return type;
+	}
+
+	bool readData(uint32_t startTime, word numPoints, word page, byte *buffer, word bufferSize,
+		word maxPoints, word &outDataPointsCount, word &outPagesRemaining, byte &outDataPointSize)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			buffer[i] = (byte)(100 + page * 10 + i);
+		}
+		outDataPointsCount = 8;
+		outPagesRemaining = 1 - page;
+		outDataPointSize = 8;
+		return true;
+	}
+};
+
 class SlaveTests : public ::testing::Test
 {
 protected:
@@ -89,7 +137,7 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_Idle_Success,
 	ASSERT_TRUE(success);
 	ASSERT_EQ(slave->displayedStateInvalid, false);
 	ASSERT_EQ(registerArray[0], sIdle);
-	ASSERT_EQ(registerArray[1], 1 << 8);
+	ASSERT_EQ(registerArray[1], (1 << 8) + 1);
 	ASSERT_EQ(registerArray[2], 4);
 	ASSERT_EQ(registerArray[3], 703);
 }
@@ -167,9 +215,12 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_TimeNotSet,
 	// Request 16 data points
 	registerArray[5] = 16;
 
-	// Page 0, and no limit to how many data points we can process
+	// Page 0
 	registerArray[6] = 0;
 
+	// No limit to how many data points we can process
+	registerArray[7] = 0;
+
 	bool success = slave->setOutgoingState();
 
 	ASSERT_EQ(slave->displayedStateInvalid, false);
@@ -204,9 +255,12 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_DeviceDoesn
 	// Request 16 data points
 	registerArray[5] = 16;
 
-	// Page 0, and no limit to how many data points we can process
+	// Page 0
 	registerArray[6] = 0;
 
+	// No limit to how many data points we can process
+	registerArray[7] = 0;
+
 	bool success = slave->setOutgoingState();
 
 	ASSERT_EQ(slave->displayedStateInvalid, false);
@@ -223,14 +277,14 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_Success_4bi
 
 	uint32_t passedStartTime;
 	word passedNumPoints;
-	byte passedPage;
+	word passedPage;
 	word passedBufferSize;
-	byte passedMaxPoints;
+	word passedMaxPoints;
 
 	Device **devices = tracker.addArray(new Device*[1]);
 	SetupDevices(devices, 1);
-	When(Method(mockDevices[0], readData)).AlwaysDo([&](uint32_t startTime, word numPoints, byte page, byte * buffer, word bufferSize,
-		byte maxPoints, byte & outDataPointsCount, byte & outPagesRemaining, byte &outDataPointSize)
+	When(Method(mockDevices[0], readData)).AlwaysDo([&](uint32_t startTime, word numPoints, word page, byte * buffer, word bufferSize,
+		word maxPoints, word & outDataPointsCount, word & outPagesRemaining, byte &outDataPointSize)
 	{
 		passedStartTime = startTime;
 		passedNumPoints = numPoints;
@@ -264,9 +318,12 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_Success_4bi
 	// Request 16 data points
 	registerArray[5] = 16;
 
-	// Page 0, and no limit to how many data points we can process
+	// Page 0
 	registerArray[6] = 0;
 
+	// No limit to how many data points we can process
+	registerArray[7] = 0;
+
 	bool success = slave->setOutgoingState();
 
 	ASSERT_EQ(slave->displayedStateInvalid, false);
@@ -280,12 +337,344 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_Success_4bi
 		(word)0,
 		(word)179,
 		(word)1,
-		(word)0x0408,
-		(word)0x0100,
+		(word)8,
+		(word)0,
+		(word)1,
 		(word)0x3210,
 		(word)0x7654);
 }
 
+TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_Deferred,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	slave->_state = sDisplayDevData;
+	slave->displayedStateInvalid = true;
+
+	Device **devices = tracker.addArray(new Device*[1]);
+	SetupDevices(devices, 1);
+	When(Method(mockDevices[0], readData)).AlwaysDo([&](uint32_t startTime, word numPoints, word page, byte * buffer, word bufferSize,
+		word maxPoints, word & outDataPointsCount, word & outPagesRemaining, byte &outDataPointSize)
+	{
+		buffer[0] = 0x21;
+		outDataPointsCount = 2;
+		outPagesRemaining = 0;
+		outDataPointSize = 4;
+		return true;
+	});
+	byte **names = tracker.addArray(new byte*[1]);
+	names[0] = (byte*)"dev00";
+
+	slave->init(1, 5, 12, 10, devices, names);
+	ZeroRegisterArray();
+	ZeroDataBuffer();
+	slave->_clockSet = 1;
+
+	registerArray[2] = 0;
+	registerArray[3] = 179;
+	registerArray[4] = 1;
+	registerArray[5] = 2;
+	registerArray[6] = 0;
+	registerArray[7] = 0;
+
+	ASSERT_TRUE(slave->setOutgoingState(true));
+
+	// Only the state register is filled in until the rest is read
+	ASSERT_EQ(registerArray[0], sDisplayDevData);
+	ASSERT_EQ(registerArray[7], 0);
+	Verify(Method(mockDevices[0], readData)).Never();
+
+	ASSERT_TRUE(slave->provideRegisters(0, 1));
+	Verify(Method(mockDevices[0], readData)).Never();
+
+	ASSERT_TRUE(slave->provideRegisters(0, 8));
+	ASSERT_TRUE(slave->provideRegisters(0, 8));
+	Verify(Method(mockDevices[0], readData)).Once();
+	assertArrayEq(registerArray,
+		sDisplayDevData,
+		(word)0,
+		(word)179,
+		(word)1,
+		(word)2,
+		(word)0,
+		(word)0,
+		(word)0x21);
+}
+
+TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_NextPagePrefetched,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	slave->_state = sDisplayDevData;
+	slave->displayedStateInvalid = true;
+
+	word readPages[2];
+	int readCount = 0;
+	Device **devices = tracker.addArray(new Device*[1]);
+	SetupDevices(devices, 1);
+	When(Method(mockDevices[0], readData)).AlwaysDo([&](uint32_t startTime, word numPoints, word page, byte * buffer, word bufferSize,
+		word maxPoints, word & outDataPointsCount, word & outPagesRemaining, byte &outDataPointSize)
+	{
+		readPages[readCount++] = page;
+		buffer[0] = (byte)(0x10 + page);
+		outDataPointsCount = 1;
+		outPagesRemaining = 1 - page;
+		outDataPointSize = 8;
+		return true;
+	});
+	byte **names = tracker.addArray(new byte*[1]);
+	names[0] = (byte*)"dev00";
+
+	slave->init(1, 5, 12, 10, devices, names);
+	ZeroRegisterArray();
+	ZeroDataBuffer();
+	slave->_clockSet = 1;
+
+	auto requestPage = [&](word page)
+	{
+		registerArray[2] = 0;
+		registerArray[3] = 179;
+		registerArray[4] = 1;
+		registerArray[5] = 2;
+		registerArray[6] = page;
+		registerArray[7] = 1;
+		EXPECT_TRUE(slave->setOutgoingState());
+	};
+
+	requestPage(0);
+	Verify(Method(mockDevices[0], readData)).Once();
+	ASSERT_EQ(slave->_prefetch.state, slave->prefetchWanted);
+
+	slave->prefetchDataPage();
+	Verify(Method(mockDevices[0], readData)).Twice();
+	ASSERT_EQ(slave->_prefetch.state, slave->prefetchReady);
+
+	// The second page is served from the prefetch without reading the device again
+	requestPage(1);
+	Verify(Method(mockDevices[0], readData)).Twice();
+	ASSERT_EQ(readCount, 2);
+	ASSERT_EQ(readPages[0], 0);
+	ASSERT_EQ(readPages[1], 1);
+	ASSERT_EQ(slave->_prefetch.state, slave->prefetchNone);
+	assertArrayEq(registerArray,
+		sDisplayDevData,
+		(word)0,
+		(word)179,
+		(word)1,
+		(word)1,
+		(word)1,
+		(word)0,
+		(word)0x11);
+}
+
+TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_PrefetchMismatch,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	slave->_state = sDisplayDevData;
+	slave->displayedStateInvalid = true;
+
+	Device **devices = tracker.addArray(new Device*[1]);
+	SetupDevices(devices, 1);
+	When(Method(mockDevices[0], readData)).AlwaysDo([&](uint32_t startTime, word numPoints, word page, byte * buffer, word bufferSize,
+		word maxPoints, word & outDataPointsCount, word & outPagesRemaining, byte &outDataPointSize)
+	{
+		buffer[0] = (byte)startTime;
+		outDataPointsCount = 1;
+		outPagesRemaining = 1;
+		outDataPointSize = 8;
+		return true;
+	});
+	byte **names = tracker.addArray(new byte*[1]);
+	names[0] = (byte*)"dev00";
+
+	slave->init(1, 5, 12, 10, devices, names);
+	ZeroRegisterArray();
+	slave->_clockSet = 1;
+	slave->_prefetch.state = slave->prefetchWanted;
+	slave->_prefetch.deviceNum = 0;
+	slave->_prefetch.startTime = 65715;
+	slave->_prefetch.numDataPoints = 2;
+	slave->_prefetch.page = 1;
+	slave->_prefetch.maxPoints = 1;
+	slave->prefetchDataPage();
+
+	// Same request, but a different start time
+	registerArray[2] = 0;
+	registerArray[3] = 180;
+	registerArray[4] = 1;
+	registerArray[5] = 2;
+	registerArray[6] = 1;
+	registerArray[7] = 1;
+
+	ASSERT_TRUE(slave->setOutgoingState());
+	Verify(Method(mockDevices[0], readData)).Twice();
+	ASSERT_EQ(registerArray[7], 180);
+}
+
+TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_Success_PackedDelta,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	slave->_state = sDisplayDevData;
+	slave->displayedStateInvalid = true;
+
+	word devType;
+	DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(true, TimeScale::sec15, 8, PageEncoding::packedDelta, devType);
+	Device **devices = tracker.addArray(new Device*[1]);
+	SetupDevices(devices, 1);
+	When(Method(mockDevices[0], getType)).AlwaysReturn(devType);
+	When(Method(mockDevices[0], readData)).AlwaysDo([&](uint32_t startTime, word numPoints, word page, byte * buffer, word bufferSize,
+		word maxPoints, word & outDataPointsCount, word & outPagesRemaining, byte &outDataPointSize)
+	{
+		byte points[8] = { 100, 101, 101, 103, 104, 104, 105, 107 };
+		for (int i = 0; i < 8; i++)
+		{
+			buffer[i] = points[i];
+		}
+		outDataPointsCount = 8;
+		outPagesRemaining = 0;
+		outDataPointSize = 8;
+		return true;
+	});
+	byte **names = tracker.addArray(new byte*[1]);
+	names[0] = (byte*)"dev00";
+
+	slave->init(1, 5, 12, 10, devices, names);
+	ZeroRegisterArray();
+	ZeroDataBuffer();
+	slave->_clockSet = 1; // Time is no longer "never set"
+
+	registerArray[2] = 0;
+	registerArray[3] = 179;
+	registerArray[4] = 1;
+	registerArray[5] = 8;
+	registerArray[6] = 0;
+	registerArray[7] = 0;
+
+	bool success = slave->setOutgoingState();
+
+	// Width 3, first point 100, then zigzagged deltas 2, 0, 4, 2, 0, 2, 4
+	ASSERT_TRUE(success);
+	assertArrayEq(registerArray,
+		sDisplayDevData,
+		(word)0,
+		(word)179,
+		(word)1,
+		(word)8,
+		(word)0,
+		(word)0,
+		(word)(3 + ((word)PageEncoding::packedDelta << 12)),
+		(word)0x6403,
+		(word)0x0502,
+		(word)0x0011);
+}
+
+TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_Success_Deadband,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	slave->_state = sDisplayDevData;
+	slave->displayedStateInvalid = true;
+
+	word devType;
+	DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(false, TimeScale::sec15, 8, PageEncoding::deadband, devType);
+	Device **devices = tracker.addArray(new Device*[1]);
+	SetupDevices(devices, 1);
+	When(Method(mockDevices[0], getType)).AlwaysReturn(devType);
+	When(Method(mockDevices[0], getDeadband)).AlwaysReturn(1);
+	When(Method(mockDevices[0], readData)).AlwaysDo([&](uint32_t startTime, word numPoints, word page, byte * buffer, word bufferSize,
+		word maxPoints, word & outDataPointsCount, word & outPagesRemaining, byte &outDataPointSize)
+	{
+		byte points[8] = { 100, 100, 100, 101, 101, 140, 140, 140 };
+		for (int i = 0; i < 8; i++)
+		{
+			buffer[i] = points[i];
+		}
+		outDataPointsCount = 8;
+		outPagesRemaining = 0;
+		outDataPointSize = 8;
+		return true;
+	});
+	byte **names = tracker.addArray(new byte*[1]);
+	names[0] = (byte*)"dev00";
+
+	slave->init(1, 5, 12, 10, devices, names);
+	ZeroRegisterArray();
+	ZeroDataBuffer();
+	slave->_clockSet = 1; // Time is no longer "never set"
+
+	registerArray[2] = 0;
+	registerArray[3] = 179;
+	registerArray[4] = 1;
+	registerArray[5] = 8;
+	registerArray[6] = 0;
+	registerArray[7] = 0;
+
+	bool success = slave->setOutgoingState();
+
+	// Points 0 and 5 are carried, and the rest are within 1 of the last carried point
+	ASSERT_TRUE(success);
+	assertArrayEq(registerArray,
+		sDisplayDevData,
+		(word)0,
+		(word)179,
+		(word)1,
+		(word)8,
+		(word)0,
+		(word)0,
+		(word)(2 + ((word)PageEncoding::deadband << 12)),
+		(word)0x6421,
+		(word)0x008C);
+}
+
+TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_PackedDelta_FallsBackToRaw,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	slave->_state = sDisplayDevData;
+	slave->displayedStateInvalid = true;
+
+	word devType;
+	DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(false, TimeScale::sec15, 4, PageEncoding::packedDelta, devType);
+	Device **devices = tracker.addArray(new Device*[1]);
+	SetupDevices(devices, 1);
+	When(Method(mockDevices[0], getType)).AlwaysReturn(devType);
+	When(Method(mockDevices[0], readData)).AlwaysDo([&](uint32_t startTime, word numPoints, word page, byte * buffer, word bufferSize,
+		word maxPoints, word & outDataPointsCount, word & outPagesRemaining, byte &outDataPointSize)
+	{
+		buffer[0] = 0xF0;
+		buffer[1] = 0xF0;
+		outDataPointsCount = 4;
+		outPagesRemaining = 0;
+		outDataPointSize = 4;
+		return true;
+	});
+	byte **names = tracker.addArray(new byte*[1]);
+	names[0] = (byte*)"dev00";
+
+	slave->init(1, 5, 12, 10, devices, names);
+	ZeroRegisterArray();
+	ZeroDataBuffer();
+	slave->_clockSet = 1; // Time is no longer "never set"
+
+	registerArray[2] = 0;
+	registerArray[3] = 179;
+	registerArray[4] = 1;
+	registerArray[5] = 4;
+	registerArray[6] = 0;
+	registerArray[7] = 0;
+
+	bool success = slave->setOutgoingState();
+
+	// Alternating points make the deltas wider than the points themselves
+	ASSERT_TRUE(success);
+	assertArrayEq(registerArray,
+		sDisplayDevData,
+		(word)0,
+		(word)179,
+		(word)1,
+		(word)4,
+		(word)0,
+		(word)0,
+		(word)1,
+		(word)0xF0F0);
+}
+
 TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_Success_5bitData,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
@@ -294,14 +683,14 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_Success_5bi
 
 	uint32_t passedStartTime;
 	word passedNumPoints;
-	byte passedPage;
+	word passedPage;
 	word passedBufferSize;
-	byte passedMaxPoints;
+	word passedMaxPoints;
 
 	Device **devices = tracker.addArray(new Device*[1]);
 	SetupDevices(devices, 1);
-	When(Method(mockDevices[0], readData)).AlwaysDo([&](uint32_t startTime, word numPoints, byte page, byte * buffer, word bufferSize,
-		byte maxPoints, byte & outDataPointsCount, byte & outPagesRemaining, byte &outDataPointSize)
+	When(Method(mockDevices[0], readData)).AlwaysDo([&](uint32_t startTime, word numPoints, word page, byte * buffer, word bufferSize,
+		word maxPoints, word & outDataPointsCount, word & outPagesRemaining, byte &outDataPointSize)
 	{
 		passedStartTime = startTime;
 		passedNumPoints = numPoints;
@@ -335,9 +724,12 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_Success_5bi
 	// Request 16 data points
 	registerArray[5] = 16;
 
-	// Page 1, and no limit to how many data points we can process
+	// Page 1
 	registerArray[6] = 1;
 
+	// No limit to how many data points we can process
+	registerArray[7] = 0;
+
 	bool success = slave->setOutgoingState();
 
 	ASSERT_EQ(slave->displayedStateInvalid, false);
@@ -351,8 +743,9 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_DisplayDevData_Success_5bi
 		(word)0,
 		(word)179,
 		(word)1,
-		(word)0x0506,
-		(word)0x0201,
+		(word)6,
+		(word)1,
+		(word)2,
 		(word)0x8820,
 		(word)0x0A41);
 }
@@ -526,7 +919,7 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_PrepareWriteData,
 	string actualName;
 
 	When(Method(mDevice1, prepareReceiveData)).Do([&actualName, &prepareReceiveData](word nameLength, byte* name, uint32_t startTime,
-		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, byte &outDataPointsPerPage)
+		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, word &outDataPointsPerPage)
 	{
 		prepareReceiveData.get().method(nameLength, startTime, dataPointSize, dataTimeScale, dataPointsCount);
 		actualName = stringifyCharArray(nameLength, (char*)name);
@@ -566,7 +959,8 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_PrepareWriteData,
 	ASSERT_EQ(actualName, "Device0");
 	ASSERT_EQ(mSlave.displayedStateInvalid, true);
 	ASSERT_EQ(mSlave._state, sPreparingToReceiveDevData);
-	ASSERT_EQ(mSlave._stateDetail, 768);
+	ASSERT_EQ(mSlave._stateDetail, 0);
+	ASSERT_EQ(mSlave._receivePointsPerPage, 3);
 }
 
 TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_PrepareWriteData_nameTooLong,
@@ -582,7 +976,7 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_PrepareWriteData_nameT
 	deviceArray[1] = &mDevice1.get();
 
 	When(Method(mDevice1, prepareReceiveData)).Do([&prepareReceiveData](word nameLength, byte* name, uint32_t startTime,
-		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, byte &outDataPointsPerPage)
+		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, word &outDataPointsPerPage)
 	{
 		prepareReceiveData.get().method(nameLength, startTime, dataPointSize, dataTimeScale, dataPointsCount);
 		outDataPointsPerPage = 3;
@@ -636,7 +1030,7 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_PrepareWriteData_other
 	deviceArray[1] = &mDevice1.get();
 
 	When(Method(mDevice1, prepareReceiveData)).Do([&prepareReceiveData](word nameLength, byte* name, uint32_t startTime,
-		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, byte &outDataPointsPerPage)
+		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, word &outDataPointsPerPage)
 	{
 		prepareReceiveData.get().method(nameLength, startTime, dataPointSize, dataTimeScale, dataPointsCount);
 		return RecieveDataStatus::failure;
@@ -734,21 +1128,23 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_PrepareWriteData,
 {
 	slave->displayedStateInvalid = true;
 	slave->_state = sPreparingToReceiveDevData;
-	slave->_stateDetail = 703;
+	slave->_stateDetail = 4;
+	slave->_receivePointsPerPage = 703;
 	bool success = slave->setOutgoingState();
 
 	ASSERT_TRUE(success);
 	ASSERT_EQ(slave->displayedStateInvalid, false);
 	ASSERT_EQ(registerArray[0], sPreparingToReceiveDevData);
-	ASSERT_EQ(registerArray[1], 703);
+	ASSERT_EQ(registerArray[1], 4);
+	ASSERT_EQ(registerArray[2], 703);
 }
 
 TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_WriteData,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
 	MOCK_SLAVE;
-	MockNewMethod(mockReceiveData, byte dataPointsInPage, byte dataPointSize,
-		TimeScale timesScale, byte pageNumber);
+	MockNewMethod(mockReceiveData, word dataPointsInPage, byte dataPointSize,
+		TimeScale timesScale, word pageNumber);
 	Mock<Device> mDevice0;
 	Mock<Device> mDevice1;
 	Device **deviceArray = new Device*[2];
@@ -757,8 +1153,8 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_WriteData,
 	byte actualData[4];
 	actualData[3] = 0;
 
-	When(Method(mDevice1, receiveDeviceData)).Do([&actualData, &mockReceiveData](byte dataPointsInPage, byte dataPointSize,
-		TimeScale timeScale, byte pageNumber, byte* dataPoints)
+	When(Method(mDevice1, receiveDeviceData)).Do([&actualData, &mockReceiveData](word dataPointsInPage, byte dataPointSize,
+		TimeScale timeScale, word pageNumber, byte* dataPoints)
 	{
 		mockReceiveData.get().method(dataPointsInPage, dataPointSize, timeScale, pageNumber);
 		BitFunctions::copyBits(dataPoints, actualData, 0, 0, 30);
@@ -778,10 +1174,11 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_WriteData,
 	registerArray[0] = sReceivedRequest;
 	registerArray[1] = 5;
 	registerArray[2] = 1;
-	registerArray[3] = 6 + (word)(5 << 8);
-	registerArray[4] = (word)TimeScale::sec15 + (word)(2 << 8);
-	registerArray[5] = 0x25FE;
-	registerArray[6] = 0xE68C;
+	registerArray[3] = 6;
+	registerArray[4] = 5 + ((word)TimeScale::sec15 << 8);
+	registerArray[5] = 2;
+	registerArray[6] = 0x25FE;
+	registerArray[7] = 0xE68C;
 
 	bool processed;
 	bool success = mSlave.processIncomingState(processed);
@@ -798,12 +1195,64 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_WriteData,
 	ASSERT_EQ(mSlave.displayedStateInvalid, true);
 }
 
+TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_WriteData_PackedDelta,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	MOCK_SLAVE;
+	MockNewMethod(mockReceiveData, word dataPointsInPage, byte dataPointSize,
+		TimeScale timesScale, word pageNumber);
+	Mock<Device> mDevice0;
+	Mock<Device> mDevice1;
+	Device **deviceArray = new Device*[2];
+	deviceArray[0] = &mDevice0.get();
+	deviceArray[1] = &mDevice1.get();
+	byte actualData[8];
+
+	When(Method(mDevice1, receiveDeviceData)).Do([&actualData, &mockReceiveData](word dataPointsInPage, byte dataPointSize,
+		TimeScale timeScale, word pageNumber, byte* dataPoints)
+	{
+		mockReceiveData.get().method(dataPointsInPage, dataPointSize, timeScale, pageNumber);
+		for (int i = 0; i < 8; i++)
+			actualData[i] = dataPoints[i];
+		return RecieveDataStatus::success;
+	});
+
+	mSlave.displayedStateInvalid = false;
+
+	mSlave._state = sIdle;
+	mSlave._deviceCount = 2;
+	mSlave._deviceNameLength = 703;
+	mSlave._modbus->setSlaveId(14);
+	mSlave._devices = deviceArray;
+	mSlave._dataBuffer = new byte[15];
+	mSlave._dataBufferSize = 15;
+
+	registerArray[0] = sReceivedRequest;
+	registerArray[1] = 5;
+	registerArray[2] = 1;
+	registerArray[3] = 8;
+	registerArray[4] = 8 + ((word)PageEncoding::packedDelta << 6) + ((word)TimeScale::sec15 << 8);
+	registerArray[5] = 0;
+	registerArray[6] = 0x6403;
+	registerArray[7] = 0x0502;
+	registerArray[8] = 0x0011;
+
+	bool processed;
+	bool success = mSlave.processIncomingState(processed);
+
+	ASSERT_TRUE(processed);
+	ASSERT_TRUE(success);
+	Verify(Method(mockReceiveData, method).Using(8, 8, TimeScale::sec15, 0)).Once();
+	assertArrayEq<byte, byte, byte, byte, byte, byte, byte, byte>(actualData,
+		100, 101, 101, 103, 104, 104, 105, 107);
+}
+
 TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_WriteData_DataTooLong,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
 {
 	MOCK_SLAVE;
-	MockNewMethod(mockReceiveData, byte dataPointsInPage, byte dataPointSize,
-		TimeScale timesScale, byte pageNumber);
+	MockNewMethod(mockReceiveData, word dataPointsInPage, byte dataPointSize,
+		TimeScale timesScale, word pageNumber);
 	Mock<Device> mDevice0;
 	Mock<Device> mDevice1;
 	Device **deviceArray = new Device*[2];
@@ -812,8 +1261,8 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_WriteData_DataTooLong,
 	byte actualData[4];
 	actualData[3] = 0;
 
-	When(Method(mDevice1, receiveDeviceData)).Do([&actualData, &mockReceiveData](byte dataPointsInPage, byte dataPointSize,
-		TimeScale timeScale, byte pageNumber, byte* dataPoints)
+	When(Method(mDevice1, receiveDeviceData)).Do([&actualData, &mockReceiveData](word dataPointsInPage, byte dataPointSize,
+		TimeScale timeScale, word pageNumber, byte* dataPoints)
 	{
 		mockReceiveData.get().method(dataPointsInPage, dataPointSize, timeScale, pageNumber);
 		BitFunctions::copyBits(dataPoints, actualData, 0, 0, 30);
@@ -833,10 +1282,11 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_WriteData_DataTooLong,
 	registerArray[0] = sReceivedRequest;
 	registerArray[1] = 5;
 	registerArray[2] = 1;
-	registerArray[3] = 99 + (word)(5 << 8);
-	registerArray[4] = (word)TimeScale::sec15 + (word)(2 << 8);
-	registerArray[5] = 0x25FE;
-	registerArray[6] = 0xE68C;
+	registerArray[3] = 99;
+	registerArray[4] = 5 + ((word)TimeScale::sec15 << 8);
+	registerArray[5] = 2;
+	registerArray[6] = 0x25FE;
+	registerArray[7] = 0xE68C;
 
 	bool processed;
 	bool success = mSlave.processIncomingState(processed);
@@ -848,6 +1298,285 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_WriteData_DataTooLong,
 	ASSERT_EQ(mSlave.displayedStateInvalid, false);
 }
 
+TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_BroadcastPrepareWriteData,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	MOCK_SLAVE;
+	MockNewMethod(prepareReceiveData, word nameLength, uint32_t startTime,
+		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, byte proposedDataPointsPerPage);
+	Mock<Device> mDevice0;
+	Mock<Device> mDevice1;
+	Mock<Device> mDevice2;
+	Device **deviceArray = new Device*[3];
+	deviceArray[0] = &mDevice0.get();
+	deviceArray[1] = &mDevice1.get();
+	deviceArray[2] = &mDevice2.get();
+	string actualName;
+
+	When(Method(mDevice0, getType)).AlwaysReturn(7);
+	When(Method(mDevice1, getType)).AlwaysReturn(2 << 14);
+	When(Method(mDevice2, getType)).AlwaysReturn(2 << 14);
+	When(Method(mDevice1, prepareReceiveData)).Do([&actualName, &prepareReceiveData](word nameLength, byte* name, uint32_t startTime,
+		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, word &outDataPointsPerPage)
+	{
+		prepareReceiveData.get().method(nameLength, startTime, dataPointSize, dataTimeScale, dataPointsCount, outDataPointsPerPage);
+		actualName = stringifyCharArray(nameLength, (char*)name);
+		outDataPointsPerPage = 4;
+		return RecieveDataStatus::success;
+	});
+	When(Method(mDevice2, prepareReceiveData)).Do([](word nameLength, byte* name, uint32_t startTime,
+		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, word &outDataPointsPerPage)
+	{
+		// Doesn't split a broadcast page evenly
+		outDataPointsPerPage = 3;
+		return RecieveDataStatus::success;
+	});
+
+	mSlave.displayedStateInvalid = false;
+
+	mSlave._state = sIdle;
+	mSlave._deviceCount = 3;
+	mSlave._deviceNameLength = 7;
+	mSlave._modbus->setSlaveId(14);
+	mSlave._devices = deviceArray;
+	mSlave._broadcastDevicePageSizes = new word[3];
+	mSlave._dataBuffer = new byte[15];
+	mSlave._dataBufferSize = 15;
+	mSlave.TimeManager::setClock(1000);
+
+	registerArray[0] = sReceivedRequest;
+	registerArray[1] = 32772;
+	registerArray[2] = 9;
+	registerArray[3] = 7;
+	registerArray[4] = 50;
+	registerArray[5] = 4;
+	registerArray[6] = 7 + ((word)TimeScale::sec15 << 8);
+	registerArray[7] = 15;
+	registerArray[8] = 8;
+	registerArray[9] = (word)'D' + ((word)'e' << 8);
+	registerArray[10] = (word)'v' + ((word)'i' << 8);
+	registerArray[11] = (word)'c' + ((word)'e' << 8);
+	registerArray[12] = (word)'0';
+
+	bool processed;
+	bool success = mSlave.processIncomingState(processed);
+
+	ASSERT_TRUE(processed);
+	ASSERT_TRUE(success);
+	Verify(Method(prepareReceiveData, method).Using(7, 262194, 7, TimeScale::sec15, 15, 8)).Once();
+	Verify(Method(mDevice0, prepareReceiveData)).Never();
+	ASSERT_EQ(actualName, "Device0");
+	ASSERT_EQ(mSlave.displayedStateInvalid, true);
+	ASSERT_EQ(mSlave._state, sBroadcastReceipt);
+	ASSERT_EQ(mSlave._broadcastTransferId, 9);
+	ASSERT_EQ(mSlave._broadcastAcceptedDevices, 2);
+	ASSERT_EQ(mSlave._broadcastReceivedPages, 0);
+	ASSERT_EQ(mSlave._broadcastDevicePageSizes[1], 4);
+}
+
+TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_BroadcastPrepareWriteData_PageTooLarge,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	MOCK_SLAVE;
+	Mock<Device> mDevice0;
+	Device **deviceArray = new Device*[1];
+	deviceArray[0] = &mDevice0.get();
+	When(Method(mDevice0, getType)).AlwaysReturn(2 << 14);
+
+	mSlave.displayedStateInvalid = false;
+
+	mSlave._state = sIdle;
+	mSlave._deviceCount = 1;
+	mSlave._deviceNameLength = 7;
+	mSlave._devices = deviceArray;
+	mSlave._broadcastDevicePageSizes = new word[1];
+	mSlave._dataBuffer = new byte[15];
+	mSlave._dataBufferSize = 15;
+	mSlave.TimeManager::setClock(1000);
+
+	registerArray[0] = sReceivedRequest;
+	registerArray[1] = 32772;
+	registerArray[2] = 9;
+	registerArray[3] = 7;
+	registerArray[4] = 50;
+	registerArray[5] = 4;
+	registerArray[6] = 7 + ((word)TimeScale::sec15 << 8);
+	registerArray[7] = 60;
+	// 280 bits a page, and the buffer only holds 120
+	registerArray[8] = 40;
+
+	bool processed;
+	bool success = mSlave.processIncomingState(processed);
+
+	// Rejected, so the master sends to the device on its own
+	ASSERT_TRUE(processed);
+	ASSERT_TRUE(success);
+	Verify(Method(mDevice0, prepareReceiveData)).Never();
+	ASSERT_EQ(mSlave._broadcastAcceptedDevices, 0);
+	ASSERT_EQ(mSlave._state, sIdle);
+}
+
+TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_BroadcastWriteData_SplitPage,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	MOCK_SLAVE;
+	MockNewMethod(mockReceiveData, word dataPointsInPage, byte dataPointSize,
+		TimeScale timesScale, word pageNumber, word data);
+	Mock<Device> mDevice0;
+	Mock<Device> mDevice1;
+	Device **deviceArray = new Device*[2];
+	deviceArray[0] = &mDevice0.get();
+	deviceArray[1] = &mDevice1.get();
+
+	auto receiveData = [&mockReceiveData](word dataPointsInPage, byte dataPointSize,
+		TimeScale timeScale, word pageNumber, byte* dataPoints)
+	{
+		word data = 0;
+		BitFunctions::copyBits(dataPoints, &data, 0, 0, dataPointsInPage * dataPointSize);
+		// A device that scribbles on its copy doesn't affect the others
+		dataPoints[0] = 0xFF;
+		mockReceiveData.get().method(dataPointsInPage, dataPointSize, timeScale, pageNumber, data);
+		return RecieveDataStatus::success;
+	};
+	When(Method(mDevice0, receiveDeviceData)).AlwaysDo(receiveData);
+	When(Method(mDevice1, receiveDeviceData)).AlwaysDo(receiveData);
+
+	mSlave.displayedStateInvalid = false;
+
+	mSlave._state = sBroadcastReceipt;
+	mSlave._deviceCount = 2;
+	mSlave._deviceNameLength = 7;
+	mSlave._modbus->setSlaveId(14);
+	mSlave._devices = deviceArray;
+	mSlave._broadcastDevicePageSizes = new word[2] { 8, 4 };
+	mSlave._dataBuffer = new byte[15];
+	mSlave._dataBufferSize = 15;
+	mSlave._broadcastTransferId = 9;
+	mSlave._broadcastPointsPerPage = 8;
+	mSlave._broadcastAcceptedDevices = 3;
+	mSlave._broadcastReceivedPages = 1;
+
+	registerArray[0] = sReceivedRequest;
+	registerArray[1] = 32773;
+	registerArray[2] = 9;
+	registerArray[3] = 6;
+	registerArray[4] = 2 + ((word)TimeScale::sec15 << 8);
+	registerArray[5] = 1;
+	registerArray[6] = 0x0E4B;
+
+	bool processed;
+	bool success = mSlave.processIncomingState(processed);
+
+	ASSERT_TRUE(processed);
+	ASSERT_TRUE(success);
+	ASSERT_EQ(mSlave._state, sBroadcastReceipt);
+	Verify(Method(mockReceiveData, method).Using(6, 2, TimeScale::sec15, 1, 0xE4B) +
+		Method(mockReceiveData, method).Using(4, 2, TimeScale::sec15, 2, 0x4B) +
+		Method(mockReceiveData, method).Using(2, 2, TimeScale::sec15, 3, 0xE)).Once();
+	ASSERT_EQ(mSlave._broadcastReceivedPages, 3);
+	ASSERT_EQ(mSlave.displayedStateInvalid, true);
+}
+
+TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_BroadcastWriteData_WrongTransfer,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	MOCK_SLAVE;
+	Mock<Device> mDevice0;
+	Device **deviceArray = new Device*[1];
+	deviceArray[0] = &mDevice0.get();
+
+	mSlave.displayedStateInvalid = false;
+
+	mSlave._state = sIdle;
+	mSlave._deviceCount = 1;
+	mSlave._deviceNameLength = 7;
+	mSlave._devices = deviceArray;
+	mSlave._broadcastDevicePageSizes = new word[1] { 8 };
+	mSlave._dataBuffer = new byte[15];
+	mSlave._dataBufferSize = 15;
+	mSlave._broadcastTransferId = 8;
+	mSlave._broadcastPointsPerPage = 8;
+	mSlave._broadcastAcceptedDevices = 1;
+	mSlave._broadcastReceivedPages = 0;
+
+	registerArray[0] = sReceivedRequest;
+	registerArray[1] = 32773;
+	registerArray[2] = 9;
+	registerArray[3] = 6;
+	registerArray[4] = 2 + ((word)TimeScale::sec15 << 8);
+	registerArray[5] = 0;
+	registerArray[6] = 0x0E4B;
+
+	bool processed;
+	bool success = mSlave.processIncomingState(processed);
+
+	ASSERT_TRUE(processed);
+	ASSERT_TRUE(success);
+	Verify(Method(mDevice0, receiveDeviceData)).Never();
+	ASSERT_EQ(mSlave._broadcastReceivedPages, 0);
+	// Not part of this transfer, so it goes back to displaying what it was before
+	ASSERT_EQ(mSlave._state, sIdle);
+	ASSERT_EQ(mSlave.displayedStateInvalid, true);
+}
+
+TEST_F_TRAITS(SlaveTests, SlaveTests_processIncomingState_BroadcastPrepareWriteData_NoneAccepted,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	MOCK_SLAVE;
+	Mock<Device> mDevice0;
+	Device **deviceArray = new Device*[1];
+	deviceArray[0] = &mDevice0.get();
+	When(Method(mDevice0, getType)).AlwaysReturn(7);
+
+	mSlave.displayedStateInvalid = false;
+
+	mSlave._state = sIdle;
+	mSlave._deviceCount = 1;
+	mSlave._deviceNameLength = 7;
+	mSlave._devices = deviceArray;
+	mSlave._broadcastDevicePageSizes = new word[1];
+	mSlave._dataBuffer = new byte[15];
+	mSlave._dataBufferSize = 15;
+	mSlave.TimeManager::setClock(1000);
+
+	registerArray[0] = sReceivedRequest;
+	registerArray[1] = 32772;
+	registerArray[2] = 9;
+	registerArray[3] = 7;
+	registerArray[4] = 50;
+	registerArray[5] = 4;
+	registerArray[6] = 7 + ((word)TimeScale::sec15 << 8);
+	registerArray[7] = 15;
+	registerArray[8] = 8;
+
+	bool processed;
+	bool success = mSlave.processIncomingState(processed);
+
+	// Only has a collector, so it stays idle for the master to discover
+	ASSERT_TRUE(processed);
+	ASSERT_TRUE(success);
+	Verify(Method(mDevice0, prepareReceiveData)).Never();
+	ASSERT_EQ(mSlave._state, sIdle);
+	ASSERT_EQ(mSlave._broadcastAcceptedDevices, 0);
+	ASSERT_EQ(mSlave.displayedStateInvalid, true);
+}
+
+TEST_F_TRAITS(SlaveTests, SlaveTests_setOutgoingState_BroadcastReceipt,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	slave->displayedStateInvalid = true;
+	slave->_state = sBroadcastReceipt;
+	slave->_broadcastTransferId = 703;
+	slave->_broadcastAcceptedDevices = 0x00050002;
+	slave->_broadcastReceivedPages = 0x8000000F;
+	bool success = slave->setOutgoingState();
+
+	ASSERT_TRUE(success);
+	ASSERT_EQ(slave->displayedStateInvalid, false);
+	assertArrayEq<word, word, word, word, word, word>(registerArray,
+		sBroadcastReceipt, 703, 0x0002, 0x0005, 0x000F, 0x8000);
+}
+
 TEST_F_TRAITS(SlaveTests, SlaveTests_init,
 	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
 {
@@ -905,4 +1634,42 @@ TEST_F_TRAITS(SlaveTests, SlaveTests_clearDevices,
 	ASSERT_EQ(slave->getDeviceNameLength(), 5); // Clearing doesn't change name length
 	ASSERT_EQ(slave->_devices, nullptr);
 	ASSERT_EQ(slave->_deviceNames, nullptr);
-}
\ No newline at end of file
+}
+TEST_TRAITS(StaticSlaveTests, StaticSlave_NoHeapAllocations,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	typedef StaticSlave<T_MODBUS, WindowsSystemFunctions, 2, 5, 10> T_STATIC_SLAVE;
+	static_assert(sizeof(T_STATIC_SLAVE) >= sizeof(T_SLAVE) + 3 * 10 + 2 * 5,
+		"StaticSlave should hold its buffers and names");
+
+	word registers[20];
+	T_MODBUS modbus;
+	modbus.init(registers, 0, 20, 20);
+	WindowsSystemFunctions system;
+	TwoPageDevice device0, device1;
+	Device *devices[2] = { &device0, &device1 };
+	byte *names[2] = { (byte*)"dev00", (byte*)"dev01" };
+	T_STATIC_SLAVE slave;
+	slave.config(&system, &modbus);
+
+	allocationCount = 0;
+	countAllocations = true;
+	bool success = slave.init(2, 20, devices, names);
+	slave._clockSet = 1;
+	slave._state = sDisplayDevData;
+	for (word page = 0; page < 2; page++)
+	{
+		setArray(registers + 2, (word)1, (word)179, (word)1, (word)16, page, (word)0);
+		success &= slave.setOutgoingState();
+		slave.prefetchDataPage();
+	}
+	slave.clearDevices();
+	countAllocations = false;
+
+	ASSERT_TRUE(success);
+	ASSERT_EQ(allocationCount, 0);
+	// Second page, all deltas are 1
+	ASSERT_EQ(registers[5], 1);
+	ASSERT_EQ(registers[8], (word)(110 << 8) + 2);
+	ASSERT_FALSE(slave.init(3, 20, devices, names));
+}
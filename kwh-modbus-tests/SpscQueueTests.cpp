@@ -0,0 +1,130 @@
+#include "pch.h"
+#include "../kwh-modbus/libraries/spscQueue/SpscQueue.hpp"
+#include "test_helpers.h"
+#include "../kwh-modbus/noArduino/ArduinoMacros.h"
+
+#include <thread>
+
+TEST_TRAITS(SpscQueueTests, pushPop_InOrder,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	SpscQueue queue;
+	queue.init(2, 4);
+
+	for (byte i = 0; i < 2; i++)
+	{
+		byte *slot = queue.beginPush();
+		slot[0] = i;
+		slot[1] = i + 10;
+		queue.endPush();
+	}
+
+	ASSERT_EQ(queue.getCount(), 2);
+	ASSERT_EQ(queue.front()[1], 10);
+	queue.pop();
+	ASSERT_EQ(queue.front()[0], 1);
+	queue.pop();
+	ASSERT_EQ(queue.front(), nullptr);
+}
+
+TEST_TRAITS(SpscQueueTests, beginPush_Full,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	SpscQueue queue;
+	queue.init(1, 2);
+
+	queue.beginPush()[0] = 1;
+	queue.endPush();
+	queue.beginPush()[0] = 2;
+	queue.endPush();
+
+	ASSERT_EQ(queue.beginPush(), nullptr);
+	queue.pop();
+	ASSERT_NE(queue.beginPush(), nullptr);
+}
+
+TEST_TRAITS(SpscQueueTests, pushPop_Wraparound,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	SpscQueue queue;
+	queue.init(1, 2);
+
+	for (byte i = 0; i < 5; i++)
+	{
+		queue.beginPush()[0] = i;
+		queue.endPush();
+		ASSERT_EQ(queue.front()[0], i);
+		queue.pop();
+	}
+	ASSERT_EQ(queue.getCount(), 0);
+}
+
+TEST_TRAITS(SpscQueueTests, pushPop_PositionWrapsPast32Bits,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	SpscQueue queue;
+	queue.init(1, 4);
+	queue._head.store(0xFFFFFFFE);
+	queue._tail.store(0xFFFFFFFE);
+
+	for (byte i = 0; i < 4; i++)
+	{
+		queue.beginPush()[0] = i;
+		queue.endPush();
+	}
+	ASSERT_EQ(queue.beginPush(), nullptr);
+	ASSERT_EQ(queue.getCount(), 4);
+	for (byte i = 0; i < 4; i++)
+	{
+		ASSERT_EQ(queue.front()[0], i);
+		queue.pop();
+	}
+	ASSERT_EQ(queue.front(), nullptr);
+}
+
+TEST_TRAITS(SpscQueueTests, init_Failure_NotPowerOfTwo,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	SpscQueue queue;
+
+	ASSERT_FALSE(queue.init(1, 3));
+	ASSERT_FALSE(queue.init(1, 0));
+	ASSERT_TRUE(queue.init(1, 1));
+}
+
+TEST_TRAITS(SpscQueueTests, pushPop_TwoThreads,
+	Type, Unit, Threading, Multi, Determinism, Dynamic, Case, Typical)
+{
+	SpscQueue queue;
+	queue.init(4, 8);
+	const uint32_t count = 100000;
+
+	std::thread producer([&queue, count]()
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			byte *slot;
+			while ((slot = queue.beginPush()) == nullptr)
+				std::this_thread::yield();
+			memcpy(slot, &i, 4);
+			queue.endPush();
+		}
+	});
+
+	bool inOrder = true;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		byte *slot;
+		while ((slot = queue.front()) == nullptr)
+			std::this_thread::yield();
+		uint32_t value;
+		memcpy(&value, slot, 4);
+		if (value != i)
+			inOrder = false;
+		queue.pop();
+	}
+	producer.join();
+
+	ASSERT_TRUE(inOrder);
+	ASSERT_EQ(queue.getCount(), 0);
+}
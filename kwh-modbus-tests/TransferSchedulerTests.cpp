@@ -0,0 +1,149 @@
+#include "pch.h"
+#include "../kwh-modbus/libraries/transferScheduler/TransferScheduler.hpp"
+#include "test_helpers.h"
+#include "../kwh-modbus/noArduino/ArduinoMacros.h"
+
+TEST_TRAITS(TransferSchedulerTests, schedule_OrdersByDeadline,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	TransferScheduler scheduler;
+	TransferDeadline earliest;
+
+	ASSERT_TRUE(scheduler.schedule(TimeScale::hr1, 300, 3600));
+	ASSERT_TRUE(scheduler.schedule(TimeScale::sec1, 104, 4));
+	ASSERT_TRUE(scheduler.schedule(TimeScale::min1, 160, 60));
+
+	ASSERT_EQ(scheduler.getCount(), 3);
+	ASSERT_TRUE(scheduler.peek(earliest));
+	ASSERT_EQ(earliest.timeScale, TimeScale::sec1);
+	ASSERT_EQ(earliest.deadline, 104);
+	ASSERT_EQ(earliest.period, 4);
+}
+
+TEST_TRAITS(TransferSchedulerTests, schedule_ReplacesExistingTimeScale,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	TransferScheduler scheduler;
+	TransferDeadline earliest;
+
+	scheduler.schedule(TimeScale::sec1, 104, 4);
+	scheduler.schedule(TimeScale::min1, 160, 60);
+	scheduler.schedule(TimeScale::sec1, 200, 4);
+
+	ASSERT_EQ(scheduler.getCount(), 2);
+	ASSERT_TRUE(scheduler.peek(earliest));
+	ASSERT_EQ(earliest.timeScale, TimeScale::min1);
+}
+
+TEST_TRAITS(TransferSchedulerTests, schedule_Failure_BadArguments,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Failure)
+{
+	TransferScheduler scheduler;
+
+	ASSERT_FALSE(scheduler.schedule((TimeScale)8, 100, 4));
+	ASSERT_FALSE(scheduler.schedule(TimeScale::sec1, 100, 0));
+	ASSERT_TRUE(scheduler.isEmpty());
+}
+
+TEST_TRAITS(TransferSchedulerTests, popDue_NothingDue,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	TransferScheduler scheduler;
+	TimeScale timeScale;
+
+	ASSERT_FALSE(scheduler.popDue(100, timeScale));
+	scheduler.schedule(TimeScale::sec1, 104, 4);
+	ASSERT_FALSE(scheduler.popDue(103, timeScale));
+}
+
+TEST_TRAITS(TransferSchedulerTests, popDue_AdvancesByPeriod,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	TransferScheduler scheduler;
+	TransferDeadline earliest;
+	TimeScale timeScale;
+	scheduler.schedule(TimeScale::sec1, 104, 4);
+	scheduler.schedule(TimeScale::min1, 105, 60);
+
+	ASSERT_TRUE(scheduler.popDue(105, timeScale));
+	ASSERT_EQ(timeScale, TimeScale::sec1);
+	ASSERT_EQ(scheduler.getLastLateness(TimeScale::sec1), 1);
+	ASSERT_TRUE(scheduler.popDue(106, timeScale));
+	ASSERT_EQ(timeScale, TimeScale::min1);
+	ASSERT_EQ(scheduler.getLastLateness(TimeScale::min1), 1);
+	ASSERT_FALSE(scheduler.popDue(106, timeScale));
+
+	// The next deadline keeps its phase, regardless of lateness
+	ASSERT_TRUE(scheduler.peek(earliest));
+	ASSERT_EQ(earliest.timeScale, TimeScale::sec1);
+	ASSERT_EQ(earliest.deadline, 108);
+	ASSERT_TRUE(scheduler.popDue(108, timeScale));
+	ASSERT_EQ(scheduler.getLastLateness(TimeScale::sec1), 0);
+	ASSERT_EQ(scheduler.getMaxLateness(TimeScale::sec1), 1);
+}
+
+TEST_TRAITS(TransferSchedulerTests, popDue_SameDeadline_ShorterTimeScaleFirst,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	TransferScheduler scheduler;
+	TimeScale timeScale;
+	scheduler.schedule(TimeScale::hr24, 100, 86400);
+	scheduler.schedule(TimeScale::min10, 100, 600);
+	scheduler.schedule(TimeScale::sec1, 100, 4);
+
+	ASSERT_TRUE(scheduler.popDue(100, timeScale));
+	ASSERT_EQ(timeScale, TimeScale::sec1);
+	ASSERT_TRUE(scheduler.popDue(100, timeScale));
+	ASSERT_EQ(timeScale, TimeScale::min10);
+	ASSERT_TRUE(scheduler.popDue(100, timeScale));
+	ASSERT_EQ(timeScale, TimeScale::hr24);
+	ASSERT_FALSE(scheduler.popDue(100, timeScale));
+}
+
+TEST_TRAITS(TransferSchedulerTests, popDue_SkipsMissedDeadlines,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	TransferScheduler scheduler;
+	TransferDeadline earliest;
+	TimeScale timeScale;
+	scheduler.schedule(TimeScale::sec1, 104, 4);
+
+	ASSERT_TRUE(scheduler.popDue(117, timeScale));
+	ASSERT_EQ(scheduler.getLastLateness(TimeScale::sec1), 13);
+	ASSERT_EQ(scheduler.getMissedDeadlines(TimeScale::sec1), 3);
+	ASSERT_FALSE(scheduler.popDue(117, timeScale));
+	ASSERT_TRUE(scheduler.peek(earliest));
+	ASSERT_EQ(earliest.deadline, 120);
+}
+
+TEST_TRAITS(TransferSchedulerTests, popDue_ClockWraparound,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Edge)
+{
+	TransferScheduler scheduler;
+	TransferDeadline earliest;
+	TimeScale timeScale;
+	scheduler.schedule(TimeScale::sec1, 0xFFFFFFFE, 4);
+	scheduler.schedule(TimeScale::min1, 10, 60);
+
+	ASSERT_TRUE(scheduler.popDue(0xFFFFFFFF, timeScale));
+	ASSERT_EQ(timeScale, TimeScale::sec1);
+	ASSERT_TRUE(scheduler.peek(earliest));
+	ASSERT_EQ(earliest.timeScale, TimeScale::sec1);
+	ASSERT_EQ(earliest.deadline, 2);
+}
+
+TEST_TRAITS(TransferSchedulerTests, clear_ResetsScheduleAndLateness,
+	Type, Unit, Threading, Single, Determinism, Static, Case, Typical)
+{
+	TransferScheduler scheduler;
+	TimeScale timeScale;
+	scheduler.schedule(TimeScale::sec1, 104, 4);
+	scheduler.popDue(110, timeScale);
+
+	scheduler.clear();
+
+	ASSERT_TRUE(scheduler.isEmpty());
+	ASSERT_EQ(scheduler.getLastLateness(TimeScale::sec1), 0);
+	ASSERT_EQ(scheduler.getMaxLateness(TimeScale::sec1), 0);
+	ASSERT_EQ(scheduler.getMissedDeadlines(TimeScale::sec1), 0);
+}
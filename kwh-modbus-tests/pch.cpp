@@ -10,5 +10,7 @@
 #include "../kwh-modbus/noArduino/ModbusMemory.cpp"
 #include "../kwh-modbus/mock/MockSerialStream.cpp"
 #include "../kwh-modbus/libraries/timeManager/TimeManager.cpp"
+#include "../kwh-modbus/libraries/device/BufferedDataCollectorDevice.cpp"
 #include "../kwh-modbus/libraries/device/DataCollectorDevice.cpp"
-#include "../kwh-modbus/libraries/device/Device.cpp"
\ No newline at end of file
+#include "../kwh-modbus/libraries/device/Device.cpp"
+#include "../kwh-modbus/libraries/device/RollupDataCollectorDevice.cpp"
\ No newline at end of file
@@ -102,7 +102,7 @@ class DestinationDevice : public Device
   }
 
   RecieveDataStatus prepareReceiveData(word nameLength, byte* name, uint32_t startTime,
-   byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, byte &outDataPointsPerPage)
+   byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, word &outDataPointsPerPage)
    {
     Serial.println();
     Serial.println();
@@ -119,8 +119,8 @@ class DestinationDevice : public Device
     return RecieveDataStatus::success;
    }
    
-   RecieveDataStatus receiveDeviceData(byte dataPointsInPage, byte dataPointSize,
-   TimeScale timesScale, byte pageNumber, byte* dataPoints)
+   RecieveDataStatus receiveDeviceData(word dataPointsInPage, byte dataPointSize,
+   TimeScale timesScale, word pageNumber, byte* dataPoints)
    {
     byte timePeriod = 1;
     if (timesScale == TimeScale::ms250)
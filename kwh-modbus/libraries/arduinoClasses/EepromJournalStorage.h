@@ -0,0 +1,47 @@
+#pragma once
+#ifndef NO_ARDUINO
+#include <EEPROM.h>
+#include "../deviceDirectoryJournal/DeviceDirectoryJournal.hpp"
+
+// Journal storage in a region of the AVR's EEPROM. Cells whose value doesn't change aren't written.
+class EepromJournalStorage : public JournalStorage
+{
+private:
+	uint32_t _start;
+	uint32_t _size;
+
+public:
+	EepromJournalStorage(uint32_t start, uint32_t size)
+	{
+		_start = start;
+		_size = size;
+	}
+
+	uint32_t getSize()
+	{
+		return _size;
+	}
+
+	bool read(uint32_t address, byte *data, word length)
+	{
+		if (address + length > _size)
+			return false;
+		for (word i = 0; i < length; i++)
+		{
+			data[i] = EEPROM.read(_start + address + i);
+		}
+		return true;
+	}
+
+	bool write(uint32_t address, byte *data, word length)
+	{
+		if (address + length > _size)
+			return false;
+		for (word i = 0; i < length; i++)
+		{
+			EEPROM.update(_start + address + i, data[i]);
+		}
+		return true;
+	}
+};
+#endif
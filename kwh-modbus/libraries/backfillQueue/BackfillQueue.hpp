@@ -0,0 +1,162 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+#include "../timeManager/TimeManager.h"
+
+struct BackfillRange
+{
+	byte slaveId = 0;
+	word deviceNumber = 0;
+	TimeScale timeScale = (TimeScale)0;
+	uint32_t startTime = 0;
+	uint32_t endTime = 0;
+};
+
+// Ranges of data that were skipped because too much was pending at once, kept per device and
+// timescale so they can be read later when the bus is idle. Ranges are served in chunks, round
+// robin, so one device with a long outage doesn't hold up the rest. When full, the oldest range is dropped.
+class BackfillQueue
+{
+private_testable:
+	BackfillRange *_ranges = nullptr;
+	byte _capacity = 0;
+	byte _count = 0;
+	uint32_t _droppedRanges = 0;
+
+	void removeAt(byte index)
+	{
+		for (byte i = index; i + 1 < _count; i++)
+		{
+			_ranges[i] = _ranges[i + 1];
+		}
+		_count--;
+	}
+
+	static bool isSameDevice(const BackfillRange &range, byte slaveId, word deviceNumber)
+	{
+		return range.slaveId == slaveId && range.deviceNumber == deviceNumber;
+	}
+
+public:
+	bool init(byte capacity)
+	{
+		clear();
+		if (capacity == 0)
+			return false;
+		_capacity = capacity;
+		_ranges = new BackfillRange[_capacity];
+		return true;
+	}
+
+	void clear()
+	{
+		if (_ranges != nullptr)
+		{
+			delete[] _ranges;
+			_ranges = nullptr;
+		}
+		_capacity = 0;
+		_count = 0;
+		_droppedRanges = 0;
+	}
+
+	// Adds a range of time, merging it with a range for the same device and timescale that it touches
+	bool push(byte slaveId, word deviceNumber, TimeScale timeScale, uint32_t startTime, uint32_t endTime)
+	{
+		if (_ranges == nullptr || endTime <= startTime)
+			return false;
+		for (byte i = 0; i < _count; i++)
+		{
+			auto &range = _ranges[i];
+			if (isSameDevice(range, slaveId, deviceNumber) && range.timeScale == timeScale &&
+				startTime <= range.endTime && endTime >= range.startTime)
+			{
+				if (startTime < range.startTime)
+					range.startTime = startTime;
+				if (endTime > range.endTime)
+					range.endTime = endTime;
+				return true;
+			}
+		}
+		if (_count == _capacity)
+		{
+			removeAt(0);
+			_droppedRanges++;
+		}
+		auto &range = _ranges[_count++];
+		range.slaveId = slaveId;
+		range.deviceNumber = deviceNumber;
+		range.timeScale = timeScale;
+		range.startTime = startTime;
+		range.endTime = endTime;
+		return true;
+	}
+
+	// Takes up to maxPoints data points from the front of the oldest range. What is left of the
+	// range goes to the back of the queue.
+	bool takeChunk(word maxPoints, BackfillRange &chunkOut)
+	{
+		if (_count == 0 || maxPoints == 0)
+			return false;
+		chunkOut = _ranges[0];
+		uint32_t maxDuration = (uint64_t)TimeManager::getPeriodFromTimeScale(chunkOut.timeScale) * maxPoints / 1000;
+		if (maxDuration == 0)
+			maxDuration = 1;
+		if (chunkOut.endTime - chunkOut.startTime <= maxDuration)
+		{
+			removeAt(0);
+			return true;
+		}
+		chunkOut.endTime = chunkOut.startTime + maxDuration;
+		BackfillRange rest = _ranges[0];
+		rest.startTime = chunkOut.endTime;
+		removeAt(0);
+		_ranges[_count++] = rest;
+		return true;
+	}
+
+	// For when a device leaves the directory
+	void removeDevice(byte slaveId, word deviceNumber)
+	{
+		byte i = 0;
+		while (i < _count)
+		{
+			if (isSameDevice(_ranges[i], slaveId, deviceNumber))
+				removeAt(i);
+			else
+				i++;
+		}
+	}
+
+	// The range the next chunk is taken from, or null if there is none
+	BackfillRange *front()
+	{
+		return _count == 0 ? nullptr : &_ranges[0];
+	}
+
+	bool isEmpty()
+	{
+		return _count == 0;
+	}
+
+	byte getCount()
+	{
+		return _count;
+	}
+
+	uint32_t getDroppedRanges()
+	{
+		return _droppedRanges;
+	}
+
+	~BackfillQueue()
+	{
+		clear();
+	}
+};
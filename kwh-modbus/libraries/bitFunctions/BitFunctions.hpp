@@ -1,6 +1,7 @@
 #pragma once
 
 #ifdef NO_ARDUINO
+#include "../../noArduino/ArduinoMacros.h"
 #else
 #include "../arduinoMacros/arduinoMacros.h"
 #endif
@@ -9,15 +10,21 @@
 class BitFunctions
 {
 public:
-	static inline char bitsToBytes(unsigned char bits)
+	// Bit counts are 32-bit, since a page of up to 64-bit points can have more than 65535 bits
+	static inline uint32_t bitsToBytes(uint32_t bits)
 	{
-		unsigned char result = bits / CHAR_BIT;
+		uint32_t result = bits / CHAR_BIT;
 		if (bits % CHAR_BIT == 0)
 			return result;
 		else
 			return result + 1;
 	}
 
+	static inline bool isPowerOfTwo(uint32_t value)
+	{
+		return value != 0 && (value & (value - 1)) == 0;
+	}
+
 	template<class T, class N>
 	static inline void setBits(T *ptr, N bit, N count = 1)
 	{
@@ -62,9 +69,9 @@ public:
 	}
 
 	template<class T, class N>
-	static inline N bitsToStructs(unsigned char bits)
+	static inline N bitsToStructs(uint32_t bits)
 	{
-		unsigned char result = bits / (CHAR_BIT * sizeof(T));
+		uint32_t result = bits / (CHAR_BIT * sizeof(T));
 		if (bits % (CHAR_BIT * sizeof(T)) == 0)
 			return result;
 		else
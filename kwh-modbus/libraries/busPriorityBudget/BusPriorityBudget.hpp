@@ -0,0 +1,94 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+// Classes of master work, highest priority first
+enum class BusPriority : byte
+{
+	timeSync = 0,
+	liveData = 1,
+	onboarding = 2,
+	backfill = 3
+};
+
+// Bus time each priority class may use per cycle. A class that has used up its budget waits for the
+// next cycle, so lower classes can't crowd out higher ones and no class can hold the bus indefinitely.
+// A budget of 0 means unlimited. All times are in microseconds.
+class BusPriorityBudget
+{
+public:
+	static const byte numPriorities = 4;
+
+private_testable:
+	unsigned long _cycleLength = 1000000;
+	unsigned long _cycleStart = 0;
+	unsigned long _budget[numPriorities];
+	unsigned long _spent[numPriorities];
+
+public:
+	BusPriorityBudget()
+	{
+		for (byte i = 0; i < numPriorities; i++)
+		{
+			_budget[i] = 0;
+			_spent[i] = 0;
+		}
+	}
+
+	void config(unsigned long cycleLength)
+	{
+		_cycleLength = cycleLength;
+	}
+
+	void setBudget(BusPriority priority, unsigned long budget)
+	{
+		_budget[(byte)priority] = budget;
+	}
+
+	unsigned long getBudget(BusPriority priority)
+	{
+		return _budget[(byte)priority];
+	}
+
+	unsigned long getCycleLength()
+	{
+		return _cycleLength;
+	}
+
+	void reset(unsigned long now)
+	{
+		_cycleStart = now;
+		for (byte i = 0; i < numPriorities; i++)
+		{
+			_spent[i] = 0;
+		}
+	}
+
+	// Starts a new cycle if the current one is over
+	void update(unsigned long now)
+	{
+		if ((unsigned long)(now - _cycleStart) >= _cycleLength)
+			reset(now);
+	}
+
+	void charge(BusPriority priority, unsigned long time)
+	{
+		_spent[(byte)priority] += time;
+	}
+
+	unsigned long getSpent(BusPriority priority)
+	{
+		return _spent[(byte)priority];
+	}
+
+	bool hasBudget(BusPriority priority)
+	{
+		byte index = (byte)priority;
+		return _budget[index] == 0 || _spent[index] < _budget[index];
+	}
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+enum class BusTimeCategory : byte
+{
+	discovery = 0,
+	timeSync = 1,
+	collection = 2,
+	delivery = 3
+};
+
+// Keeps track of how much of the bus the master uses, and for what. Each request is charged both
+// the time its frames would take on the wire at the configured baud (including the 3.5 character
+// frame delay), and the wall time the request actually took, including turnaround, timeouts and retries.
+// All times are in microseconds.
+class BusTimeAccounting
+{
+public:
+	static const byte numCategories = 4;
+
+private_testable:
+	long _baud = 0;
+	uint32_t _charTime = 0;
+	uint32_t _frameDelay = 0;
+
+	uint64_t _wireTime[numCategories];
+	uint64_t _measuredTime[numCategories];
+	uint32_t _requests[numCategories];
+
+	uint64_t _elapsedTime = 0;
+	unsigned long _lastUpdate = 0;
+
+public:
+	// RTU frame lengths, including slave ID and CRC
+	static word getReadRequestLength()
+	{
+		return 8;
+	}
+
+	static word getReadResponseLength(word regCount)
+	{
+		return 5 + 2 * regCount;
+	}
+
+	static word getWriteRequestLength(word regCount)
+	{
+		return regCount == 1 ? 8 : 9 + 2 * regCount;
+	}
+
+	static word getWriteResponseLength()
+	{
+		return 8;
+	}
+
+	static word getExceptionResponseLength()
+	{
+		return 5;
+	}
+
+	BusTimeAccounting()
+	{
+		reset(0);
+	}
+
+	// frameDelay is the t3.5 that ModbusSerial::config derived from the same baud
+	void config(long baud, uint32_t frameDelay)
+	{
+		if (baud != _baud)
+		{
+			_baud = baud;
+			// 11 bits per character: start, 8 data, parity or second stop, stop
+			_charTime = baud > 0 ? (uint32_t)(11000000 / baud) : 0;
+		}
+		_frameDelay = frameDelay;
+	}
+
+	void reset(unsigned long now)
+	{
+		for (byte i = 0; i < numCategories; i++)
+		{
+			_wireTime[i] = 0;
+			_measuredTime[i] = 0;
+			_requests[i] = 0;
+		}
+		_elapsedTime = 0;
+		_lastUpdate = now;
+	}
+
+	// Keeps elapsed time across micros() overflow, as long as this is called every 70 minutes or so
+	void update(unsigned long now)
+	{
+		_elapsedTime += (unsigned long)(now - _lastUpdate);
+		_lastUpdate = now;
+	}
+
+	uint32_t getFrameWireTime(word frameLength)
+	{
+		if (frameLength == 0)
+			return 0;
+		return (uint32_t)frameLength * _charTime + _frameDelay;
+	}
+
+	// A response length of 0 means no response was received, or none was expected
+	void record(BusTimeCategory category, word requestLength, word responseLength,
+		unsigned long startTime, unsigned long endTime)
+	{
+		byte index = (byte)category;
+		if (index >= numCategories)
+			return;
+		_wireTime[index] += getFrameWireTime(requestLength) + getFrameWireTime(responseLength);
+		_measuredTime[index] += (unsigned long)(endTime - startTime);
+		_requests[index]++;
+		update(endTime);
+	}
+
+	uint64_t getWireTime(BusTimeCategory category)
+	{
+		return _wireTime[(byte)category];
+	}
+
+	uint64_t getMeasuredTime(BusTimeCategory category)
+	{
+		return _measuredTime[(byte)category];
+	}
+
+	uint32_t getRequestCount(BusTimeCategory category)
+	{
+		return _requests[(byte)category];
+	}
+
+	uint64_t getTotalWireTime()
+	{
+		uint64_t total = 0;
+		for (byte i = 0; i < numCategories; i++)
+		{
+			total += _wireTime[i];
+		}
+		return total;
+	}
+
+	uint64_t getTotalMeasuredTime()
+	{
+		uint64_t total = 0;
+		for (byte i = 0; i < numCategories; i++)
+		{
+			total += _measuredTime[i];
+		}
+		return total;
+	}
+
+	uint64_t getElapsedTime()
+	{
+		return _elapsedTime;
+	}
+
+	// Percentage of elapsed time the master spent on bus requests
+	byte getUtilization()
+	{
+		if (_elapsedTime == 0)
+			return 0;
+		uint64_t percent = getTotalMeasuredTime() * 100 / _elapsedTime;
+		return percent > 100 ? 100 : (byte)percent;
+	}
+
+	// Percentage of elapsed time frames were actually on the wire
+	byte getWireUtilization()
+	{
+		if (_elapsedTime == 0)
+			return 0;
+		uint64_t percent = getTotalWireTime() * 100 / _elapsedTime;
+		return percent > 100 ? 100 : (byte)percent;
+	}
+
+	// Percentage of the time spent on requests in the category that frames were on the wire.
+	// Low values mean time is going to slave turnaround, timeouts and retries.
+	byte getWireEfficiency(BusTimeCategory category)
+	{
+		uint64_t measured = getMeasuredTime(category);
+		if (measured == 0)
+			return 0;
+		uint64_t percent = getWireTime(category) * 100 / measured;
+		return percent > 100 ? 100 : (byte)percent;
+	}
+};
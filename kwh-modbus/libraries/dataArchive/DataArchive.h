@@ -0,0 +1,19 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+#include "../timeManager/TimeManager.h"
+
+// Long term storage for data pages read from data collectors. The master appends every page it reads,
+// whether or not the page is also cached or sent to data transmitters.
+class DataArchive
+{
+public:
+	// Points are dataSize bits each, packed, with the first point at startTime.
+	virtual bool append(byte *deviceName, uint32_t startTime, byte dataSize, TimeScale timeScale, word numPoints, byte *data) = 0;
+};
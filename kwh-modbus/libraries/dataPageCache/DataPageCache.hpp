@@ -0,0 +1,303 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+#include "../timeManager/TimeManager.h"
+#include "../bitFunctions/BitFunctions.hpp"
+
+struct DataPageCacheEntry
+{
+	uint32_t startTime;
+	word numPoints;
+	byte dataSize;
+	TimeScale timeScale;
+};
+
+struct DataPageCacheDestination
+{
+	byte slaveId = 0;
+	word deviceNumber = 0;
+	uint32_t cursor = 0;
+};
+
+// Ring buffer of data pages read from data collectors, waiting to be delivered to data transmitters.
+// Positions in the cache are absolute byte offsets that only increase, so each destination can keep
+// its own cursor. When the cache is full, the oldest pages are dropped, and cursors that pointed to
+// them skip ahead to the oldest page still cached.
+class DataPageCache
+{
+private_testable:
+	static const byte _headerSize = 8;
+
+	byte *_buffer = nullptr;
+	word _capacity = 0;
+	word _deviceNameLength = 0;
+
+	uint32_t _head = 0;
+	uint32_t _tail = 0;
+	word _numPages = 0;
+	uint32_t _droppedPages = 0;
+
+	DataPageCacheDestination *_destinations = nullptr;
+	byte _maxDestinations = 0;
+
+	void writeBytes(uint32_t position, byte *src, word count)
+	{
+		for (word i = 0; i < count; i++)
+		{
+			_buffer[(position + i) & (_capacity - 1)] = src[i];
+		}
+	}
+
+	void readBytes(uint32_t position, byte *dest, word count)
+	{
+		for (word i = 0; i < count; i++)
+		{
+			dest[i] = _buffer[(position + i) & (_capacity - 1)];
+		}
+	}
+
+	void readHeader(uint32_t position, DataPageCacheEntry &entryOut)
+	{
+		byte header[_headerSize];
+		readBytes(position, header, _headerSize);
+		entryOut.startTime = (uint32_t)header[0] | ((uint32_t)header[1] << 8) |
+			((uint32_t)header[2] << 16) | ((uint32_t)header[3] << 24);
+		entryOut.numPoints = (word)header[4] | ((word)header[5] << 8);
+		entryOut.dataSize = header[6];
+		entryOut.timeScale = (TimeScale)header[7];
+	}
+
+	uint32_t getEntrySize(word numPoints, byte dataSize)
+	{
+		return _headerSize + _deviceNameLength + BitFunctions::bitsToBytes((uint32_t)numPoints * dataSize);
+	}
+
+	uint32_t getEntrySize(uint32_t position)
+	{
+		DataPageCacheEntry entry;
+		readHeader(position, entry);
+		return getEntrySize(entry.numPoints, entry.dataSize);
+	}
+
+	bool isCursorValid(uint32_t cursor)
+	{
+		return cursor - _tail <= _head - _tail;
+	}
+
+	void dropOldestPage()
+	{
+		_tail += getEntrySize(_tail);
+		_numPages--;
+		_droppedPages++;
+	}
+
+	bool compareName(uint32_t position, byte *name)
+	{
+		for (word i = 0; i < _deviceNameLength; i++)
+		{
+			if (_buffer[(position + _headerSize + i) & (_capacity - 1)] != name[i])
+				return false;
+		}
+		return true;
+	}
+
+public:
+	bool init(word capacity, word deviceNameLength, byte maxDestinations)
+	{
+		clear();
+		// Positions wrap at 2^32, which only lines up with the buffer if the capacity is a power of two
+		if (!BitFunctions::isPowerOfTwo(capacity) || capacity <= _headerSize + deviceNameLength || maxDestinations == 0)
+			return false;
+		_capacity = capacity;
+		_deviceNameLength = deviceNameLength;
+		_maxDestinations = maxDestinations;
+		_buffer = new byte[_capacity];
+		_destinations = new DataPageCacheDestination[_maxDestinations];
+		return true;
+	}
+
+	void clear()
+	{
+		if (_buffer != nullptr)
+		{
+			delete[] _buffer;
+			_buffer = nullptr;
+		}
+		if (_destinations != nullptr)
+		{
+			delete[] _destinations;
+			_destinations = nullptr;
+		}
+		_capacity = 0;
+		_maxDestinations = 0;
+		_head = 0;
+		_tail = 0;
+		_numPages = 0;
+		_droppedPages = 0;
+	}
+
+	// Adds a page to the cache, dropping the oldest pages if necessary. A page with the
+	// same device and start time that is still cached is not added again.
+	bool append(byte *deviceName, uint32_t startTime, byte dataSize, TimeScale timeScale, word numPoints, byte *data)
+	{
+		uint32_t entrySize = getEntrySize(numPoints, dataSize);
+		if (_buffer == nullptr || entrySize > _capacity)
+			return false;
+		if (findPage(deviceName, startTime) != _head)
+			return true;
+		while (_head + entrySize - _tail > _capacity)
+		{
+			dropOldestPage();
+		}
+		byte header[_headerSize];
+		header[0] = (byte)startTime;
+		header[1] = (byte)(startTime >> 8);
+		header[2] = (byte)(startTime >> 16);
+		header[3] = (byte)(startTime >> 24);
+		header[4] = (byte)numPoints;
+		header[5] = (byte)(numPoints >> 8);
+		header[6] = dataSize;
+		header[7] = (byte)timeScale;
+		writeBytes(_head, header, _headerSize);
+		writeBytes(_head + _headerSize, deviceName, _deviceNameLength);
+		writeBytes(_head + _headerSize + _deviceNameLength, data, BitFunctions::bitsToBytes((uint32_t)numPoints * dataSize));
+		_head += entrySize;
+		_numPages++;
+		return true;
+	}
+
+	// Returns the position of the cached page for a device and start time, or the head if there is none
+	uint32_t findPage(byte *deviceName, uint32_t startTime)
+	{
+		DataPageCacheEntry entry;
+		for (uint32_t position = _tail; position != _head; position += getEntrySize(entry.numPoints, entry.dataSize))
+		{
+			readHeader(position, entry);
+			if (entry.startTime == startTime && compareName(position, deviceName))
+				return position;
+		}
+		return _head;
+	}
+
+	// Copies the page at the cursor, and moves the cursor past it. Cursors pointing to
+	// dropped pages are moved to the oldest cached page first. Pages with more data than
+	// dataBufferSize are skipped, since they could never be read into that buffer. Returns
+	// false if there are no more pages.
+	bool readPage(uint32_t &cursor, DataPageCacheEntry &entryOut, byte *deviceNameOut, byte *dataOut, word dataBufferSize)
+	{
+		if (!isCursorValid(cursor))
+			cursor = _tail;
+		uint32_t dataBytes;
+		while (true)
+		{
+			if (cursor == _head)
+				return false;
+			readHeader(cursor, entryOut);
+			dataBytes = BitFunctions::bitsToBytes((uint32_t)entryOut.numPoints * entryOut.dataSize);
+			if (dataBytes <= dataBufferSize)
+				break;
+			cursor += getEntrySize(entryOut.numPoints, entryOut.dataSize);
+		}
+		readBytes(cursor + _headerSize, deviceNameOut, _deviceNameLength);
+		readBytes(cursor + _headerSize + _deviceNameLength, dataOut, dataBytes);
+		cursor += getEntrySize(entryOut.numPoints, entryOut.dataSize);
+		return true;
+	}
+
+	// Gets the delivery cursor for a destination device, adding the destination if it is new.
+	// New destinations start at the oldest cached page.
+	bool getCursor(byte slaveId, word deviceNumber, uint32_t &cursorOut)
+	{
+		int freeIndex = -1;
+		for (int i = 0; i < _maxDestinations; i++)
+		{
+			if (_destinations[i].slaveId == slaveId && _destinations[i].deviceNumber == deviceNumber && slaveId != 0)
+			{
+				if (!isCursorValid(_destinations[i].cursor))
+					_destinations[i].cursor = _tail;
+				cursorOut = _destinations[i].cursor;
+				return true;
+			}
+			else if (_destinations[i].slaveId == 0 && freeIndex == -1)
+			{
+				freeIndex = i;
+			}
+		}
+		if (freeIndex == -1 || slaveId == 0)
+			return false;
+		_destinations[freeIndex].slaveId = slaveId;
+		_destinations[freeIndex].deviceNumber = deviceNumber;
+		_destinations[freeIndex].cursor = _tail;
+		cursorOut = _tail;
+		return true;
+	}
+
+	bool setCursor(byte slaveId, word deviceNumber, uint32_t cursor)
+	{
+		for (int i = 0; i < _maxDestinations; i++)
+		{
+			if (_destinations[i].slaveId == slaveId && _destinations[i].deviceNumber == deviceNumber && slaveId != 0)
+			{
+				_destinations[i].cursor = cursor;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void removeDestination(byte slaveId, word deviceNumber)
+	{
+		for (int i = 0; i < _maxDestinations; i++)
+		{
+			if (_destinations[i].slaveId == slaveId && _destinations[i].deviceNumber == deviceNumber)
+			{
+				_destinations[i] = DataPageCacheDestination();
+			}
+		}
+	}
+
+	// Removes every destination on a slave, for when its ID is given up
+	void removeDestinationsForSlave(byte slaveId)
+	{
+		for (int i = 0; i < _maxDestinations; i++)
+		{
+			if (_destinations[i].slaveId == slaveId)
+			{
+				_destinations[i] = DataPageCacheDestination();
+			}
+		}
+	}
+
+	bool hasPendingPages(uint32_t cursor)
+	{
+		return !isCursorValid(cursor) || cursor != _head;
+	}
+
+	word getNumPages()
+	{
+		return _numPages;
+	}
+
+	uint32_t getDroppedPages()
+	{
+		return _droppedPages;
+	}
+
+	word getDeviceNameLength()
+	{
+		return _deviceNameLength;
+	}
+
+	DataPageCache() { }
+
+	~DataPageCache()
+	{
+		clear();
+	}
+};
@@ -0,0 +1,217 @@
+#include "BufferedDataCollectorDevice.h"
+#include "../bitFunctions/BitFunctions.hpp"
+#include <string.h>
+
+uint32_t BufferedDataCollectorDevice::getTimeCode(uint32_t time, byte quarterSecondOffset)
+{
+	// Time codes only need to be right relative to each other, so they are allowed to wrap
+	if (_timeScale == TimeScale::ms250)
+		return time * 4 + quarterSecondOffset;
+	return time / (TimeManager::getPeriodFromTimeScale(_timeScale) / 1000);
+}
+
+bool BufferedDataCollectorDevice::recordTimeCode(uint32_t timeCode, uint32_t value, bool missing)
+{
+	if (_history == nullptr)
+		return false;
+	if (_numStored == 0)
+	{
+		_newestSlot = 0;
+		_newestTimeCode = timeCode;
+		_numStored = 1;
+		writeSlot(_newestSlot, value, missing);
+		return true;
+	}
+	int32_t periods = (int32_t)(timeCode - _newestTimeCode);
+	if (periods < 0)
+		return false;
+	if (periods >= _capacity)
+	{
+		// Everything stored is older than the buffer reaches now
+		_numStored = 0;
+		return recordTimeCode(timeCode, value, missing);
+	}
+	for (int32_t i = 1; i <= periods; i++)
+	{
+		_newestSlot = (_newestSlot + 1) % _capacity;
+		if (i < periods)
+			writeSlot(_newestSlot, 0, true);
+	}
+	_newestTimeCode = timeCode;
+	if ((uint32_t)_numStored + periods > _capacity)
+		_numStored = _capacity;
+	else
+		_numStored += periods;
+	writeSlot(_newestSlot, value, missing);
+	return true;
+}
+
+void BufferedDataCollectorDevice::writeSlot(word slot, uint32_t value, bool missing)
+{
+	uint32_t bit = (uint32_t)slot * _dataPacketSize;
+	if (missing)
+	{
+		BitFunctions::setBits(_history, bit, (uint32_t)_dataPacketSize);
+		return;
+	}
+	// Little endian whatever the platform, like the pages the master reads
+	byte point[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	for (byte i = 0; i < 4; i++)
+	{
+		point[i] = (byte)(value >> (8 * i));
+	}
+	BitFunctions::copyBits(point, _history, (uint32_t)0, bit, (uint32_t)_dataPacketSize);
+}
+
+uint64_t BufferedDataCollectorDevice::readSlot(word slot)
+{
+	byte point[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	BitFunctions::copyBits(_history, point, (uint32_t)slot * _dataPacketSize, (uint32_t)0, (uint32_t)_dataPacketSize);
+	uint64_t value = 0;
+	for (byte i = 0; i < 8; i++)
+	{
+		value |= (uint64_t)point[i] << (8 * i);
+	}
+	return value;
+}
+
+void BufferedDataCollectorDevice::copyPoints(byte *src, byte *dest, uint32_t srcBit, uint32_t destBit, uint32_t count)
+{
+	if (srcBit % 8 == 0 && destBit % 8 == 0)
+	{
+		memcpy(dest + destBit / 8, src + srcBit / 8, count / 8);
+		uint32_t copied = count - count % 8;
+		srcBit += copied;
+		destBit += copied;
+		count -= copied;
+	}
+	BitFunctions::copyBits(src, dest, srcBit, destBit, count);
+}
+
+void BufferedDataCollectorDevice::clearHistory()
+{
+	if (_history != nullptr)
+	{
+		delete[] _history;
+		_history = nullptr;
+	}
+	_capacity = 0;
+	_numStored = 0;
+	_newestSlot = 0;
+	_newestTimeCode = 0;
+}
+
+bool BufferedDataCollectorDevice::readDataPoint(uint32_t time, byte quarterSecondOffset, byte * dataBuffer, byte dataSizeBits)
+{
+	uint32_t age = _newestTimeCode - getTimeCode(time, quarterSecondOffset);
+	if (_numStored == 0 || (int32_t)age < 0 || age >= _numStored || dataSizeBits > _dataPacketSize)
+		return false;
+	word slot = (_newestSlot + _capacity - age) % _capacity;
+	BitFunctions::copyBits(_history, dataBuffer, (uint32_t)slot * _dataPacketSize, (uint32_t)0, (uint32_t)dataSizeBits);
+	return true;
+}
+
+bool BufferedDataCollectorDevice::readDataPoints(uint32_t time, byte quarterSecondOffset, word count, word stride, byte * buffer, byte dataSizeBits)
+{
+	if (dataSizeBits != _dataPacketSize)
+		return DataCollectorDevice::readDataPoints(time, quarterSecondOffset, count, stride, buffer, dataSizeBits);
+	uint32_t timeCode = getTimeCode(time, quarterSecondOffset);
+	word i = 0;
+	while (i < count)
+	{
+		// Each pass handles a run of points that are either all missing or all in one stretch of the
+		// ring, so a page takes at most a few bulk copies
+		uint32_t age = _newestTimeCode - (timeCode + (uint32_t)i * stride);
+		uint32_t run = count - i;
+		if (_numStored == 0 || (int32_t)age < 0 || age >= _numStored)
+		{
+			if (stride != 1)
+				run = 1;
+			else if (_numStored != 0 && (int32_t)age >= 0 && age - _numStored + 1 < run)
+				run = age - _numStored + 1;
+			BitFunctions::setBits(buffer, (uint32_t)i * dataSizeBits, run * dataSizeBits);
+		}
+		else
+		{
+			word slot = (_newestSlot + _capacity - age) % _capacity;
+			if (stride != 1)
+				run = 1;
+			if (age + 1 < run)
+				run = age + 1;
+			if ((uint32_t)_capacity - slot < run)
+				run = _capacity - slot;
+			copyPoints(_history, buffer, (uint32_t)slot * dataSizeBits, (uint32_t)i * dataSizeBits, run * dataSizeBits);
+		}
+		i += run;
+	}
+	return true;
+}
+
+bool BufferedDataCollectorDevice::init(bool accumulateData, TimeScale timeScale, byte dataPacketSize, word capacity,
+	PageEncoding pageEncoding)
+{
+	if (capacity == 0 || !DataCollectorDevice::init(accumulateData, timeScale, dataPacketSize, pageEncoding))
+		return false;
+	clearHistory();
+	_capacity = capacity;
+	_history = new byte[BitFunctions::bitsToBytes((uint32_t)capacity * dataPacketSize)];
+	return true;
+}
+
+bool BufferedDataCollectorDevice::record(uint32_t value)
+{
+	TimeManager *timeSource = getTimeSource();
+	if (timeSource == nullptr)
+		return false;
+	return recordAt(timeSource->getClock(), 0, value);
+}
+
+bool BufferedDataCollectorDevice::recordAt(uint32_t time, byte quarterSecondOffset, uint32_t value)
+{
+	return recordTimeCode(getTimeCode(time, quarterSecondOffset), value, false);
+}
+
+bool BufferedDataCollectorDevice::recordMissingAt(uint32_t time, byte quarterSecondOffset)
+{
+	return recordTimeCode(getTimeCode(time, quarterSecondOffset), 0, true);
+}
+
+uint32_t BufferedDataCollectorDevice::sumPoints(uint32_t time, byte quarterSecondOffset, uint32_t count, uint64_t &outSum)
+{
+	outSum = 0;
+	if (_numStored == 0 || count == 0)
+		return 0;
+	// Only the ages that overlap what is stored are visited, however long the span is
+	int64_t firstAge = (int32_t)(_newestTimeCode - getTimeCode(time, quarterSecondOffset));
+	int64_t lastAge = firstAge - (count - 1);
+	if (lastAge < 0)
+		lastAge = 0;
+	if (firstAge > _numStored - 1)
+		firstAge = _numStored - 1;
+	uint64_t missing = ((uint64_t)1 << _dataPacketSize) - 1;
+	uint32_t added = 0;
+	for (int64_t age = lastAge; age <= firstAge; age++)
+	{
+		uint64_t value = readSlot((_newestSlot + _capacity - (word)age) % _capacity);
+		if (value == missing)
+			continue;
+		outSum += value;
+		added++;
+	}
+	return added;
+}
+
+word BufferedDataCollectorDevice::getCapacity()
+{
+	return _capacity;
+}
+
+word BufferedDataCollectorDevice::getNumStored()
+{
+	return _numStored;
+}
+
+BufferedDataCollectorDevice::~BufferedDataCollectorDevice()
+{
+	clearHistory();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "DataCollectorDevice.h"
+
+// Data collector that keeps its newest points in a ring buffer, one point per period, packed
+// dataPacketSize bits each. Call record once per period, and pages are filled straight from the
+// buffer. Periods that were skipped, and periods older than the buffer, read as missing points,
+// which have all of their bits set.
+class BufferedDataCollectorDevice : public DataCollectorDevice
+{
+private_testable:
+	byte *_history = nullptr;
+	word _capacity = 0;
+	word _numStored = 0;
+	// Slot and time code of the newest point
+	word _newestSlot = 0;
+	uint32_t _newestTimeCode = 0;
+
+	uint32_t getTimeCode(uint32_t time, byte quarterSecondOffset);
+	bool recordTimeCode(uint32_t timeCode, uint32_t value, bool missing);
+	void writeSlot(word slot, uint32_t value, bool missing);
+	uint64_t readSlot(word slot);
+	static void copyPoints(byte *src, byte *dest, uint32_t srcBit, uint32_t destBit, uint32_t count);
+
+	void clearHistory();
+
+protected_testable:
+	virtual bool readDataPoint(uint32_t time, byte quarterSecondOffset, byte* dataBuffer, byte dataSizeBits);
+	virtual bool readDataPoints(uint32_t time, byte quarterSecondOffset, word count, word stride, byte* buffer, byte dataSizeBits);
+
+public:
+	bool init(bool accumulateData, TimeScale timeScale, byte dataPacketSize, word capacity,
+		PageEncoding pageEncoding = PageEncoding::raw);
+
+	// Records the point for the period the time source's clock is in. With TimeScale::ms250 the clock
+	// only has whole seconds, so use recordAt instead.
+	bool record(uint32_t value);
+	// Records the point for the period containing time. Periods older than the newest point can't be
+	// recorded, and recording the newest period again replaces its point.
+	bool recordAt(uint32_t time, byte quarterSecondOffset, uint32_t value);
+	bool recordMissingAt(uint32_t time, byte quarterSecondOffset);
+
+	// Adds up the points stored for count periods starting at time, skipping missing ones, and returns
+	// how many were added
+	uint32_t sumPoints(uint32_t time, byte quarterSecondOffset, uint32_t count, uint64_t &outSum);
+
+	word getCapacity();
+	word getNumStored();
+
+	~BufferedDataCollectorDevice();
+};
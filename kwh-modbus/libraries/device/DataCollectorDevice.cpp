@@ -13,32 +13,74 @@ inline bool DataCollectorDevice::verifyTimeScaleAndSize(TimeScale timeScale, byt
 word DataCollectorDevice::getType()
 {
 	word result;
-	getDataCollectorDeviceTypeFromParameters(_accumulateData, _timeScale, _dataPacketSize, result);
+	getDataCollectorDeviceTypeFromParameters(_accumulateData, _timeScale, _dataPacketSize, _pageEncoding, result);
 	return result;
 }
 
-bool DataCollectorDevice::init(bool accumulateData, TimeScale timeScale, byte dataPacketSize)
+bool DataCollectorDevice::init(bool accumulateData, TimeScale timeScale, byte dataPacketSize, PageEncoding pageEncoding)
 {
 	if (!verifyTimeScaleAndSize(timeScale, dataPacketSize))
 		return false;
 	_accumulateData = accumulateData;
 	_timeScale = timeScale;
 	_dataPacketSize = dataPacketSize;
+	_pageEncoding = pageEncoding;
 	if (_dataBuffer != nullptr)
 		delete[] _dataBuffer;
-	_dataBuffer = new byte(BitFunctions::bitsToBytes(_dataPacketSize));
+	_dataBuffer = new byte[BitFunctions::bitsToBytes(_dataPacketSize)];
+	return true;
+}
+
+void DataCollectorDevice::setDeadband(uint32_t deadband)
+{
+	_deadband = deadband;
+}
+
+uint32_t DataCollectorDevice::getDeadband()
+{
+	return _deadband;
+}
+
+bool DataCollectorDevice::readDataPoints(uint32_t time, byte quarterSecondOffset, word count, word stride, byte * buffer, byte dataSizeBits)
+{
+	uint32_t period = TimeManager::getPeriodFromTimeScale(_timeScale) / 1000; // Seconds
+	// Points of whole bytes are read straight into the buffer, the rest through _dataBuffer
+	bool wholeBytes = dataSizeBits % 8 == 0;
+	if (!wholeBytes && dataSizeBits > _dataPacketSize)
+		return false;
+	for (word i = 0; i < count; i++)
+	{
+		byte *point = wholeBytes ? buffer + (uint32_t)i * (dataSizeBits / 8) : _dataBuffer;
+		if (!readDataPoint(time, quarterSecondOffset, point, dataSizeBits))
+		{
+			BitFunctions::setBits(point, (byte)0, dataSizeBits);
+		}
+		if (!wholeBytes)
+			BitFunctions::copyBits(_dataBuffer, buffer, (uint32_t)0, (uint32_t)dataSizeBits * i, (uint32_t)dataSizeBits);
+		if (_timeScale == TimeScale::ms250)
+		{
+			uint32_t quarters = (uint32_t)quarterSecondOffset + stride;
+			time += quarters / 4;
+			quarterSecondOffset = quarters % 4;
+		}
+		else
+		{
+			time += period * stride;
+		}
+	}
+	return true;
 }
 
-bool DataCollectorDevice::readData(uint32_t startTime, word numPoints, byte page, byte * buffer, word bufferSize,
-	byte maxPoints, byte & outDataPointsCount, byte & outPagesRemaining, byte &outDataPointSize)
+bool DataCollectorDevice::readData(uint32_t startTime, word numPoints, word page, byte * buffer, word bufferSize,
+	word maxPoints, word & outDataPointsCount, word & outPagesRemaining, byte &outDataPointSize)
 {
 	uint32_t period = TimeManager::getPeriodFromTimeScale(_timeScale) / 1000; // Seconds
-	auto numPointsPerPage = (bufferSize * 8) / (_dataPacketSize);
+	int32_t numPointsPerPage = ((int32_t)bufferSize * 8) / (_dataPacketSize);
 	if (numPointsPerPage > maxPoints && maxPoints > 0)
 		numPointsPerPage = maxPoints;
-	auto startPoint = page * numPointsPerPage;
+	int32_t startPoint = (int32_t)page * numPointsPerPage;
 	outPagesRemaining = (numPoints - startPoint - 1) / numPointsPerPage;
-	auto curNumPoints = numPointsPerPage < numPoints ? numPointsPerPage : numPoints;
+	int32_t curNumPoints = numPointsPerPage < numPoints ? numPointsPerPage : numPoints;
 	if (outPagesRemaining == 0)
 		curNumPoints = numPoints - startPoint;
 	outDataPointsCount = curNumPoints;
@@ -57,29 +99,16 @@ bool DataCollectorDevice::readData(uint32_t startTime, word numPoints, byte page
 		curTime = startTime + startPoint * period;
 	}
 
-	word bufferBit = 0;
-	for (int i = 0; i < curNumPoints; i++)
-	{
-		if (!readDataPoint(curTime, quarterSecondOffset, _dataBuffer, _dataPacketSize))
-		{
-			BitFunctions::setBits(_dataBuffer, (byte)0, _dataPacketSize);
-		}
-		BitFunctions::copyBits(_dataBuffer, buffer, 0, _dataPacketSize * i, (int)_dataPacketSize);
-		if (_timeScale == TimeScale::ms250)
-		{
-			quarterSecondOffset = (quarterSecondOffset + 1) % 4;
-			if (quarterSecondOffset == 0)
-				curTime++;
-		}
-		else
-		{
-			curTime += period;
-		}
-	}
-	return true;
+	return readDataPoints(curTime, quarterSecondOffset, curNumPoints, 1, buffer, _dataPacketSize);
 }
 
 bool DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(bool accumulateData, TimeScale timeScale, byte dataPacketSize, word & deviceType)
+{
+	return getDataCollectorDeviceTypeFromParameters(accumulateData, timeScale, dataPacketSize, PageEncoding::raw, deviceType);
+}
+
+bool DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(bool accumulateData, TimeScale timeScale, byte dataPacketSize,
+	PageEncoding pageEncoding, word & deviceType)
 {
 	if (!verifyTimeScaleAndSize(timeScale, dataPacketSize))
 		return false;
@@ -92,14 +121,23 @@ bool DataCollectorDevice::getDataCollectorDeviceTypeFromParameters(bool accumula
 	deviceType <<= 6;
 	deviceType += dataPacketSize;
 	deviceType <<= 4;
+	deviceType += (byte)pageEncoding;
 	return true;
 }
 
 bool DataCollectorDevice::getParametersFromDataCollectorDeviceType(word deviceType, bool & accumulateData, TimeScale & timeScale, byte & dataPacketSize)
 {
-	if (deviceType & 0xFF != 0)
+	PageEncoding pageEncoding;
+	return getParametersFromDataCollectorDeviceType(deviceType, accumulateData, timeScale, dataPacketSize, pageEncoding);
+}
+
+bool DataCollectorDevice::getParametersFromDataCollectorDeviceType(word deviceType, bool & accumulateData, TimeScale & timeScale, byte & dataPacketSize,
+	PageEncoding & pageEncoding)
+{
+	if ((deviceType & 0x0C) != 0)
 		// device type is not padded with zeros
 		return false;
+	pageEncoding = (PageEncoding)(deviceType & 0x03);
 	deviceType >>= 4;
 	dataPacketSize = deviceType & 0x3F;
 	deviceType >>= 6;
@@ -1,3 +1,4 @@
+#pragma once
 #include "Device.h"
 #include "../timeManager/TimeManager.h"
 
@@ -7,6 +8,8 @@ private_testable:
 	bool _accumulateData;
 	TimeScale _timeScale;
 	byte _dataPacketSize;
+	PageEncoding _pageEncoding = PageEncoding::raw;
+	uint32_t _deadband = 0;
 	byte *_dataBuffer = nullptr;
 
 	static inline bool verifyTimeScaleAndSize(TimeScale timeScale, byte dataPacketSize);
@@ -14,13 +17,25 @@ private_testable:
 protected_testable:
 	virtual bool readDataPoint(uint32_t time, byte quarterSecondOffset, byte* dataBuffer, byte dataSizeBits) = 0;
 
+	// Reads count points into buffer, packed dataSizeBits each, starting with the point at time and
+	// quarterSecondOffset. Each point is stride periods after the one before. A point that can't be
+	// read has all of its bits set. By default this calls readDataPoint for each point, so devices that
+	// keep their points in an array or ring buffer can override it to fill a page in one call.
+	virtual bool readDataPoints(uint32_t time, byte quarterSecondOffset, word count, word stride, byte* buffer, byte dataSizeBits);
+
 public:
 	word getType();
-	bool init(bool accumulateData, TimeScale timeScale, byte dataPacketSize);
+	bool init(bool accumulateData, TimeScale timeScale, byte dataPacketSize, PageEncoding pageEncoding = PageEncoding::raw);
+	void setDeadband(uint32_t deadband);
+	uint32_t getDeadband();
 
-	virtual bool readData(uint32_t startTime, word numPoints, byte page,
-		byte* buffer, word bufferSize, byte maxPoints, byte &outDataPointsCount, byte &outPagesRemaining, byte &outDataPointSize);
+	virtual bool readData(uint32_t startTime, word numPoints, word page,
+		byte* buffer, word bufferSize, word maxPoints, word &outDataPointsCount, word &outPagesRemaining, byte &outDataPointSize);
 
 	static bool getDataCollectorDeviceTypeFromParameters(bool accumulateData, TimeScale timeScale, byte dataPacketSize, word &deviceType);
+	static bool getDataCollectorDeviceTypeFromParameters(bool accumulateData, TimeScale timeScale, byte dataPacketSize,
+		PageEncoding pageEncoding, word &deviceType);
 	static bool getParametersFromDataCollectorDeviceType(word deviceType, bool &accumulateData, TimeScale &timeScale, byte &dataPacketSize);
+	static bool getParametersFromDataCollectorDeviceType(word deviceType, bool &accumulateData, TimeScale &timeScale, byte &dataPacketSize,
+		PageEncoding &pageEncoding);
 };
\ No newline at end of file
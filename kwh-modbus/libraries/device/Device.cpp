@@ -8,7 +8,7 @@ void Device::loop()
 {
 }
 
-bool Device::readData(uint32_t startTime, word numPoints, byte page, byte * buffer, word bufferSize, byte maxPoints, byte & outDataPointsCount, byte & outPagesRemaining, byte &outDataPointSize)
+bool Device::readData(uint32_t startTime, word numPoints, word page, byte * buffer, word bufferSize, word maxPoints, word & outDataPointsCount, word & outPagesRemaining, byte &outDataPointSize)
 {
 	return false;
 }
@@ -17,12 +17,12 @@ void Device::setClock(uint32_t clock)
 {
 }
 
-RecieveDataStatus Device::prepareReceiveData(word nameLength, byte * name, uint32_t startTime, byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, byte & outDataPointsPerPage)
+RecieveDataStatus Device::prepareReceiveData(word nameLength, byte * name, uint32_t startTime, byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, word & outDataPointsPerPage)
 {
 	return RecieveDataStatus::notSupported;
 }
 
-RecieveDataStatus Device::receiveDeviceData(byte dataPointsInPage, byte dataPointSize, TimeScale timesScale, byte pageNumber, byte * dataPoints)
+RecieveDataStatus Device::receiveDeviceData(word dataPointsInPage, byte dataPointSize, TimeScale timesScale, word pageNumber, byte * dataPoints)
 {
 	return RecieveDataStatus::notSupported;
 }
@@ -46,6 +46,11 @@ TimeManager* Device::getTimeSource()
 	return _timeSource;
 }
 
+uint32_t Device::getDeadband()
+{
+	return 0;
+}
+
 bool Device::isDataTransmitterDeviceType(word deviceType)
 {
 	return ((deviceType >> 14) == 2);
@@ -55,3 +60,22 @@ bool Device::isTimeServerDeviceType(word deviceType)
 {
 	return (deviceType == 1);
 }
+
+
+PageEncoding Device::getPageEncodingFromDeviceType(word deviceType)
+{
+	// Only data collectors and data transmitters advertise a page encoding
+	if ((deviceType >> 14) != 1 && (deviceType >> 14) != 2)
+		return PageEncoding::raw;
+	switch (deviceType & 0x03)
+	{
+	case (word)PageEncoding::zigzagVarint:
+		return PageEncoding::zigzagVarint;
+	case (word)PageEncoding::packedDelta:
+		return PageEncoding::packedDelta;
+	case (word)PageEncoding::deadband:
+		return PageEncoding::deadband;
+	default:
+		return PageEncoding::raw;
+	}
+}
\ No newline at end of file
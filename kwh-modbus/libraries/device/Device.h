@@ -7,6 +7,7 @@
 #endif
 
 #include "../timeManager/TimeManager.h"
+#include "../pageEncoding/PageEncoding.hpp"
 
 enum class RecieveDataStatus
 {
@@ -26,18 +27,21 @@ public:
 	virtual void setup();
 	virtual void loop();
 	virtual word getType() = 0;
-	virtual bool readData(uint32_t startTime, word numPoints, byte page,
-		byte* buffer, word bufferSize, byte maxPoints, byte &outDataPointsCount, byte &outPagesRemaining, byte &outDataPointSize);
+	virtual bool readData(uint32_t startTime, word numPoints, word page,
+		byte* buffer, word bufferSize, word maxPoints, word &outDataPointsCount, word &outPagesRemaining, byte &outDataPointSize);
 	virtual void setClock(uint32_t clock);
 	virtual RecieveDataStatus prepareReceiveData(word nameLength, byte* name, uint32_t startTime,
-		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, byte &outDataPointsPerPage);
-	virtual RecieveDataStatus receiveDeviceData(byte dataPointsInPage, byte dataPointSize,
-		TimeScale timesScale, byte pageNumber, byte* dataPoints);
+		byte dataPointSize, TimeScale dataTimeScale, word dataPointsCount, word &outDataPointsPerPage);
+	virtual RecieveDataStatus receiveDeviceData(word dataPointsInPage, byte dataPointSize,
+		TimeScale timesScale, word pageNumber, byte* dataPoints);
 	virtual uint32_t masterRequestTime();
 	virtual void deviceNotResponding(word nameLength, byte* name, uint32_t reportTime);
 	virtual void setTimeSource(TimeManager *timeSource);
 	virtual TimeManager* getTimeSource();
+	// Largest change from the last point sent that a PageEncoding::deadband page leaves out
+	virtual uint32_t getDeadband();
 
 	static bool isDataTransmitterDeviceType(word deviceType);
 	static bool isTimeServerDeviceType(word deviceType);
+	static PageEncoding getPageEncodingFromDeviceType(word deviceType);
 };
\ No newline at end of file
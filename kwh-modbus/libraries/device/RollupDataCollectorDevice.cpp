@@ -0,0 +1,39 @@
+#include "RollupDataCollectorDevice.h"
+
+bool RollupDataCollectorDevice::readDataPoint(uint32_t time, byte quarterSecondOffset, byte * dataBuffer, byte dataSizeBits)
+{
+	if (_source == nullptr || dataSizeBits > 63)
+		return false;
+	uint32_t period = TimeManager::getPeriodFromTimeScale(_timeScale) / 1000; // Seconds
+	uint64_t sum;
+	uint32_t added = _source->sumPoints(time - time % period, 0, _pointsPerPeriod, sum);
+	if (added == 0 || (_accumulateData && added != _pointsPerPeriod))
+		return false;
+	uint64_t value = _accumulateData ? sum : (sum + added / 2) / added;
+	// All bits set means missing, so the largest value that fits is one less
+	uint64_t largest = ((uint64_t)1 << dataSizeBits) - 2;
+	if (value > largest)
+		value = largest;
+	for (byte i = 0; i * 8 < dataSizeBits; i++)
+	{
+		dataBuffer[i] = (byte)(value >> (8 * i));
+	}
+	return true;
+}
+
+bool RollupDataCollectorDevice::init(BufferedDataCollectorDevice *source, TimeScale timeScale, byte dataPacketSize,
+	PageEncoding pageEncoding)
+{
+	bool accumulateData;
+	byte sourcePacketSize;
+	if (source == nullptr || !getParametersFromDataCollectorDeviceType(source->getType(), accumulateData, _sourceTimeScale, sourcePacketSize))
+		return false;
+	// Every time scale's period is a whole number of each finer one's
+	uint32_t sourcePeriod = TimeManager::getPeriodFromTimeScale(_sourceTimeScale);
+	if ((byte)timeScale <= (byte)_sourceTimeScale ||
+		!DataCollectorDevice::init(accumulateData, timeScale, dataPacketSize, pageEncoding))
+		return false;
+	_source = source;
+	_pointsPerPeriod = TimeManager::getPeriodFromTimeScale(timeScale) / sourcePeriod;
+	return true;
+}
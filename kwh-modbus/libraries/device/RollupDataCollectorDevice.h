@@ -0,0 +1,23 @@
+#pragma once
+#include "BufferedDataCollectorDevice.h"
+
+// Serves a coarser time scale of a BufferedDataCollectorDevice's points, worked out from the source's
+// buffer when a page is read, so only the finest series takes RAM. Points are summed if the source
+// accumulates data, and averaged otherwise. A summed point is missing if any of its source points
+// are, and an averaged one only if all of them are.
+class RollupDataCollectorDevice : public DataCollectorDevice
+{
+private_testable:
+	BufferedDataCollectorDevice *_source = nullptr;
+	// Source points in each of this device's points
+	uint32_t _pointsPerPeriod = 0;
+	TimeScale _sourceTimeScale;
+
+protected_testable:
+	virtual bool readDataPoint(uint32_t time, byte quarterSecondOffset, byte* dataBuffer, byte dataSizeBits);
+
+public:
+	// The time scale has to be coarser than the source's
+	bool init(BufferedDataCollectorDevice *source, TimeScale timeScale, byte dataPacketSize,
+		PageEncoding pageEncoding = PageEncoding::raw);
+};
@@ -6,6 +6,18 @@
 #endif
 
 #include "../deviceDirectoryRow/DeviceDirectoryRow.h"
+#include "../device/DataCollectorDevice.h"
+#include "../deviceDirectoryJournal/DeviceDirectoryJournal.hpp"
+
+#include <string.h>
+
+// Row numbers in the directory's own lookup tables. Boards only have room for a few
+// hundred rows, so a byte is enough there.
+#ifdef NO_ARDUINO
+typedef word DeviceRowIndex;
+#else
+typedef byte DeviceRowIndex;
+#endif
 
 class DeviceDirectory
 {
@@ -14,6 +26,377 @@ private_testable:
 	word _deviceNameLength;
 	byte* _deviceNames = nullptr;
 	DeviceDirectoryRow* _devices = nullptr;
+	uint32_t _version = 0;
+
+	// Rows are skipped by findNextDevice once their device has failed to respond this many times in a row,
+	// and cleared after the evict count. Only probes of suspended rows count towards eviction. Kept as
+	// separate columns, so the suspended check in scans reads one byte per row.
+	uint32_t* _lastSeen = nullptr;
+	byte* _failures = nullptr;
+	byte _suspendAfterFailures = 3;
+	byte _evictAfterFailures = 10;
+
+	// Open addressing hash index from device name to row, with linear probing. A slot holds a row plus one,
+	// or 0 if empty. It is kept up to date by insertIntoRow and clearDeviceDirectoryRow. Without it, names
+	// are found by scanning the rows.
+	DeviceRowIndex* _index = nullptr;
+	word _indexMask = 0;
+
+	// Rows in use, in ascending order, and a stack of the free ones with the position of each row in it.
+	// Scans only visit the live rows. Kept up to date once init is called; before that, rows are scanned
+	// up to the first one that was never used, and cleared rows in between are marked with deviceType 1.
+	static const DeviceRowIndex _notFree = (DeviceRowIndex)~0;
+	bool _rowsTracked = false;
+	DeviceRowIndex* _liveRows = nullptr;
+	word _liveCount = 0;
+	DeviceRowIndex* _freeRows = nullptr;
+	DeviceRowIndex* _freePositions = nullptr;
+	word _freeCount = 0;
+
+	// Every change to a row is appended to the journal, if there is one
+	DeviceDirectoryJournal* _journal = nullptr;
+
+	// Posting lists through the live rows, in row order: one per data collector timescale, one for data
+	// transmitters, one for time servers, and one per slave ID. A row that leaves a list keeps its next
+	// link and its list number, so a scan that was on it can carry on after the row is cleared. That only
+	// holds until the next insert: findFreeRow hands out the most recently freed row first, and linking it
+	// into its new lists would send the scan wherever it went. Cursors have to start over after an insert.
+	static const DeviceRowIndex _noRow = (DeviceRowIndex)~0;
+	static const byte _transmitterList = 8;
+	static const byte _timeServerList = 9;
+	static const byte _numRoleLists = 10;
+	static const byte _noList = 0xFF;
+	DeviceRowIndex _roleHeads[_numRoleLists];
+	DeviceRowIndex* _slaveHeads = nullptr;
+	byte* _roleLists = nullptr;
+	DeviceRowIndex* _roleNext = nullptr;
+	DeviceRowIndex* _rolePrev = nullptr;
+	DeviceRowIndex* _slaveNext = nullptr;
+	DeviceRowIndex* _slavePrev = nullptr;
+
+	// One bit per slave ID (0 to 246), set while a row has that ID. Kept up to date with the rows;
+	// before init, findFreeSlaveID builds it from the rows. Reserved IDs and IDs outside the pool are never handed out.
+	static const byte _slaveIdBitmapSize = 32;
+	byte _usedSlaveIds[_slaveIdBitmapSize] = {};
+	byte _reservedSlaveIds[_slaveIdBitmapSize] = {};
+	// IDs of slaves whose devices were evicted. The slave itself still has the ID, so it isn't handed out
+	// again until the master has told that slave to go back to discovery.
+	byte _quarantinedSlaveIds[_slaveIdBitmapSize] = {};
+	byte _firstPoolSlaveId = 2;
+	byte _lastPoolSlaveId = 246;
+
+	static bool getSlaveIdBit(byte* bitmap, byte slaveId)
+	{
+		return (bitmap[slaveId >> 3] >> (slaveId & 7)) & 1;
+	}
+
+	static void setSlaveIdBit(byte* bitmap, byte slaveId, bool value)
+	{
+		if (value)
+			bitmap[slaveId >> 3] |= (byte)(1 << (slaveId & 7));
+		else
+			bitmap[slaveId >> 3] &= (byte)~(1 << (slaveId & 7));
+	}
+
+	// Clears the bit of a slave ID that was just removed from a row, unless another row still has it
+	void releaseSlaveId(byte slaveId)
+	{
+		if (!_rowsTracked || slaveId == 0)
+			return;
+		for (word i = 0; i < _liveCount; i++)
+		{
+			if (_devices[_liveRows[i]].slaveId == slaveId)
+				return;
+		}
+		setSlaveIdBit(_usedSlaveIds, slaveId, false);
+	}
+
+	// Position of the first live row at or after row
+	word findLivePosition(int row)
+	{
+		word low = 0;
+		word high = _liveCount;
+		while (low < high)
+		{
+			word middle = (low + high) / 2;
+			if (_liveRows[middle] < row)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+		return low;
+	}
+
+	void markLive(int row)
+	{
+		DeviceRowIndex freePosition = _freePositions[row];
+		if (freePosition == _notFree)
+			return;
+		DeviceRowIndex last = _freeRows[--_freeCount];
+		_freeRows[freePosition] = last;
+		_freePositions[last] = freePosition;
+		_freePositions[row] = _notFree;
+
+		word position = findLivePosition(row);
+		for (word i = _liveCount; i > position; i--)
+		{
+			_liveRows[i] = _liveRows[i - 1];
+		}
+		_liveRows[position] = (DeviceRowIndex)row;
+		_liveCount++;
+	}
+
+	void markFree(int row)
+	{
+		if (_freePositions[row] != _notFree)
+			return;
+		word position = findLivePosition(row);
+		for (word i = position; i + 1 < _liveCount; i++)
+		{
+			_liveRows[i] = _liveRows[i + 1];
+		}
+		_liveCount--;
+		_freePositions[row] = (DeviceRowIndex)_freeCount;
+		_freeRows[_freeCount++] = (DeviceRowIndex)row;
+	}
+
+	static byte getRoleList(word deviceType)
+	{
+		bool accumulateData;
+		TimeScale timeScale;
+		byte dataSize;
+		if (DataCollectorDevice::getParametersFromDataCollectorDeviceType(deviceType, accumulateData, timeScale, dataSize))
+			return (byte)timeScale;
+		if (Device::isDataTransmitterDeviceType(deviceType))
+			return _transmitterList;
+		if (Device::isTimeServerDeviceType(deviceType))
+			return _timeServerList;
+		return _noList;
+	}
+
+	void linkRow(DeviceRowIndex &head, DeviceRowIndex* next, DeviceRowIndex* prev, int row)
+	{
+		DeviceRowIndex before = _noRow;
+		DeviceRowIndex after = head;
+		while (after != _noRow && after < row)
+		{
+			before = after;
+			after = next[after];
+		}
+		next[row] = after;
+		prev[row] = before;
+		if (before == _noRow)
+			head = (DeviceRowIndex)row;
+		else
+			next[before] = (DeviceRowIndex)row;
+		if (after != _noRow)
+			prev[after] = (DeviceRowIndex)row;
+	}
+
+	void unlinkRow(DeviceRowIndex &head, DeviceRowIndex* next, DeviceRowIndex* prev, int row)
+	{
+		if (prev[row] == _noRow)
+			head = next[row];
+		else
+			next[prev[row]] = next[row];
+		if (next[row] != _noRow)
+			prev[next[row]] = prev[row];
+	}
+
+	void linkPostings(int row)
+	{
+		_roleLists[row] = getRoleList(_devices[row].deviceType);
+		if (_roleLists[row] != _noList)
+			linkRow(_roleHeads[_roleLists[row]], _roleNext, _rolePrev, row);
+		linkRow(_slaveHeads[_devices[row].slaveId], _slaveNext, _slavePrev, row);
+	}
+
+	void unlinkPostings(int row, byte slaveId)
+	{
+		if (_roleLists[row] != _noList)
+			unlinkRow(_roleHeads[_roleLists[row]], _roleNext, _rolePrev, row);
+		unlinkRow(_slaveHeads[slaveId], _slaveNext, _slavePrev, row);
+	}
+
+	bool isLive(int row)
+	{
+		return _rowsTracked && _freePositions[row] == _notFree;
+	}
+
+	// Follows a posting list from a cursor: 0 to start at head, then one past the row last returned,
+	// and -1 once the list is done
+	DeviceDirectoryRow* findNextInList(DeviceRowIndex head, DeviceRowIndex* next, byte* &devName, int &cursor, bool includeSuspended)
+	{
+		DeviceRowIndex row = cursor == 0 ? head : next[cursor - 1];
+		// Rows cleared since the scan passed them are still linked from the rows before
+		while (row != _noRow && (!isLive(row) || (!includeSuspended && isSuspended(row))))
+			row = next[row];
+		if (row == _noRow)
+		{
+			cursor = -1;
+			return nullptr;
+		}
+		devName = getDeviceName(row);
+		cursor = row + 1;
+		return _devices + row;
+	}
+
+	word countLiveRows()
+	{
+		if (_rowsTracked)
+			return _liveCount;
+		word count = 0;
+		for (int row = 0; row < _maxDevices; row++)
+		{
+			if (_devices[row].slaveId != 0)
+				count++;
+		}
+		return count;
+	}
+
+	// One record per change, or a checkpoint of every live row once the journal needs one
+	void journalChange(JournalOp op, int row)
+	{
+		if (_journal == nullptr)
+			return;
+		if (_journal->needsCheckpoint(countLiveRows()))
+			writeJournalCheckpoint();
+		else
+			_journal->append(op, (word)row, getDeviceName(row), _devices[row]);
+	}
+
+	void writeJournalCheckpoint()
+	{
+		if (!_journal->beginCheckpoint(countLiveRows()))
+			return;
+		for (int row = 0; row < _maxDevices; row++)
+		{
+			if (_devices[row].slaveId != 0 && !_journal->appendCheckpointRow((word)row, getDeviceName(row), _devices[row]))
+				return;
+		}
+	}
+
+	void moveRow(int from, int to)
+	{
+		unlinkPostings(from, _devices[from].slaveId);
+		removeFromIndex(from);
+		byte* fromName = getDeviceName(from);
+		byte* toName = getDeviceName(to);
+		for (int i = 0; i < _deviceNameLength; i++)
+			toName[i] = fromName[i];
+		_devices[to] = _devices[from];
+		_devices[from] = DeviceDirectoryRow();
+		if (_failures != nullptr)
+		{
+			_lastSeen[to] = _lastSeen[from];
+			_failures[to] = _failures[from];
+			resetLiveness(from);
+		}
+		markFree(from);
+		markLive(to);
+		linkPostings(to);
+		addToIndex(to);
+		journalChange(JournalOp::put, to);
+		journalChange(JournalOp::clear, from);
+	}
+
+	word hashName(byte* name)
+	{
+		// FNV-1a
+		uint32_t hash = 2166136261UL;
+		for (int i = 0; i < _deviceNameLength; i++)
+		{
+			hash ^= name[i];
+			hash *= 16777619UL;
+		}
+		return (word)(hash ^ (hash >> 16)) & _indexMask;
+	}
+
+	bool nameEquals(word deviceIndex, byte* name)
+	{
+		return memcmp(getDeviceName(deviceIndex), name, _deviceNameLength) == 0;
+	}
+
+	void initIndex()
+	{
+		if (_index != nullptr)
+		{
+			delete[] _index;
+			_index = nullptr;
+		}
+		if (_maxDevices >= (DeviceRowIndex)~0)
+			return;
+		// At most 2/3 full
+		uint32_t slots = 1;
+		while (slots < (uint32_t)_maxDevices + _maxDevices / 2 + 1)
+			slots <<= 1;
+		if (slots > 0x10000)
+			return;
+		_indexMask = (word)(slots - 1);
+		_index = new DeviceRowIndex[slots];
+		for (uint32_t i = 0; i < slots; i++)
+		{
+			_index[i] = 0;
+		}
+	}
+
+	void addToIndex(int row)
+	{
+		if (_index == nullptr)
+			return;
+		word slot = hashName(getDeviceName(row));
+		while (_index[slot] != 0)
+			slot = (slot + 1) & _indexMask;
+		_index[slot] = (DeviceRowIndex)(row + 1);
+	}
+
+	// Uses the name still stored in the row to find its slot. Entries after it are moved back,
+	// so no probe sequence is broken and no tombstones are needed.
+	void removeFromIndex(int row)
+	{
+		if (_index == nullptr)
+			return;
+		word slot = hashName(getDeviceName(row));
+		while (_index[slot] != (DeviceRowIndex)(row + 1))
+		{
+			if (_index[slot] == 0)
+				return;
+			slot = (slot + 1) & _indexMask;
+		}
+		word next = slot;
+		while (true)
+		{
+			next = (next + 1) & _indexMask;
+			if (_index[next] == 0)
+				break;
+			word home = hashName(getDeviceName(_index[next] - 1));
+			// Move the entry back unless its home slot lies cyclically in (slot, next]
+			if (((next - home) & _indexMask) >= ((next - slot) & _indexMask))
+			{
+				_index[slot] = _index[next];
+				slot = next;
+			}
+		}
+		_index[slot] = 0;
+	}
+
+	int getRowIndex(DeviceDirectoryRow* device)
+	{
+		if (_devices == nullptr || device < _devices || device >= _devices + _maxDevices)
+			return -1;
+		return (int)(device - _devices);
+	}
+
+	bool isSuspended(int row)
+	{
+		return _failures != nullptr && _failures[row] >= _suspendAfterFailures;
+	}
+
+	void resetLiveness(int row)
+	{
+		_lastSeen[row] = 0;
+		_failures[row] = 0;
+	}
 
 	virtual byte* getDeviceName(word deviceIndex)
 	{
@@ -43,15 +426,133 @@ public:
 		_maxDevices = maxDevices;
 		_devices = new DeviceDirectoryRow[_maxDevices];
 		_deviceNames = new byte[_deviceNameLength * _maxDevices];
+		_lastSeen = new uint32_t[_maxDevices];
+		_failures = new byte[_maxDevices];
 		for (int i = 0; i < _maxDevices; i++)
 		{
 			_devices[i] = DeviceDirectoryRow();
+			resetLiveness(i);
+		}
+		initIndex();
+		for (byte i = 0; i < _slaveIdBitmapSize; i++)
+		{
+			_usedSlaveIds[i] = 0;
+			_quarantinedSlaveIds[i] = 0;
+		}
+		initRows();
+	}
+
+	void initRows()
+	{
+		_rowsTracked = false;
+		clearRows();
+		if (_maxDevices >= _notFree)
+			return;
+		_liveRows = new DeviceRowIndex[_maxDevices];
+		_freeRows = new DeviceRowIndex[_maxDevices];
+		_freePositions = new DeviceRowIndex[_maxDevices];
+		_roleLists = new byte[_maxDevices];
+		_roleNext = new DeviceRowIndex[_maxDevices];
+		_rolePrev = new DeviceRowIndex[_maxDevices];
+		_slaveNext = new DeviceRowIndex[_maxDevices];
+		_slavePrev = new DeviceRowIndex[_maxDevices];
+		_slaveHeads = new DeviceRowIndex[256];
+		// Lowest rows on top of the stack
+		for (word i = 0; i < _maxDevices; i++)
+		{
+			_freeRows[i] = (DeviceRowIndex)(_maxDevices - 1 - i);
+			_freePositions[_maxDevices - 1 - i] = (DeviceRowIndex)i;
+			_roleLists[i] = _noList;
+		}
+		for (byte i = 0; i < _numRoleLists; i++)
+		{
+			_roleHeads[i] = _noRow;
+		}
+		for (word i = 0; i < 256; i++)
+		{
+			_slaveHeads[i] = _noRow;
+		}
+		_liveCount = 0;
+		_freeCount = _maxDevices;
+		_rowsTracked = true;
+	}
+
+	void clearRows()
+	{
+		if (_liveRows != nullptr)
+			delete[] _liveRows;
+		if (_freeRows != nullptr)
+			delete[] _freeRows;
+		if (_freePositions != nullptr)
+			delete[] _freePositions;
+		if (_roleLists != nullptr)
+			delete[] _roleLists;
+		if (_roleNext != nullptr)
+			delete[] _roleNext;
+		if (_rolePrev != nullptr)
+			delete[] _rolePrev;
+		if (_slaveNext != nullptr)
+			delete[] _slaveNext;
+		if (_slavePrev != nullptr)
+			delete[] _slavePrev;
+		if (_slaveHeads != nullptr)
+			delete[] _slaveHeads;
+		_liveRows = nullptr;
+		_freeRows = nullptr;
+		_freePositions = nullptr;
+		_roleLists = nullptr;
+		_roleNext = nullptr;
+		_rolePrev = nullptr;
+		_slaveNext = nullptr;
+		_slavePrev = nullptr;
+		_slaveHeads = nullptr;
+	}
+
+	// Bytes init(deviceNameLength, maxDevices) allocates, matching initIndex and initRows
+	static uint32_t getMemoryUsage(word deviceNameLength, word maxDevices)
+	{
+		uint32_t perRow = sizeof(DeviceDirectoryRow) + deviceNameLength + sizeof(uint32_t) + sizeof(byte);
+		uint32_t usage = perRow * maxDevices;
+		if (maxDevices < (DeviceRowIndex)~0)
+		{
+			uint32_t slots = 1;
+			while (slots < (uint32_t)maxDevices + maxDevices / 2 + 1)
+				slots <<= 1;
+			if (slots <= 0x10000)
+				usage += slots * sizeof(DeviceRowIndex);
+		}
+		if (maxDevices < _notFree)
+		{
+			// Seven row tables, the role list bytes and the slave list heads
+			usage += (uint32_t)maxDevices * (7 * sizeof(DeviceRowIndex) + sizeof(byte));
+			usage += 256 * sizeof(DeviceRowIndex);
 		}
+		return usage;
 	}
 
+	// Picks the most rows whose tables all fit in maxMemory bytes. If the budget can't even hold the
+	// fixed tables, there are no rows.
 	virtual void init(int maxMemory, word deviceNameLength, word &maxDevicesOut)
 	{
-		maxDevicesOut = maxMemory / (sizeof(DeviceDirectoryRow) + deviceNameLength * sizeof(byte));
+		uint32_t budget = maxMemory < 0 ? 0 : (uint32_t)maxMemory;
+		uint32_t untrackedRowSize = sizeof(DeviceDirectoryRow) + deviceNameLength + sizeof(uint32_t) + sizeof(byte);
+		uint32_t rows = budget / untrackedRowSize;
+		if (rows > 0xFFFF)
+			rows = 0xFFFF;
+		// Rows past what the lookup tables can number need no tables, so a big enough budget gets
+		// more rows that way
+		if (rows < _notFree || getMemoryUsage(deviceNameLength, (word)rows) > budget)
+		{
+			uint32_t fixedSize = 256 * sizeof(DeviceRowIndex);
+			uint32_t trackedRowSize = untrackedRowSize + 7 * sizeof(DeviceRowIndex) + sizeof(byte);
+			rows = budget > fixedSize ? (budget - fixedSize) / trackedRowSize : 0;
+			if (rows >= _notFree)
+				rows = _notFree - 1;
+			// Only the hash index is left out of the row size above, so this steps down by its share
+			while (rows > 0 && getMemoryUsage(deviceNameLength, (word)rows) > budget)
+				rows--;
+		}
+		maxDevicesOut = (word)rows;
 		init(deviceNameLength, maxDevicesOut);
 	}
 
@@ -67,6 +568,33 @@ public:
 	virtual DeviceDirectoryRow* findDeviceForName(byte* devName, int &rowOut)
 	{
 		rowOut = -1;
+		if (_index != nullptr)
+		{
+			word slot = hashName(devName);
+			while (_index[slot] != 0)
+			{
+				int row = _index[slot] - 1;
+				if (_devices[row].slaveId != 0 && nameEquals(row, devName))
+				{
+					rowOut = row;
+					return _devices + row;
+				}
+				slot = (slot + 1) & _indexMask;
+			}
+			return nullptr;
+		}
+		if (_rowsTracked)
+		{
+			for (word i = 0; i < _liveCount; i++)
+			{
+				if (compareName(_liveRows[i], devName))
+				{
+					rowOut = _liveRows[i];
+					return _devices + rowOut;
+				}
+			}
+			return nullptr;
+		}
 		for (int i = 0; i < _maxDevices; i++)
 		{
 			if (_devices[i].slaveId == 0)
@@ -95,10 +623,35 @@ public:
 
 	virtual void insertIntoRow(int row, byte* devName, DeviceDirectoryRow device)
 	{
+		byte oldSlaveId = _devices[row].slaveId;
+		if (isLive(row))
+			unlinkPostings(row, oldSlaveId);
+		removeFromIndex(row);
 		byte* name = getDeviceName(row);
 		for (int i = 0; i < _deviceNameLength; i++)
 			name[i] = devName[i];
 		_devices[row] = device;
+		if (_failures != nullptr)
+			resetLiveness(row);
+		if (device.slaveId != 0)
+			addToIndex(row);
+		if (_rowsTracked)
+		{
+			if (device.slaveId != 0)
+			{
+				markLive(row);
+				linkPostings(row);
+				setSlaveIdBit(_usedSlaveIds, device.slaveId, true);
+			}
+			else
+			{
+				markFree(row);
+			}
+		}
+		if (oldSlaveId != device.slaveId)
+			releaseSlaveId(oldSlaveId);
+		_version++;
+		journalChange(JournalOp::put, row);
 	}
 
 	virtual bool updateItemInDeviceDirectory(byte* devName, DeviceDirectoryRow device)
@@ -115,7 +668,24 @@ public:
 
 	virtual void clearDeviceDirectoryRow(int row)
 	{
+		_version++;
+		if (isLive(row))
+			unlinkPostings(row, _devices[row].slaveId);
+		removeFromIndex(row);
+		byte oldSlaveId = _devices[row].slaveId;
 		_devices[row].slaveId = 0;
+		if (_failures != nullptr)
+			resetLiveness(row);
+		if (_rowsTracked)
+		{
+			// No markers needed, scans only visit live rows
+			_devices[row] = DeviceDirectoryRow();
+			markFree(row);
+			releaseSlaveId(oldSlaveId);
+			journalChange(JournalOp::clear, row);
+			return;
+		}
+		journalChange(JournalOp::clear, row);
 		bool devicesAbove = false;
 
 		if (row < _maxDevices - 1)
@@ -168,33 +738,105 @@ public:
 
 	virtual int findFreeRow()
 	{
+		if (_rowsTracked)
+			return _freeCount == 0 ? -1 : _freeRows[_freeCount - 1];
 		int row = 0;
-		while (_devices[row].slaveId != 0)
+		while (row < _maxDevices && _devices[row].slaveId != 0)
 			row++;
 		if (row >= _maxDevices)
 			return -1;
 		return row;
 	}
 
+	// Returns the lowest free ID in the pool, or 0 if there is none
 	virtual byte findFreeSlaveID()
 	{
-		byte slaveId = 2;
-		for (int i = 0; i < _maxDevices; i++)
+		byte built[_slaveIdBitmapSize];
+		byte* used = _usedSlaveIds;
+		if (!_rowsTracked)
 		{
-			if (_devices[i].slaveId == 0)
+			used = built;
+			for (byte i = 0; i < _slaveIdBitmapSize; i++)
 			{
-				if (_devices[i].deviceType == 0)
-					return slaveId;
+				built[i] = 0;
+			}
+			for (int i = 0; i < _maxDevices; i++)
+			{
+				if (_devices[i].slaveId == 0 && _devices[i].deviceType == 0)
+					break;
+				setSlaveIdBit(built, _devices[i].slaveId, true);
 			}
-			if (_devices[i].slaveId == slaveId)
+		}
+		for (word byteIndex = _firstPoolSlaveId >> 3; byteIndex <= (_lastPoolSlaveId >> 3); byteIndex++)
+		{
+			byte taken = used[byteIndex] | _reservedSlaveIds[byteIndex] | _quarantinedSlaveIds[byteIndex];
+			if (taken == 0xFF)
+				continue;
+			for (byte bit = 0; bit < 8; bit++)
 			{
-				slaveId++;
-				i = 0;
-				if (slaveId > 246)
-					return 0;
+				word slaveId = (byteIndex << 3) + bit;
+				if (slaveId >= _firstPoolSlaveId && slaveId <= _lastPoolSlaveId && !((taken >> bit) & 1))
+					return (byte)slaveId;
 			}
 		}
-		return slaveId;
+		return 0;
+	}
+
+	// Limits the IDs findFreeSlaveID hands out, for example to give each bus its own range. The pool
+	// can't include 1, since new slaves answer discovery at that ID.
+	bool setSlaveIdPool(byte firstSlaveId, byte lastSlaveId)
+	{
+		if (firstSlaveId < 2 || lastSlaveId > 246 || firstSlaveId > lastSlaveId)
+			return false;
+		_firstPoolSlaveId = firstSlaveId;
+		_lastPoolSlaveId = lastSlaveId;
+		return true;
+	}
+
+	// For IDs of slaves that are configured by hand
+	void reserveSlaveIds(byte firstSlaveId, byte lastSlaveId, bool reserved = true)
+	{
+		for (word slaveId = firstSlaveId; slaveId <= lastSlaveId && slaveId <= 246; slaveId++)
+		{
+			setSlaveIdBit(_reservedSlaveIds, (byte)slaveId, reserved);
+		}
+	}
+
+	bool isSlaveIdUsed(byte slaveId)
+	{
+		return _rowsTracked && getSlaveIdBit(_usedSlaveIds, slaveId);
+	}
+
+	bool isSlaveIdQuarantined(byte slaveId)
+	{
+		return getSlaveIdBit(_quarantinedSlaveIds, slaveId);
+	}
+
+	// Returns the lowest quarantined ID above afterSlaveId that no row has any more, or 0 if there is none.
+	// Those are the slaves that need to be sent back to discovery.
+	virtual byte findNextQuarantinedSlaveId(byte afterSlaveId)
+	{
+		for (word slaveId = afterSlaveId + 1; slaveId <= 246; slaveId++)
+		{
+			if (!getSlaveIdBit(_quarantinedSlaveIds, (byte)slaveId))
+				continue;
+			bool inUse = isSlaveIdUsed((byte)slaveId);
+			for (int i = 0; !_rowsTracked && !inUse && i < _maxDevices; i++)
+			{
+				if (_devices[i].slaveId == 0 && _devices[i].deviceType == 0)
+					break;
+				inUse = _devices[i].slaveId == slaveId;
+			}
+			if (!inUse)
+				return (byte)slaveId;
+		}
+		return 0;
+	}
+
+	// The slave that had this ID has been reset, or is known to be gone for good
+	virtual void releaseQuarantinedSlaveId(byte slaveId)
+	{
+		setSlaveIdBit(_quarantinedSlaveIds, slaveId, false);
 	}
 
 	virtual int addDevice(byte* devName, DeviceDirectoryRow device)
@@ -210,6 +852,28 @@ public:
 	{
 		int numDeleted = 0;
 		int ind;
+		if (_rowsTracked)
+		{
+			int cursor = 0;
+			byte* name;
+			while (cursor != -1)
+			{
+				auto device = findNextInList(_slaveHeads[slaveId], _slaveNext, name, cursor, true);
+				if (device == nullptr)
+					break;
+				bool found = false;
+				for (int k = 0; k < devNamesCount && !found; k++)
+				{
+					found = compareName(cursor - 1, devNames[k]);
+				}
+				if (!found)
+				{
+					clearDeviceDirectoryRow(cursor - 1);
+					numDeleted++;
+				}
+			}
+			return numDeleted;
+		}
 		for (int i = 0; i < _maxDevices; i++)
 		{
 			if (_devices[i].slaveId == 0 && _devices[i].deviceType == 0)
@@ -246,22 +910,228 @@ public:
 			return addDevice(devName, device);
 	}
 
+	// Skips suspended rows
 	virtual DeviceDirectoryRow* findNextDevice(byte* &devName, int &row)
 	{
-		while (_devices[row].slaveId == 0)
+		if (_rowsTracked)
 		{
-			if (_devices[row].deviceType == 0)
+			word position = findLivePosition(row);
+			while (position < _liveCount && isSuspended(_liveRows[position]))
+				position++;
+			if (position == _liveCount)
 			{
 				row = -1;
 				return nullptr;
 			}
+			row = _liveRows[position];
+			devName = getDeviceName(row);
+			row += 1;
+			return (_devices + row - 1);
+		}
+		while (row < _maxDevices && (_devices[row].slaveId == 0 || isSuspended(row)))
+		{
+			if (_devices[row].slaveId == 0 && _devices[row].deviceType == 0)
+				break;
 			row++;
 		}
+		if (row >= _maxDevices || _devices[row].slaveId == 0)
+		{
+			row = -1;
+			return nullptr;
+		}
 		devName = getDeviceName(row);
 		row += 1;
 		return (_devices + row - 1);
 	}
 
+	// Like findNextDevice, but only visits suspended rows
+	virtual DeviceDirectoryRow* findNextSuspendedDevice(byte* &devName, int &row)
+	{
+		if (_rowsTracked)
+		{
+			for (word position = findLivePosition(row); position < _liveCount; position++)
+			{
+				if (isSuspended(_liveRows[position]))
+				{
+					row = _liveRows[position];
+					devName = getDeviceName(row);
+					row += 1;
+					return (_devices + row - 1);
+				}
+			}
+			row = -1;
+			return nullptr;
+		}
+		while (row < _maxDevices && (_devices[row].slaveId != 0 || _devices[row].deviceType != 0))
+		{
+			if (_devices[row].slaveId != 0 && isSuspended(row))
+			{
+				devName = getDeviceName(row);
+				row += 1;
+				return (_devices + row - 1);
+			}
+			row++;
+		}
+		row = -1;
+		return nullptr;
+	}
+
+	// The device answered a request. A suspended row becomes live again.
+	virtual void recordDeviceResponse(DeviceDirectoryRow* device, uint32_t clock)
+	{
+		int row = getRowIndex(device);
+		if (row == -1 || _failures == nullptr)
+			return;
+		if (isSuspended(row))
+			_version++;
+		_lastSeen[row] = clock;
+		_failures[row] = 0;
+	}
+
+	// The device did not answer a request. Returns what became of its row.
+	virtual DeviceLivenessState recordDeviceNoResponse(DeviceDirectoryRow* device)
+	{
+		int row = getRowIndex(device);
+		if (row == -1 || _failures == nullptr)
+			return DeviceLivenessState::live;
+		if (_devices[row].slaveId == 0)
+			return DeviceLivenessState::evicted;
+		byte &failures = _failures[row];
+		if (failures < 255)
+			failures++;
+		if (failures >= _evictAfterFailures)
+		{
+			// Slaves configured by hand keep their reserved ID anyway
+			byte slaveId = _devices[row].slaveId;
+			if (!getSlaveIdBit(_reservedSlaveIds, slaveId))
+				setSlaveIdBit(_quarantinedSlaveIds, slaveId, true);
+			clearDeviceDirectoryRow(row);
+			return DeviceLivenessState::evicted;
+		}
+		if (failures >= _suspendAfterFailures)
+		{
+			if (failures == _suspendAfterFailures)
+				_version++;
+			return DeviceLivenessState::suspended;
+		}
+		return DeviceLivenessState::live;
+	}
+
+	virtual bool getDeviceLiveness(DeviceDirectoryRow* device, DeviceLiveness &livenessOut)
+	{
+		int row = getRowIndex(device);
+		if (row == -1 || _failures == nullptr)
+			return false;
+		livenessOut.lastSeen = _lastSeen[row];
+		livenessOut.failures = _failures[row];
+		return true;
+	}
+
+	void setJournal(DeviceDirectoryJournal* journal)
+	{
+		_journal = journal;
+	}
+
+	// Replays the journal into an empty directory, on boot. Returns false if there was nothing to replay.
+	bool restoreFromJournal()
+	{
+		if (_journal == nullptr)
+			return false;
+		auto journal = _journal;
+		_journal = nullptr;
+		bool restored = journal->recover();
+		JournalRecord record;
+		byte* name = new byte[_deviceNameLength];
+		while (restored && journal->nextReplayRecord(record, name))
+		{
+			if (record.op == JournalOp::checkpoint)
+			{
+				for (int row = 0; row < _maxDevices; row++)
+				{
+					if (_devices[row].slaveId != 0)
+						clearDeviceDirectoryRow(row);
+				}
+			}
+			else if (record.row < _maxDevices)
+			{
+				if (record.op == JournalOp::clear)
+					clearDeviceDirectoryRow(record.row);
+				else
+					insertIntoRow(record.row, name, record.device);
+			}
+		}
+		delete[] name;
+		_journal = journal;
+		if (_journal->needsCheckpoint(countLiveRows()))
+			writeJournalCheckpoint();
+		return restored;
+	}
+
+	void setLivenessThresholds(byte suspendAfterFailures, byte evictAfterFailures)
+	{
+		_suspendAfterFailures = suspendAfterFailures;
+		_evictAfterFailures = evictAfterFailures;
+	}
+
+	// The finders below visit only the rows they return, once init is called. Like findNextDevice, they
+	// take a cursor that starts at 0 and is -1 once there are no more, and skip suspended rows. Rows can
+	// be cleared between calls, but a cursor is no longer valid once a row has been inserted.
+	virtual DeviceDirectoryRow* findNextTransmitter(byte* &devName, int &cursor)
+	{
+		if (_rowsTracked)
+			return findNextInList(_roleHeads[_transmitterList], _roleNext, devName, cursor, false);
+		DeviceDirectoryRow* device;
+		while ((device = findNextDevice(devName, cursor)) != nullptr && !Device::isDataTransmitterDeviceType(device->deviceType));
+		return device;
+	}
+
+	virtual DeviceDirectoryRow* findNextTimeServer(byte* &devName, int &cursor)
+	{
+		if (_rowsTracked)
+			return findNextInList(_roleHeads[_timeServerList], _roleNext, devName, cursor, false);
+		DeviceDirectoryRow* device;
+		while ((device = findNextDevice(devName, cursor)) != nullptr && !Device::isTimeServerDeviceType(device->deviceType));
+		return device;
+	}
+
+	// Data collectors with a timescale in the range, visited one timescale at a time
+	virtual DeviceDirectoryRow* findNextCollector(byte* &devName, int &cursor, TimeScale minTimeScale, TimeScale maxTimeScale)
+	{
+		if (!_rowsTracked)
+		{
+			DeviceDirectoryRow* device;
+			while ((device = findNextDevice(devName, cursor)) != nullptr)
+			{
+				byte list = getRoleList(device->deviceType);
+				if (list >= (byte)minTimeScale && list <= (byte)maxTimeScale)
+					break;
+			}
+			return device;
+		}
+		byte list = cursor == 0 ? (byte)minTimeScale : _roleLists[cursor - 1];
+		if (list > (byte)maxTimeScale)
+		{
+			cursor = -1;
+			return nullptr;
+		}
+		while (true)
+		{
+			auto device = findNextInList(_roleHeads[list], _roleNext, devName, cursor, false);
+			if (device != nullptr || ++list > (byte)maxTimeScale)
+				return device;
+			cursor = 0;
+		}
+	}
+
+	virtual DeviceDirectoryRow* findNextDeviceForSlave(byte slaveId, byte* &devName, int &cursor)
+	{
+		if (_rowsTracked)
+			return findNextInList(_slaveHeads[slaveId], _slaveNext, devName, cursor, false);
+		DeviceDirectoryRow* device;
+		while ((device = findNextDevice(devName, cursor)) != nullptr && device->slaveId != slaveId);
+		return device;
+	}
+
 	// Untested
 	virtual DeviceDirectoryRow* findNextDevice(int &row)
 	{
@@ -269,17 +1139,54 @@ public:
 		return findNextDevice(dummy, row);
 	}
 
+	// Changes whenever a row is written or cleared
+	uint32_t getVersion()
+	{
+		return _version;
+	}
+
 	// Untested
 	bool isEmpty()
 	{
+		if (_rowsTracked)
+			return _liveCount == 0;
 		return _devices[0].slaveId == 0 && _devices[0].deviceType == 0;
 	}
 
+	// Moves devices from the highest rows into the lowest free ones, at most maxMoves of them, so the
+	// live rows end up packed at the start. Row pointers and cursors from before are no longer valid,
+	// so only call this between scans. Returns the number of rows moved.
+	virtual word compact(word maxMoves)
+	{
+		if (!_rowsTracked)
+			return 0;
+		word moved = 0;
+		while (moved < maxMoves && _liveCount > 0 && _liveRows[_liveCount - 1] >= _liveCount)
+		{
+			// The lowest free row is the first gap in the live rows
+			word to = 0;
+			while (_liveRows[to] == to)
+				to++;
+			moveRow(_liveRows[_liveCount - 1], to);
+			moved++;
+		}
+		if (moved > 0)
+			_version++;
+		return moved;
+	}
+
 	~DeviceDirectory()
 	{
 		if (_devices != nullptr)
 			delete [] _devices;
 		if (_deviceNames != nullptr)
 			delete [] _deviceNames;
+		if (_lastSeen != nullptr)
+			delete [] _lastSeen;
+		if (_failures != nullptr)
+			delete [] _failures;
+		if (_index != nullptr)
+			delete [] _index;
+		clearRows();
 	}
 };
\ No newline at end of file
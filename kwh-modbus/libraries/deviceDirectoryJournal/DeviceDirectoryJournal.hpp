@@ -0,0 +1,353 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+#include "../deviceDirectoryRow/DeviceDirectoryRow.h"
+
+// A region of EEPROM, flash or a file that the journal owns. Addresses start at 0.
+class JournalStorage
+{
+public:
+	virtual uint32_t getSize() = 0;
+	virtual bool read(uint32_t address, byte *data, word length) = 0;
+	virtual bool write(uint32_t address, byte *data, word length) = 0;
+};
+
+enum class JournalOp : byte
+{
+	// Starts a checkpoint. The row field is the number of checkpointPut records that follow.
+	checkpoint = 1,
+	checkpointPut = 2,
+	put = 3,
+	clear = 4
+};
+
+struct JournalRecord
+{
+	uint32_t sequence = 0;
+	JournalOp op = (JournalOp)0;
+	word row = 0;
+	DeviceDirectoryRow device;
+};
+
+// Append-only log of device directory changes, written round robin through the storage so every cell
+// wears at the same rate. Each change is one fixed-size record with a sequence number and a CRC, and
+// record n lives in slot n % capacity. A checkpoint writes every live row again, after which the
+// records before it can be overwritten. On boot, the newest complete checkpoint and everything after
+// it are replayed. A record torn by a reset fails its CRC, and replay stops before it.
+class DeviceDirectoryJournal
+{
+private_testable:
+	static const byte _headerSize = 14;
+	static const byte _crcSize = 2;
+
+	JournalStorage *_storage = nullptr;
+	word _deviceNameLength = 0;
+	word _maxDevices = 0;
+	word _recordSize = 0;
+	uint32_t _capacity = 0;
+	byte *_recordBuffer = nullptr;
+
+	// Sequence number of the next record, and of the newest complete checkpoint
+	uint32_t _nextSequence = 1;
+	uint32_t _checkpointSequence = 0;
+	uint32_t _pendingCheckpoint = 0;
+	word _pendingCheckpointPuts = 0;
+	bool _checkpointDue = false;
+
+	uint32_t _replaySequence = 0;
+	uint32_t _replayCheckpointEnd = 0;
+	uint32_t _replayEnd = 0;
+	uint32_t _writeFailures = 0;
+
+	static word crc16(byte *data, word length)
+	{
+		// CRC-16/MODBUS, bit by bit to keep tables out of RAM
+		word crc = 0xFFFF;
+		for (word i = 0; i < length; i++)
+		{
+			crc ^= data[i];
+			for (byte b = 0; b < 8; b++)
+			{
+				if (crc & 1)
+					crc = (crc >> 1) ^ 0xA001;
+				else
+					crc >>= 1;
+			}
+		}
+		return crc;
+	}
+
+	static void writeWord(byte *buffer, word value)
+	{
+		buffer[0] = (byte)value;
+		buffer[1] = (byte)(value >> 8);
+	}
+
+	static word readWord(byte *buffer)
+	{
+		return (word)buffer[0] | ((word)buffer[1] << 8);
+	}
+
+	uint32_t getAddress(uint32_t sequence)
+	{
+		return (sequence % _capacity) * _recordSize;
+	}
+
+	bool writeRecord(JournalOp op, word row, byte *name, DeviceDirectoryRow device)
+	{
+		byte *buffer = _recordBuffer;
+		uint32_t sequence = _nextSequence;
+		buffer[0] = (byte)sequence;
+		buffer[1] = (byte)(sequence >> 8);
+		buffer[2] = (byte)(sequence >> 16);
+		buffer[3] = (byte)(sequence >> 24);
+		buffer[4] = (byte)op;
+		writeWord(buffer + 5, row);
+		buffer[7] = device.slaveId;
+		writeWord(buffer + 8, device.deviceNumber);
+		writeWord(buffer + 10, device.deviceType);
+		writeWord(buffer + 12, device.deviceRegs);
+		for (word i = 0; i < _deviceNameLength; i++)
+		{
+			buffer[_headerSize + i] = name == nullptr ? 0 : name[i];
+		}
+		writeWord(buffer + _recordSize - _crcSize, crc16(buffer, _recordSize - _crcSize));
+		if (!_storage->write(getAddress(sequence), buffer, _recordSize))
+		{
+			// The slot is written again by the next record, and the change this one was for is only
+			// saved by the next checkpoint
+			_writeFailures++;
+			_checkpointDue = true;
+			return false;
+		}
+		_nextSequence++;
+		return true;
+	}
+
+	// Reads the record in the slot for the sequence number, which is only valid if it has that number
+	bool readRecord(uint32_t sequence, JournalRecord &recordOut, byte *nameOut)
+	{
+		byte *buffer = _recordBuffer;
+		if (!_storage->read(getAddress(sequence), buffer, _recordSize))
+			return false;
+		if (readWord(buffer + _recordSize - _crcSize) != crc16(buffer, _recordSize - _crcSize))
+			return false;
+		recordOut.sequence = (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) |
+			((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+		if (recordOut.sequence != sequence)
+			return false;
+		recordOut.op = (JournalOp)buffer[4];
+		recordOut.row = readWord(buffer + 5);
+		recordOut.device = DeviceDirectoryRow(buffer[7], readWord(buffer + 8), readWord(buffer + 10), readWord(buffer + 12));
+		if (nameOut != nullptr)
+		{
+			for (word i = 0; i < _deviceNameLength; i++)
+			{
+				nameOut[i] = buffer[_headerSize + i];
+			}
+		}
+		return true;
+	}
+
+	// A checkpoint is complete if all of its puts follow it
+	bool isCompleteCheckpoint(JournalRecord &record, uint32_t newestSequence)
+	{
+		if (record.op != JournalOp::checkpoint || record.sequence + record.row > newestSequence)
+			return false;
+		JournalRecord put;
+		for (word i = 1; i <= record.row; i++)
+		{
+			if (!readRecord(record.sequence + i, put, nullptr) || put.op != JournalOp::checkpointPut)
+				return false;
+		}
+		return true;
+	}
+
+public:
+	// Room is kept for two checkpoints of every row, so one can be interrupted without losing the last
+	bool init(JournalStorage *storage, word deviceNameLength, word maxDevices)
+	{
+		clear();
+		_storage = storage;
+		_deviceNameLength = deviceNameLength;
+		_maxDevices = maxDevices;
+		_recordSize = getRecordSize(deviceNameLength);
+		_capacity = storage->getSize() / _recordSize;
+		if (_capacity < 3 * ((uint32_t)maxDevices + 2))
+		{
+			_storage = nullptr;
+			return false;
+		}
+		_recordBuffer = new byte[_recordSize];
+		return true;
+	}
+
+	void clear()
+	{
+		if (_recordBuffer != nullptr)
+		{
+			delete[] _recordBuffer;
+			_recordBuffer = nullptr;
+		}
+		_storage = nullptr;
+		_capacity = 0;
+		_nextSequence = 1;
+		_checkpointSequence = 0;
+		_pendingCheckpoint = 0;
+		_pendingCheckpointPuts = 0;
+		_checkpointDue = false;
+		_replaySequence = 0;
+		_replayCheckpointEnd = 0;
+		_replayEnd = 0;
+		_writeFailures = 0;
+	}
+
+	static word getRecordSize(word deviceNameLength)
+	{
+		return _headerSize + deviceNameLength + _crcSize;
+	}
+
+	// Finds the newest record and the newest complete checkpoint, and sets up replay from there.
+	// Returns false if there is nothing to replay.
+	bool recover()
+	{
+		if (_storage == nullptr)
+			return false;
+		JournalRecord record;
+		uint32_t newest = 0;
+		for (uint32_t slot = 0; slot < _capacity; slot++)
+		{
+			byte *buffer = _recordBuffer;
+			if (!_storage->read(slot * _recordSize, buffer, _recordSize) ||
+				readWord(buffer + _recordSize - _crcSize) != crc16(buffer, _recordSize - _crcSize))
+				continue;
+			uint32_t sequence = (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) |
+				((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+			if (sequence % _capacity == slot && sequence > newest)
+				newest = sequence;
+		}
+		_replaySequence = 0;
+		_replayEnd = 0;
+		if (newest == 0)
+		{
+			_nextSequence = 1;
+			_checkpointSequence = 0;
+			return false;
+		}
+		_nextSequence = newest + 1;
+		// Walk back through the unbroken run of records that ends at the newest one
+		uint32_t oldest = newest > _capacity ? newest - _capacity + 1 : 1;
+		for (uint32_t sequence = newest; sequence >= oldest; sequence--)
+		{
+			if (!readRecord(sequence, record, nullptr))
+				break;
+			if (isCompleteCheckpoint(record, newest))
+			{
+				_checkpointSequence = sequence;
+				_replaySequence = sequence;
+				_replayCheckpointEnd = sequence + record.row;
+				_replayEnd = newest;
+				return true;
+			}
+		}
+		_checkpointSequence = 0;
+		return false;
+	}
+
+	// Records in the order they should be applied. Puts of an interrupted checkpoint are skipped.
+	bool nextReplayRecord(JournalRecord &recordOut, byte *nameOut)
+	{
+		while (_replaySequence != 0 && _replaySequence <= _replayEnd)
+		{
+			uint32_t sequence = _replaySequence++;
+			if (!readRecord(sequence, recordOut, nameOut))
+				break;
+			if ((recordOut.op == JournalOp::checkpoint && sequence != _checkpointSequence) ||
+				(recordOut.op == JournalOp::checkpointPut && sequence > _replayCheckpointEnd))
+				continue;
+			return true;
+		}
+		_replaySequence = 0;
+		return false;
+	}
+
+	// True once the last complete checkpoint is about to be overwritten
+	bool needsCheckpoint(word liveRows)
+	{
+		if (_storage == nullptr)
+			return false;
+		if (_checkpointSequence == 0 || _checkpointDue)
+			return true;
+		return _nextSequence - _checkpointSequence + 2 * ((uint32_t)liveRows + 2) > _capacity;
+	}
+
+	bool append(JournalOp op, word row, byte *name, DeviceDirectoryRow device)
+	{
+		if (_storage == nullptr)
+			return false;
+		return writeRecord(op, row, name, device);
+	}
+
+	// Follow with numRows calls to appendCheckpointRow. A checkpoint with a failed write is abandoned,
+	// and the next call to needsCheckpoint returns true.
+	bool beginCheckpoint(word numRows)
+	{
+		if (_storage == nullptr)
+			return false;
+		_pendingCheckpoint = _nextSequence;
+		_pendingCheckpointPuts = 0;
+		if (!writeRecord(JournalOp::checkpoint, numRows, nullptr, DeviceDirectoryRow()))
+			return false;
+		_pendingCheckpointPuts = numRows;
+		if (numRows == 0)
+			finishCheckpoint();
+		return true;
+	}
+
+	bool appendCheckpointRow(word row, byte *name, DeviceDirectoryRow device)
+	{
+		if (_storage == nullptr || _pendingCheckpointPuts == 0)
+			return false;
+		if (!writeRecord(JournalOp::checkpointPut, row, name, device))
+		{
+			_pendingCheckpointPuts = 0;
+			return false;
+		}
+		if (--_pendingCheckpointPuts == 0)
+			finishCheckpoint();
+		return true;
+	}
+
+	void finishCheckpoint()
+	{
+		_checkpointSequence = _pendingCheckpoint;
+		_pendingCheckpoint = 0;
+		_checkpointDue = false;
+	}
+
+	bool isReady()
+	{
+		return _storage != nullptr;
+	}
+
+	uint32_t getCapacity()
+	{
+		return _capacity;
+	}
+
+	uint32_t getWriteFailures()
+	{
+		return _writeFailures;
+	}
+
+	~DeviceDirectoryJournal()
+	{
+		clear();
+	}
+};
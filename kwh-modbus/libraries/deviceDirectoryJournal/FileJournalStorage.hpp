@@ -0,0 +1,88 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+#include "DeviceDirectoryJournal.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+// Journal storage in a file, for masters that run on Linux or Windows. Every write is flushed.
+class FileJournalStorage : public JournalStorage
+{
+private_testable:
+	FILE *_file = nullptr;
+	uint32_t _size = 0;
+
+public:
+	// A missing or short file is filled out with 0xFF, like erased EEPROM
+	bool open(const char *path, uint32_t size)
+	{
+		close();
+		_file = fopen(path, "r+b");
+		if (_file == nullptr)
+			_file = fopen(path, "w+b");
+		if (_file == nullptr || fseek(_file, 0, SEEK_END) != 0)
+		{
+			close();
+			return false;
+		}
+		long length = ftell(_file);
+		byte blank[64];
+		memset(blank, 0xFF, sizeof(blank));
+		while (length >= 0 && (uint32_t)length < size)
+		{
+			uint32_t count = size - length < sizeof(blank) ? size - length : sizeof(blank);
+			if (fwrite(blank, 1, count, _file) != count)
+			{
+				close();
+				return false;
+			}
+			length += count;
+		}
+		fflush(_file);
+		_size = size;
+		return true;
+	}
+
+	void close()
+	{
+		if (_file != nullptr)
+		{
+			fclose(_file);
+			_file = nullptr;
+		}
+		_size = 0;
+	}
+
+	uint32_t getSize()
+	{
+		return _size;
+	}
+
+	bool read(uint32_t address, byte *data, word length)
+	{
+		if (_file == nullptr || address + length > _size || fseek(_file, address, SEEK_SET) != 0)
+			return false;
+		return fread(data, 1, length, _file) == length;
+	}
+
+	bool write(uint32_t address, byte *data, word length)
+	{
+		if (_file == nullptr || address + length > _size || fseek(_file, address, SEEK_SET) != 0)
+			return false;
+		if (fwrite(data, 1, length, _file) != length)
+			return false;
+		return fflush(_file) == 0;
+	}
+
+	~FileJournalStorage()
+	{
+		close();
+	}
+};
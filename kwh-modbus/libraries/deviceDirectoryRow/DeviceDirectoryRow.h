@@ -4,6 +4,9 @@
 #include "../../noArduino/ArduinoMacros.h"
 #endif
 
+// Packed, so a row takes 7 bytes rather than being padded to 8 on 32 and 64-bit targets. Fields
+// can be read and assigned as usual, but don't take non-const references or pointers to them.
+#pragma pack(push, 1)
 struct DeviceDirectoryRow
 {
 	byte slaveId;
@@ -27,6 +30,21 @@ struct DeviceDirectoryRow
 		deviceRegs = _deviceRegs;
 	}
 };
+#pragma pack(pop)
+
+// How reliably the device of a row has been answering. lastSeen is the clock when it last did.
+struct DeviceLiveness
+{
+	uint32_t lastSeen = 0;
+	byte failures = 0;
+};
+
+enum class DeviceLivenessState : byte
+{
+	live = 0,
+	suspended = 1,
+	evicted = 2
+};
 
 static bool operator==(const DeviceDirectoryRow& lhs, const DeviceDirectoryRow& rhs)
 {
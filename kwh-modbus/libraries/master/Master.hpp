@@ -13,7 +13,14 @@
 #include "../timeManager/TimeManager.h"
 #include "../deviceDirectoryRow/DeviceDirectoryRow.h"
 #include "../bitFunctions/BitFunctions.hpp"
+#include "../pageEncoding/PageEncoding.hpp"
 #include "../debugMacros/DebugMacros.h"
+#include "../dataPageCache/DataPageCache.hpp"
+#include "../dataArchive/DataArchive.h"
+#include "../transferScheduler/TransferScheduler.hpp"
+#include "../busTimeAccounting/BusTimeAccounting.hpp"
+#include "../backfillQueue/BackfillQueue.hpp"
+#include "../busPriorityBudget/BusPriorityBudget.hpp"
 
 #define ENSURE(statement) if (!(statement)) return false
 #define ENSURE_NONMALFUNCTION(modbus_task) if (modbus_task.result() != success && modbus_task.result() != noResponse) \
@@ -21,6 +28,11 @@
 	reportMalfunction(__LINE__); \
 	return true; \
 }
+#define ENSURE_NONMALFUNCTION_RESULT(modbus_task, failure_result) if (modbus_task.result() != success && modbus_task.result() != noResponse) \
+{ \
+	reportMalfunction(__LINE__); \
+	RESULT_ASYNC(ModbusRequestStatus, failure_result); \
+}
 
 enum SearchResultCode : byte
 {
@@ -46,15 +58,47 @@ class Master : public TimeManager
 {
 private_testable:
 	const byte _majorVersion = 1;
-	const byte _minorVersion = 0;
+	const byte _minorVersion = 1;
 	bool _timeUpdatePending = false;
 	byte *_dataBuffer = nullptr;
 	word *_registerBuffer;
-	byte _dataBufferSize;
-	byte _registerBufferSize;
+	word _dataBufferSize;
+	word _registerBufferSize;
 
 	word _maxTransferSize = 150;
 
+	bool _broadcastDataDistribution = false;
+	word _broadcastTransferId = 0;
+
+	DataPageCache *_dataCache = nullptr;
+	byte *_cacheNameBuffer = nullptr;
+
+	DataArchive *_dataArchive = nullptr;
+
+	TransferScheduler _transferScheduler;
+	uint32_t _transferSyncInterval = 4;
+
+	BusTimeAccounting _busTime;
+	BusTimeCategory _busTimeCategory = BusTimeCategory::collection;
+	unsigned long _busRequestStart = 0;
+
+	BackfillQueue _backfillQueue;
+	unsigned long _backfillInterval = 1000000;
+	unsigned long _lastBackfillTime = 0;
+
+	BusPriorityBudget _priorityBudget;
+	BusPriority _busPriority = BusPriority::liveData;
+	// Only work started by loop can be preempted; anything else runs to completion
+	bool _preemptible = false;
+	// Where the last read stopped if it was preempted, 0 if it finished
+	uint32_t _preemptedAt = 0;
+	uint32_t _clockLastUpdated = 0;
+
+	// Where the search for the next suspended device to probe picks up
+	int _probeRow = 0;
+	// Last quarantined slave ID that was sent back to discovery
+	byte _quarantineProbeId = 0;
+
 	uint32_t lastUpdateTimes[8];
 
 	D *_deviceDirectory;
@@ -70,11 +114,81 @@ protected_testable:
 		//Serial.println(line);
 	}
 
-	static inline word calculateMaxPointsPerReadPage(byte dataBufferSize, byte registerBufferSize, byte dataSize)
+	static inline word calculateMaxPointsPerReadPage(word dataBufferSize, word registerBufferSize, byte dataSize,
+		byte headerRegisters = 7)
 	{
-		byte dataMax = dataBufferSize * 8 / dataSize;
-		byte registerMax = (registerBufferSize - 4) * 8 / dataSize;
-		return dataMax < registerMax ? dataMax : registerMax;
+		// Read response header is 7 registers, or 8 for devices with a page encoding
+		uint32_t dataMax = (uint32_t)dataBufferSize * 8 / dataSize;
+		uint32_t registerMax = (uint32_t)(registerBufferSize - headerRegisters) * 16 / dataSize;
+		uint32_t result = dataMax < registerMax ? dataMax : registerMax;
+		return result > 0xFFFF ? 0xFFFF : (word)result;
+	}
+
+	static inline word calculatePointsPerBroadcastPage(word registerBufferSize, byte dataSize)
+	{
+		// Header is 6 registers, same as a unicast data page
+		uint32_t points = (uint32_t)(registerBufferSize - 6) * 16 / dataSize;
+		if (points > 0xFFFF)
+			points = 0xFFFF;
+		// Keep pages a multiple of 4 so devices with smaller pages can split them evenly
+		if (points >= 4)
+			points = (points / 4) * 4;
+		return points;
+	}
+
+	// Bits set for each page of a broadcast transfer
+	static inline uint32_t getBroadcastPageMask(word numDataPoints, word pointsPerPage)
+	{
+		word numPages = numDataPoints / pointsPerPage + (numDataPoints % pointsPerPage != 0);
+		return numPages >= 32 ? 0xFFFFFFFF : ((uint32_t)1 << numPages) - 1;
+	}
+
+	// Fills registers 3 onward of a data page write (request 5 or 0x8005), and returns the total register count.
+	// Encoded pages fall back to raw when encoding doesn't make them any shorter.
+	word fillDataPageRegisters(byte dataSize, TimeScale timeScale, word page, word pointsInPage, word pointsPerPage, byte *data,
+		PageEncoding pageEncoding = PageEncoding::raw)
+	{
+		uint32_t bitsToCopy = (uint32_t)pointsInPage * dataSize;
+		uint32_t bitStart = (uint32_t)page * pointsPerPage * dataSize;
+		_registerBuffer[3] = pointsInPage;
+		_registerBuffer[5] = page;
+		if (pageEncoding != PageEncoding::raw && bitsToCopy > 0)
+		{
+			uint32_t encodedBits = PageEncoder::encode(pageEncoding, data, bitStart, pointsInPage, dataSize,
+				_registerBuffer, (uint32_t)96, bitsToCopy - 1);
+			if (encodedBits > 0)
+			{
+				word encodedRegs = BitFunctions::bitsToStructs<word, word>(encodedBits);
+				if ((uint32_t)encodedRegs * 16 > encodedBits)
+					BitFunctions::clearBits<word, uint32_t>(_registerBuffer, 96 + encodedBits, (uint32_t)encodedRegs * 16 - encodedBits);
+				_registerBuffer[4] = dataSize + ((word)pageEncoding << 6) + ((word)timeScale << 8);
+				return 6 + encodedRegs;
+			}
+		}
+		_registerBuffer[4] = dataSize + ((word)timeScale << 8);
+		// Zero out last buffer index for testing
+		_registerBuffer[BitFunctions::bitsToStructs<word, word>(bitsToCopy) + 5] = 0;
+		BitFunctions::copyBits<byte, word, uint32_t>(data, _registerBuffer, bitStart, 96, bitsToCopy);
+		return 6 + BitFunctions::bitsToStructs<word, word>(bitsToCopy);
+	}
+
+	// Transfers for a timescale happen once per period of that timescale, but no more often than the sync interval
+	virtual uint32_t getTransferPeriodForTimeScale(TimeScale timeScale)
+	{
+		uint32_t period = (TimeManager::getPeriodFromTimeScale(timeScale) + 999) / 1000;
+		if (period < _transferSyncInterval)
+			period = _transferSyncInterval;
+		return period;
+	}
+
+	// Schedules the first transfer of each timescale, offsetting each one by a second
+	// so that transfers of different timescales don't land in the same loop iteration
+	void scheduleTransfers(uint32_t currentClock)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			_transferScheduler.schedule((TimeScale)i, currentClock + _transferSyncInterval + i, getTransferPeriodForTimeScale((TimeScale)i));
+		}
 	}
 
 	virtual uint32_t getPollPeriodForTimeScale(TimeScale timeScale)
@@ -127,21 +241,25 @@ protected_testable:
 		{
 			RESULT_ASYNC(ModbusRequestStatus, masterFailure);
 		}
+		_busRequestStart = _system->micros();
 		while (!_modbus->work())
 		{
 			YIELD_ASYNC;
 		}
 		if (_modbus->getStatus() == TaskFullyAttempted)
 		{
+			recordBusTime(BusTimeAccounting::getReadRequestLength(), 0);
 			RESULT_ASYNC(ModbusRequestStatus, noResponse);
 		}
 		else if (_modbus->getStatus() != TaskComplete)
 		{
+			recordBusTime(BusTimeAccounting::getReadRequestLength(), 0);
 			RESULT_ASYNC(ModbusRequestStatus, taskFailure);
 		}
 		word finalRegCount;
 		if (_modbus->isReadRegsResponse(finalRegCount, dummy0))
 		{
+			recordBusTime(BusTimeAccounting::getReadRequestLength(), BusTimeAccounting::getReadResponseLength(finalRegCount));
 			if (finalRegCount == regCount)
 			{
 				RESULT_ASYNC(ModbusRequestStatus, success);
@@ -153,6 +271,7 @@ protected_testable:
 		}
 		else
 		{
+			recordBusTime(BusTimeAccounting::getReadRequestLength(), BusTimeAccounting::getExceptionResponseLength());
 			if (_modbus->isExceptionResponse(dummy1, dummy1))
 			{
 				RESULT_ASYNC(ModbusRequestStatus, exceptionResponse);
@@ -192,31 +311,37 @@ protected_testable:
 				RESULT_ASYNC(ModbusRequestStatus, masterFailure);
 			}
 		}
+		_busRequestStart = _system->micros();
 		while (!_modbus->work())
 		{
 			YIELD_ASYNC;
 		}
 		if (_modbus->getStatus() == TaskFullyAttempted)
 		{
+			recordBusTime(BusTimeAccounting::getWriteRequestLength(regCount), 0);
 			RESULT_ASYNC(ModbusRequestStatus, noResponse);
 		}
 		else if (_modbus->getStatus() != TaskComplete)
 		{
+			recordBusTime(BusTimeAccounting::getWriteRequestLength(regCount), 0);
 			_modbus->reset();
 			RESULT_ASYNC(ModbusRequestStatus, taskFailure);
 		}
 		if (recipientId == 0)
 		{
 			// broadcast, we will not receive a response
+			recordBusTime(BusTimeAccounting::getWriteRequestLength(regCount), 0);
 			RESULT_ASYNC(ModbusRequestStatus, success);
 		}
 		word finalRegCount;
 		if ((_modbus->isWriteRegResponse() && regCount == 1) || (_modbus->isWriteRegsResponse() && regCount != 1))
 		{
+			recordBusTime(BusTimeAccounting::getWriteRequestLength(regCount), BusTimeAccounting::getWriteResponseLength());
 			RESULT_ASYNC(ModbusRequestStatus, success);
 		}
 		else
 		{
+			recordBusTime(BusTimeAccounting::getWriteRequestLength(regCount), BusTimeAccounting::getExceptionResponseLength());
 			if (_modbus->isExceptionResponse(dummy, dummy))
 			{
 				RESULT_ASYNC(ModbusRequestStatus, exceptionResponse);
@@ -239,6 +364,7 @@ protected_testable:
 	virtual ASYNC_CLASS_FUNC(THIS_T, checkForNewSlaves, byte slaveId)
 	{
 		START_ASYNC;
+		_busTimeCategory = BusTimeCategory::discovery;
 		VERBOSE(checkForSlaves, P_TIME(); PRINT("checkForSlaves: slaveId = "); PRINTLN(slaveId));
 		completeModbusReadRegisters(slaveId, 0, 8);
 		AWAIT(_completeModbusReadRegisters);
@@ -288,6 +414,7 @@ protected_testable:
 		ASYNC_VAR(4, slaveRegisters);
 		ASYNC_VAR(5, initialSlaveId);
 		START_ASYNC;
+		_busTimeCategory = BusTimeCategory::discovery;
 		word regCount;
 		word *regs;
 		numDevices = 0;
@@ -297,16 +424,23 @@ protected_testable:
 			RETURN_ASYNC;
 		}
 		initialSlaveId = _modbus->getRecipientId();
+		if (regs[0] != 0)
+		{
+			// Not idle, so registers 1 to 4 aren't its version and device info. It might be showing a
+			// broadcast receipt. Leave it for a later pass.
+			RETURN_ASYNC;
+		}
 		numDevices = regs[2];
 		deviceNameLength = regs[3];
 		slaveRegisters = regs[4];
 		slaveId = _deviceDirectory->findFreeSlaveID();
-		if ((regs[1] >> 8 < 1) ||
+		if ((regs[1] < (word)(_majorVersion << 8 | _minorVersion)) ||
 			(numDevices == 0) ||
 			justReject ||
 			(slaveId == 0))
 		{
-			// first case: version of slave is less than 1.0
+			// first case: version of slave is less than 1.1, which added broadcasts and the
+			// deadband encoding
 			// reject slave due to version mismatch
 
 			// second case: reject slave due to no devices
@@ -349,6 +483,8 @@ protected_testable:
 				AWAIT(_completeModbusWriteRegisters);
 				ENSURE_NONMALFUNCTION(_completeModbusWriteRegisters);
 				_deviceDirectory->filterDevicesForSlave(nullptr, 0, slaveId);
+				if (_dataCache != nullptr)
+					_dataCache->removeDestinationsForSlave(slaveId);
 				RETURN_ASYNC;
 			}
 		}
@@ -367,7 +503,204 @@ protected_testable:
 		return _processNewSlave;
 	}
 
-	DEFINE_CLASS_TASK(THIS_T, sendDataToSlaves, void, VARS(int, DeviceDirectoryRow*, byte, byte), uint32_t, byte, TimeScale, word, byte*, byte*);
+	// Sends data to a single data transmitter device. Results in success if the device took the data, otherResponse
+	// if the device refused it, noResponse if the slave did not respond, and masterFailure if there was a malfunction.
+	DEFINE_CLASS_TASK(THIS_T, sendDataToDevice, ModbusRequestStatus, VARS(word, word), DeviceDirectoryRow*, uint32_t, byte, TimeScale, word, byte*, byte*);
+	sendDataToDevice_Task _sendDataToDevice;
+	virtual ASYNC_CLASS_FUNC(THIS_T, sendDataToDevice, DeviceDirectoryRow* device, uint32_t startTime,
+		byte dataSize, TimeScale timeScale, word numDataPoints, byte* name, byte* data)
+	{
+		ASYNC_VAR(0, curPage);
+		ASYNC_VAR(1, numPointsInPage);
+		word regCount;
+		word *regs;
+		START_ASYNC;
+		_busTimeCategory = BusTimeCategory::delivery;
+	begin_write:
+		_registerBuffer[0] = 1;
+		_registerBuffer[1] = 4;
+		_registerBuffer[2] = device->deviceNumber;
+		_registerBuffer[3] = _deviceDirectory->getDeviceNameLength();
+		_registerBuffer[4] = (word)startTime;
+		_registerBuffer[5] = (word)(startTime >> 16);
+		_registerBuffer[6] = dataSize + ((word)timeScale << 8);
+		_registerBuffer[7] = numDataPoints;
+		{
+			word curReg = 0;
+			for (int i = 0; i < _deviceDirectory->getDeviceNameLength(); i++)
+			{
+				if (i % 2 == 0)
+				{
+					curReg = name[i];
+				}
+				else
+				{
+					curReg += ((word)name[i] << 8);
+				}
+				if (i % 2 == 1 || i == _deviceDirectory->getDeviceNameLength() - 1)
+				{
+					_registerBuffer[8 + i / 2] = curReg;
+				}
+			}
+		}
+		completeModbusWriteRegisters(device->slaveId, 0,
+			9 + (_deviceDirectory->getDeviceNameLength() - 1) / 2, _registerBuffer);
+		AWAIT(_completeModbusWriteRegisters);
+
+		ENSURE_NONMALFUNCTION_RESULT(_completeModbusWriteRegisters, masterFailure);
+		if (_completeModbusWriteRegisters.result() == noResponse)
+		{
+			markDeviceNotResponding(device);
+			RESULT_ASYNC(ModbusRequestStatus, noResponse);
+		}
+		completeModbusReadRegisters(device->slaveId, 0, 3);
+		AWAIT(_completeModbusReadRegisters);
+		ENSURE_NONMALFUNCTION_RESULT(_completeModbusReadRegisters, masterFailure);
+		if (_completeModbusReadRegisters.result() == noResponse)
+		{
+			markDeviceNotResponding(device);
+			RESULT_ASYNC(ModbusRequestStatus, noResponse);
+		}
+		markDeviceResponded(device);
+		_modbus->isReadRegsResponse(regCount, regs);
+		if (regs[1] == 3)
+		{
+			broadcastTime();
+			_system->delayMicroseconds(10000);
+			goto begin_write;
+		}
+		else if (regs[1] == 0)
+		{
+			numPointsInPage = regs[2];
+			if (numDataPoints > 0 && numPointsInPage > 0)
+			{
+				for (curPage = 0;
+					curPage < numDataPoints / numPointsInPage + (numDataPoints % numPointsInPage != 0);
+					curPage++)
+				{
+					{
+						word curNumPoints = numPointsInPage;
+						if ((curPage + 1) * numPointsInPage > numDataPoints)
+						{
+							curNumPoints = numDataPoints % numPointsInPage;
+						}
+						_registerBuffer[0] = 1;
+						_registerBuffer[1] = 5;
+						_registerBuffer[2] = device->deviceNumber;
+						completeModbusWriteRegisters(device->slaveId, 0,
+							fillDataPageRegisters(dataSize, timeScale, curPage, curNumPoints, numPointsInPage, data,
+								Device::getPageEncodingFromDeviceType(device->deviceType)), _registerBuffer);
+					}
+					AWAIT(_completeModbusWriteRegisters);
+					ENSURE_NONMALFUNCTION_RESULT(_completeModbusWriteRegisters, masterFailure);
+					if (_completeModbusWriteRegisters.result() == noResponse)
+					{
+						// The rest of the transfer is lost, so callers must not count it as delivered
+						markDeviceNotResponding(device);
+						RESULT_ASYNC(ModbusRequestStatus, noResponse);
+					}
+					DEBUG(sendDataToSlaves, P_TIME(); PRINT("Transferred a page of data to device with slaveID = "); PRINT(device->slaveId); PRINT(", device# = "); PRINTLN(device->deviceNumber));
+				}
+			}
+			RESULT_ASYNC(ModbusRequestStatus, success);
+		}
+		else if (regs[1] > 4)
+		{
+			reportMalfunction(__LINE__);
+			RESULT_ASYNC(ModbusRequestStatus, masterFailure);
+		}
+		RESULT_ASYNC(ModbusRequestStatus, otherResponse);
+		END_ASYNC;
+	}
+	sendDataToDevice_Task& sendDataToDevice(DeviceDirectoryRow* device, uint32_t startTime,
+		byte dataSize, TimeScale timeScale, word numDataPoints, byte* name, byte* data)
+	{
+		CREATE_ASSIGN_CLASS_TASK(_sendDataToDevice, THIS_T, this, sendDataToDevice, device, startTime, dataSize, timeScale, numDataPoints, name, data);
+		return _sendDataToDevice;
+	}
+
+	DEFINE_CLASS_TASK(THIS_T, broadcastDataToSlaves, bool, VARS(word, word), uint32_t, byte, TimeScale, word, word, byte*, byte*);
+	broadcastDataToSlaves_Task _broadcastDataToSlaves;
+	virtual ASYNC_CLASS_FUNC(THIS_T, broadcastDataToSlaves, uint32_t startTime,
+		byte dataSize, TimeScale timeScale, word numDataPoints, word pointsPerPage, byte* name, byte* data)
+	{
+		ASYNC_VAR(0, curPage);
+		ASYNC_VAR(1, numPages);
+		START_ASYNC;
+		_busTimeCategory = BusTimeCategory::delivery;
+		numPages = numDataPoints / pointsPerPage + (numDataPoints % pointsPerPage != 0);
+		_broadcastTransferId++;
+		if (_broadcastTransferId == 0)
+			_broadcastTransferId = 1;
+		DEBUG(sendDataToSlaves, P_TIME(); PRINT("Broadcasting data, transfer ID = "); PRINT(_broadcastTransferId); PRINT(", pages = "); PRINTLN(numPages));
+		_registerBuffer[0] = 1;
+		_registerBuffer[1] = 0x8004;
+		_registerBuffer[2] = _broadcastTransferId;
+		_registerBuffer[3] = _deviceDirectory->getDeviceNameLength();
+		_registerBuffer[4] = (word)startTime;
+		_registerBuffer[5] = (word)(startTime >> 16);
+		_registerBuffer[6] = dataSize + ((word)timeScale << 8);
+		_registerBuffer[7] = numDataPoints;
+		_registerBuffer[8] = pointsPerPage;
+		{
+			word curReg = 0;
+			for (int i = 0; i < _deviceDirectory->getDeviceNameLength(); i++)
+			{
+				if (i % 2 == 0)
+				{
+					curReg = name[i];
+				}
+				else
+				{
+					curReg += ((word)name[i] << 8);
+				}
+				if (i % 2 == 1 || i == _deviceDirectory->getDeviceNameLength() - 1)
+				{
+					_registerBuffer[9 + i / 2] = curReg;
+				}
+			}
+		}
+		completeModbusWriteRegisters(0, 0, 10 + (_deviceDirectory->getDeviceNameLength() - 1) / 2, _registerBuffer);
+		AWAIT(_completeModbusWriteRegisters);
+		if (_completeModbusWriteRegisters.result() != success)
+		{
+			reportMalfunction(__LINE__);
+			RESULT_ASYNC(bool, false);
+		}
+		_system->delayMicroseconds(10000);
+		for (curPage = 0; curPage < numPages; curPage++)
+		{
+			{
+				word curNumPoints = pointsPerPage;
+				if ((curPage + 1) * pointsPerPage > numDataPoints)
+				{
+					curNumPoints = numDataPoints % pointsPerPage;
+				}
+				_registerBuffer[0] = 1;
+				_registerBuffer[1] = 0x8005;
+				_registerBuffer[2] = _broadcastTransferId;
+				completeModbusWriteRegisters(0, 0,
+					fillDataPageRegisters(dataSize, timeScale, curPage, curNumPoints, pointsPerPage, data), _registerBuffer);
+			}
+			AWAIT(_completeModbusWriteRegisters);
+			if (_completeModbusWriteRegisters.result() != success)
+			{
+				reportMalfunction(__LINE__);
+				RESULT_ASYNC(bool, false);
+			}
+			_system->delayMicroseconds(10000);
+		}
+		RESULT_ASYNC(bool, true);
+		END_ASYNC;
+	}
+	broadcastDataToSlaves_Task& broadcastDataToSlaves(uint32_t startTime,
+		byte dataSize, TimeScale timeScale, word numDataPoints, word pointsPerPage, byte* name, byte* data)
+	{
+		CREATE_ASSIGN_CLASS_TASK(_broadcastDataToSlaves, THIS_T, this, broadcastDataToSlaves, startTime, dataSize, timeScale, numDataPoints, pointsPerPage, name, data);
+		return _broadcastDataToSlaves;
+	}
+
+	DEFINE_CLASS_TASK(THIS_T, sendDataToSlaves, void, VARS(int, DeviceDirectoryRow*, word, word, uint32_t), uint32_t, byte, TimeScale, word, byte*, byte*);
 	sendDataToSlaves_Task _sendDataToSlaves;
 	virtual ASYNC_CLASS_FUNC(THIS_T, sendDataToSlaves, uint32_t startTime,
 		byte dataSize, TimeScale timeScale, word numDataPoints, byte* name, byte* data)
@@ -375,11 +708,13 @@ protected_testable:
 		ASYNC_VAR_INIT(0, deviceRow, 0);
 		ASYNC_VAR(1, device);
 		ASYNC_VAR(2, curPage);
-		ASYNC_VAR(3, numPointsInPage);
+		ASYNC_VAR_INIT(3, broadcastPointsPerPage, 0);
+		ASYNC_VAR(4, missingPages);
 		word regCount;
 		word *regs;
 		byte *dummyName;
 		START_ASYNC;
+		_busTimeCategory = BusTimeCategory::delivery;
 		if (8 + (_deviceDirectory->getDeviceNameLength() + 1) / 2 > _registerBufferSize)
 		{
 			reportMalfunction(__LINE__);
@@ -387,98 +722,94 @@ protected_testable:
 		}
 		DEBUG(sendDataToSlaves, P_TIME(); PRINT("Sending data to slaves from device: "); for (int i = 0; i < _deviceDirectory->getDeviceNameLength(); i++) { WRITE(name[i]); } PRINTLN(""));
 		VERBOSE(sendDataToSlaves, PRINT("startTime = "); PRINT(startTime); PRINT(" dataSize = "); PRINT(dataSize); PRINT(" numDataPoints = "); PRINTLN(numDataPoints));
+		if (_broadcastDataDistribution && numDataPoints > 0 && dataSize > 0 &&
+			9 + (_deviceDirectory->getDeviceNameLength() + 1) / 2 <= _registerBufferSize)
+		{
+			broadcastPointsPerPage = calculatePointsPerBroadcastPage(_registerBufferSize, dataSize);
+			if (broadcastPointsPerPage == 0 ||
+				numDataPoints / broadcastPointsPerPage + (numDataPoints % broadcastPointsPerPage != 0) > 32)
+			{
+				// Too many pages to acknowledge with a 32-bit receipt, so send to each slave individually
+				broadcastPointsPerPage = 0;
+			}
+			else
+			{
+				broadcastDataToSlaves(startTime, dataSize, timeScale, numDataPoints, broadcastPointsPerPage, name, data);
+				AWAIT(_broadcastDataToSlaves);
+				if (!_broadcastDataToSlaves.result())
+					broadcastPointsPerPage = 0;
+			}
+		}
 		while (deviceRow != -1)
 		{
-			device = _deviceDirectory->findNextDevice(dummyName, deviceRow);
+			device = _deviceDirectory->findNextTransmitter(dummyName, deviceRow);
 			if (device != nullptr)
 			{
 				if (Device::isDataTransmitterDeviceType(device->deviceType))
 				{
-				begin_write:
-					_registerBuffer[0] = 1;
-					_registerBuffer[1] = 4;
-					_registerBuffer[2] = device->deviceNumber;
-					_registerBuffer[3] = _deviceDirectory->getDeviceNameLength();
-					_registerBuffer[4] = (word)startTime;
-					_registerBuffer[5] = (word)(startTime >> 16);
-					_registerBuffer[6] = dataSize + ((word)timeScale << 8);
-					_registerBuffer[7] = numDataPoints;
+					if (broadcastPointsPerPage > 0)
 					{
-						word curReg = 0;
-						for (int i = 0; i < _deviceDirectory->getDeviceNameLength(); i++)
+						// Check which broadcast pages the slave received, and resend only the missing ones
+						completeModbusReadRegisters(device->slaveId, 0, 6);
+						AWAIT(_completeModbusReadRegisters);
+						ENSURE_NONMALFUNCTION(_completeModbusReadRegisters);
+						if (_completeModbusReadRegisters.result() == noResponse)
 						{
-							if (i % 2 == 0)
-							{
-								curReg = name[i];
-							}
-							else
-							{
-								curReg += ((word)name[i] << 8);
-							}
-							if (i % 2 == 1 || i == _deviceDirectory->getDeviceNameLength() - 1)
-							{
-								_registerBuffer[8 + i / 2] = curReg;
-							}
+							markDeviceNotResponding(device);
+							continue;
 						}
-					}
-					completeModbusWriteRegisters(device->slaveId, 0,
-						9 + (_deviceDirectory->getDeviceNameLength() - 1) / 2, _registerBuffer);
-					AWAIT(_completeModbusWriteRegisters);
-
-					ENSURE_NONMALFUNCTION(_completeModbusWriteRegisters);
-					if (_completeModbusReadRegisters.result() == noResponse)
-						continue;
-					completeModbusReadRegisters(device->slaveId, 0, 2);
-					AWAIT(_completeModbusReadRegisters);
-					ENSURE_NONMALFUNCTION(_completeModbusReadRegisters);
-					if (_completeModbusReadRegisters.result() == noResponse)
-						continue;
-					_modbus->isReadRegsResponse(regCount, regs);
-					if ((regs[1] & 0xFF) == 3)
-					{
-						broadcastTime();
-						_system->delayMicroseconds(10000);
-						goto begin_write;
-					}
-					else if ((regs[1] & 0xFF) == 0)
-					{
-						if (numDataPoints > 0)
+						_modbus->isReadRegsResponse(regCount, regs);
+						if (regs[0] == 11 && regs[1] == _broadcastTransferId &&
+							device->deviceNumber < 32 &&
+							((((uint32_t)regs[3] << 16) | regs[2]) & ((uint32_t)1 << device->deviceNumber)))
 						{
-							numPointsInPage = (byte)(regs[1] >> 8);
+							missingPages = ~(((uint32_t)regs[5] << 16) | regs[4]) &
+								getBroadcastPageMask(numDataPoints, broadcastPointsPerPage);
+							if (missingPages == 0)
+								continue;
 							for (curPage = 0;
-								curPage < numDataPoints / numPointsInPage + (numDataPoints % numPointsInPage != 0);
+								curPage < numDataPoints / broadcastPointsPerPage + (numDataPoints % broadcastPointsPerPage != 0);
 								curPage++)
 							{
+								if ((missingPages & ((uint32_t)1 << curPage)) == 0)
+									continue;
 								{
-									word curNumPoints = numPointsInPage;
-									if ((curPage + 1) * numPointsInPage > numDataPoints)
+									word curNumPoints = broadcastPointsPerPage;
+									if ((curPage + 1) * broadcastPointsPerPage > numDataPoints)
 									{
-										curNumPoints = numDataPoints % numPointsInPage;
+										curNumPoints = numDataPoints % broadcastPointsPerPage;
 									}
 									_registerBuffer[0] = 1;
-									_registerBuffer[1] = 5;
-									_registerBuffer[2] = device->deviceNumber;
-									_registerBuffer[3] = curNumPoints + ((word)dataSize << 8);
-									_registerBuffer[4] = (word)timeScale + ((word)curPage << 8);
-									// Zero out last buffer index for testing
-									_registerBuffer[BitFunctions::bitsToStructs<word, word>(curNumPoints * dataSize) + 4] = 0;
-									word bitsToCopy = curNumPoints * dataSize;
-									word bitStart = curPage * numPointsInPage * dataSize;
-									BitFunctions::copyBits<byte, word, word>(data, _registerBuffer, bitStart, 80, bitsToCopy);
+									_registerBuffer[1] = 0x8005;
+									_registerBuffer[2] = _broadcastTransferId;
 									completeModbusWriteRegisters(device->slaveId, 0,
-										5 + BitFunctions::bitsToStructs<word, word>(curNumPoints * dataSize), _registerBuffer);
+										fillDataPageRegisters(dataSize, timeScale, curPage, curNumPoints, broadcastPointsPerPage, data), _registerBuffer);
 								}
 								AWAIT(_completeModbusWriteRegisters);
 								ENSURE_NONMALFUNCTION(_completeModbusWriteRegisters);
-								DEBUG(sendDataToSlaves, P_TIME(); PRINT("Transferred a page of data to device with slaveID = "); PRINT(device->slaveId); PRINT(", device# = "); PRINTLN(device->deviceNumber));
+								DEBUG(sendDataToSlaves, P_TIME(); PRINT("Resent a missed broadcast page to slaveID = "); PRINTLN(device->slaveId));
+							}
+							// A page the slave can't take is dropped every time it is sent, so check the resent pages
+							// arrived, and send to the device on its own if they didn't
+							completeModbusReadRegisters(device->slaveId, 0, 6);
+							AWAIT(_completeModbusReadRegisters);
+							ENSURE_NONMALFUNCTION(_completeModbusReadRegisters);
+							if (_completeModbusReadRegisters.result() == noResponse)
+							{
+								markDeviceNotResponding(device);
+								continue;
 							}
+							_modbus->isReadRegsResponse(regCount, regs);
+							if (regs[0] == 11 && regs[1] == _broadcastTransferId &&
+								(~(((uint32_t)regs[5] << 16) | regs[4]) & getBroadcastPageMask(numDataPoints, broadcastPointsPerPage)) == 0)
+								continue;
+							DEBUG(sendDataToSlaves, P_TIME(); PRINT("Broadcast pages still missing, sending individually to slaveID = "); PRINTLN(device->slaveId));
 						}
 					}
-					else if ((regs[1] & 0xFF) > 4)
-					{
-						reportMalfunction(__LINE__);
-						return true;
-					}
+					sendDataToDevice(device, startTime, dataSize, timeScale, numDataPoints, name, data);
+					AWAIT(_sendDataToDevice);
+					if (_sendDataToDevice.result() == masterFailure)
+						RETURN_ASYNC;
 				}
 			}
 		}
@@ -491,7 +822,7 @@ protected_testable:
 		return _sendDataToSlaves;
 	}
 
-	DEFINE_CLASS_TASK(THIS_T, readAndSendDeviceData, void, VARS(bool, TimeScale, byte, uint32_t, word, byte, byte, byte, bool),
+	DEFINE_CLASS_TASK(THIS_T, readAndSendDeviceData, void, VARS(bool, TimeScale, byte, uint32_t, word, word, word, word, bool, PageEncoding, PageEncoding),
 		DeviceDirectoryRow*, word, byte*, uint32_t, uint32_t);
 	readAndSendDeviceData_Task _readAndSendDeviceData;
 	virtual ASYNC_CLASS_FUNC(THIS_T, readAndSendDeviceData, DeviceDirectoryRow* deviceRow, word deviceNameLength,
@@ -506,14 +837,17 @@ protected_testable:
 	ASYNC_VAR(6, curReadPage);
 	ASYNC_VAR(7, numPointsInReadPage);
 	ASYNC_VAR_INIT(8, notResponding, false);
+	ASYNC_VAR(9, pageEncoding);
+	ASYNC_VAR(10, payloadEncoding);
 	word regCount;
 	word *regs;
 	START_ASYNC;
+	_preemptedAt = 0;
 	DEBUG(readAndSendData, P_TIME(); PRINT("Reading data from device "); for (int i = 0; i < deviceNameLength; i++) { WRITE(deviceName[i]); } PRINTLN(""));
 	VERBOSE(readAndSendData, PRINT("startTime = "); PRINT(startTime); PRINT(" endTime = "); PRINTLN(endTime));
 	if (startTime == endTime)
 		RETURN_ASYNC;
-	if (DataCollectorDevice::getParametersFromDataCollectorDeviceType(deviceRow->deviceType, accumulateData, timeScale, dataSize))
+	if (DataCollectorDevice::getParametersFromDataCollectorDeviceType(deviceRow->deviceType, accumulateData, timeScale, dataSize, pageEncoding))
 	{
 		begin_read:
 		readStart = startTime;
@@ -524,14 +858,17 @@ protected_testable:
 		while (numReadPagesRemaining > 0)
 		{
 			numReadPagesRemaining--;
+			_busTimeCategory = BusTimeCategory::collection;
 			_registerBuffer[0] = 1;
 			_registerBuffer[1] = 3;
 			_registerBuffer[2] = deviceRow->deviceNumber;
 			_registerBuffer[3] = (word)startTime;
 			_registerBuffer[4] = (word)(startTime >> 16);
 			_registerBuffer[5] = numDataPoints;
-			_registerBuffer[6] = curReadPage + (calculateMaxPointsPerReadPage(_dataBufferSize, _registerBufferSize, dataSize) << 8);
-			completeModbusWriteRegisters(deviceRow->slaveId, 0, 7, _registerBuffer);
+			_registerBuffer[6] = curReadPage;
+			_registerBuffer[7] = calculateMaxPointsPerReadPage(_dataBufferSize, _registerBufferSize, dataSize,
+				pageEncoding == PageEncoding::raw ? 7 : 8);
+			completeModbusWriteRegisters(deviceRow->slaveId, 0, 8, _registerBuffer);
 			AWAIT(_completeModbusWriteRegisters);
 			ENSURE_NONMALFUNCTION(_completeModbusWriteRegisters);
 			if (_completeModbusWriteRegisters.result() == noResponse)
@@ -539,7 +876,7 @@ protected_testable:
 				notResponding = true;
 				goto not_responding;
 			}
-			completeModbusReadRegisters(deviceRow->slaveId, 0, 6);
+			completeModbusReadRegisters(deviceRow->slaveId, 0, pageEncoding == PageEncoding::raw ? 7 : 8);
 			AWAIT(_completeModbusReadRegisters);
 			ENSURE_NONMALFUNCTION(_completeModbusReadRegisters);
 			if (_completeModbusReadRegisters.result() == noResponse)
@@ -547,6 +884,7 @@ protected_testable:
 				notResponding = true;
 				goto not_responding;
 			}
+			markDeviceResponded(deviceRow);
 			_modbus->isReadRegsResponse(regCount, regs);
 			if (regs[0] != 3)
 			{
@@ -555,15 +893,37 @@ protected_testable:
 			}
 			if (regs[1] == 0)
 			{
-				numPointsInReadPage = (byte)regs[4];
-				curReadPage = (byte)regs[5];
-				numReadPagesRemaining = (byte)(regs[5] >> 8);
+				numPointsInReadPage = regs[4];
+				curReadPage = regs[5];
+				numReadPagesRemaining = regs[6];
 
 				if (numPointsInReadPage == 0)
 					RETURN_ASYNC;
+				if ((uint32_t)numPointsInReadPage * dataSize > (uint32_t)_dataBufferSize * 8)
+				{
+					reportMalfunction(__LINE__);
+					return true;
+				}
 
-				completeModbusReadRegisters(deviceRow->slaveId, 6,
-					BitFunctions::bitsToStructs<word, word>(numPointsInReadPage * dataSize));
+				if (pageEncoding == PageEncoding::raw)
+				{
+					payloadEncoding = PageEncoding::raw;
+					completeModbusReadRegisters(deviceRow->slaveId, 7,
+						BitFunctions::bitsToStructs<word, word>((uint32_t)numPointsInReadPage * dataSize));
+				}
+				else
+				{
+					// Register 7 holds the encoding the slave used for this page, and the payload length
+					payloadEncoding = (PageEncoding)(regs[7] >> 12);
+					if ((regs[7] & 0x0FFF) == 0 ||
+						(regs[7] & 0x0FFF) > BitFunctions::bitsToStructs<word, word>((uint32_t)numPointsInReadPage * dataSize) ||
+						(payloadEncoding != PageEncoding::raw && payloadEncoding != pageEncoding))
+					{
+						reportMalfunction(__LINE__);
+						return true;
+					}
+					completeModbusReadRegisters(deviceRow->slaveId, 8, regs[7] & 0x0FFF);
+				}
 				AWAIT(_completeModbusReadRegisters);
 				ENSURE_NONMALFUNCTION(_completeModbusReadRegisters);
 				if (_completeModbusReadRegisters.result() == noResponse)
@@ -572,13 +932,9 @@ protected_testable:
 					goto not_responding;
 				}
 				_modbus->isReadRegsResponse(regCount, regs);
+				if (payloadEncoding == PageEncoding::raw)
 				{
-					word numDataBytes = BitFunctions::bitsToBytes(numPointsInReadPage * dataSize);
-					if (numDataBytes > _dataBufferSize)
-					{
-						reportMalfunction(__LINE__);
-						return true;
-					}
+					word numDataBytes = BitFunctions::bitsToBytes((uint32_t)numPointsInReadPage * dataSize);
 					for (int i = 0; i < numDataBytes; i++)
 					{
 						if (i % 2 == 0)
@@ -587,13 +943,47 @@ protected_testable:
 							_dataBuffer[i] = (byte)(regs[i / 2] >> 8);
 					}
 				}
+				else if (!PageEncoder::decode(payloadEncoding, regs, (uint32_t)0, (uint32_t)regCount * 16,
+					numPointsInReadPage, dataSize, _dataBuffer))
+				{
+					reportMalfunction(__LINE__);
+					return true;
+				}
+
+				if (_dataArchive != nullptr)
+				{
+					if (!_dataArchive->append(deviceName, readStart, dataSize, timeScale, numPointsInReadPage, _dataBuffer))
+						reportMalfunction(__LINE__);
+				}
 
-				sendDataToSlaves(readStart, dataSize, timeScale, numPointsInReadPage, deviceName, _dataBuffer);
-				AWAIT(_sendDataToSlaves);
+				if (_dataCache != nullptr)
+				{
+					if (!_dataCache->append(deviceName, readStart, dataSize, timeScale, numPointsInReadPage, _dataBuffer))
+						reportMalfunction(__LINE__);
+				}
+				else
+				{
+					sendDataToSlaves(readStart, dataSize, timeScale, numPointsInReadPage, deviceName, _dataBuffer);
+					AWAIT(_sendDataToSlaves);
+				}
 
-				readStart += TimeManager::getPeriodFromTimeScale(timeScale) * numPointsInReadPage / 1000;
+				readStart += (uint64_t)TimeManager::getPeriodFromTimeScale(timeScale) * numPointsInReadPage / 1000;
 
 				curReadPage++;
+
+				// Page boundary. A time broadcast is short enough to send right away; other work that
+				// needs the bus more takes over, and the caller picks up the rest of the range later.
+				if (_preemptible && _timeUpdatePending)
+				{
+					_timeUpdatePending = false;
+					broadcastTime();
+				}
+				if (numReadPagesRemaining > 0 && shouldYieldBus())
+				{
+					DEBUG(readAndSendData, P_TIME(); PRINT("Read preempted at "); PRINTLN(readStart));
+					_preemptedAt = readStart;
+					RETURN_ASYNC;
+				}
 			}
 			else if (regs[1] == 1)
 			{
@@ -615,9 +1005,17 @@ protected_testable:
 			not_responding:
 			if (notResponding)
 			{
+				markDeviceNotResponding(deviceRow);
 				// Used to indicate that the device is not responding
-				sendDataToSlaves(getClock(), 0, (TimeScale)0, 0, deviceName, _dataBuffer);
-				AWAIT(_sendDataToSlaves);
+				if (_dataCache != nullptr)
+				{
+					_dataCache->append(deviceName, getClock(), 0, (TimeScale)0, 0, _dataBuffer);
+				}
+				else
+				{
+					sendDataToSlaves(getClock(), 0, (TimeScale)0, 0, deviceName, _dataBuffer);
+					AWAIT(_sendDataToSlaves);
+				}
 				RETURN_ASYNC;
 			}
 		}
@@ -632,9 +1030,9 @@ protected_testable:
 		return _readAndSendDeviceData;
 	}
 
-	DEFINE_CLASS_TASK(THIS_T, transferPendingData, void, VARS(int, DeviceDirectoryRow*, byte*, bool, TimeScale, byte, uint32_t[8]), TimeScale, uint32_t);
+	DEFINE_CLASS_TASK(THIS_T, transferPendingData, void, VARS(int, DeviceDirectoryRow*, byte*, bool, TimeScale, byte, uint32_t[8]), TimeScale, TimeScale, uint32_t);
 	transferPendingData_Task _transferPendingData;
-	virtual ASYNC_CLASS_FUNC(THIS_T, transferPendingData, TimeScale maxTimeScale, uint32_t currentTime)
+	virtual ASYNC_CLASS_FUNC(THIS_T, transferPendingData, TimeScale minTimeScale, TimeScale maxTimeScale, uint32_t currentTime)
 	{
 		ASYNC_VAR_INIT(0, deviceIndex, 0);
 		ASYNC_VAR(1, deviceRow);
@@ -647,7 +1045,7 @@ protected_testable:
 		word *regs;
 		START_ASYNC;
 		VERBOSE(transferPendingData, P_TIME(); PRINT("Last updated times: "); for (int i = 0; i < 8; i++) { PRINT(lastUpdateTimes[i]); PRINT(" "); } PRINTLN(""));
-		for (int i = 0; i <= (int)maxTimeScale; i++)
+		for (int i = (int)minTimeScale; i <= (int)maxTimeScale; i++)
 		{
 			uint32_t numDataPoints = (uint64_t)(currentTime - lastUpdateTimes[i]) * 1000 / TimeManager::getPeriodFromTimeScale((TimeScale)i);
 			{
@@ -658,45 +1056,269 @@ protected_testable:
 				}
 				if (numDataPoints > maxPoints)
 				{
+					uint32_t skippedFrom = lastUpdateTimes[i];
 					lastUpdateTimes[i] += (uint64_t)(numDataPoints - (uint32_t)maxPoints) * TimeManager::getPeriodFromTimeScale((TimeScale)i) / 1000;
+					// Nothing was ever transferred before the first time, so there is no gap to fill
+					if (skippedFrom != 0)
+						queueBackfill((TimeScale)i, skippedFrom, lastUpdateTimes[i]);
 					DEBUG(transferPendingData, P_TIME(); PRINT("data transfer truncated to "); PRINT(maxPoints); PRINT(" from "); PRINTLN(numDataPoints));
 					numDataPoints = maxPoints;
 				}
 			}
 			updatedTimes[i] = lastUpdateTimes[i] + numDataPoints * TimeManager::getPeriodFromTimeScale((TimeScale)i) / 1000;
 		}
-		DEBUG(transferPendingData, P_TIME(); PRINT("transferPendingData maxTimeScale = "); PRINT((int)maxTimeScale); PRINT(", currentTime = "); PRINTLN(currentTime));
+		DEBUG(transferPendingData, P_TIME(); PRINT("transferPendingData minTimeScale = "); PRINT((int)minTimeScale); PRINT(", maxTimeScale = "); PRINT((int)maxTimeScale); PRINT(", currentTime = "); PRINTLN(currentTime));
 		while (deviceIndex != -1)
 		{
-			deviceRow = _deviceDirectory->findNextDevice(deviceName, deviceIndex);
+			deviceRow = _deviceDirectory->findNextCollector(deviceName, deviceIndex, minTimeScale, maxTimeScale);
 			if (deviceRow != nullptr)
 			{
 				if (DataCollectorDevice::getParametersFromDataCollectorDeviceType(deviceRow->deviceType, accumulateData, timeScale, dataSize))
 				{
-					if (timeScale <= maxTimeScale)
+					if (timeScale >= minTimeScale && timeScale <= maxTimeScale)
 					{
 						if (lastUpdateTimes[(int)timeScale] == updatedTimes[(int)timeScale])
 							continue;
+						if (shouldYieldBus())
+						{
+							_backfillQueue.push(deviceRow->slaveId, deviceRow->deviceNumber, timeScale,
+								lastUpdateTimes[(int)timeScale], updatedTimes[(int)timeScale]);
+							continue;
+						}
 						readAndSendDeviceData(deviceRow, _deviceDirectory->getDeviceNameLength(), deviceName,
 							lastUpdateTimes[(int)timeScale], updatedTimes[(int)timeScale]);
 						AWAIT(_readAndSendDeviceData);
+						if (_preemptedAt != 0)
+						{
+							_backfillQueue.push(deviceRow->slaveId, deviceRow->deviceNumber, timeScale,
+								_preemptedAt, updatedTimes[(int)timeScale]);
+						}
 					}
 				}
 			}
 		}
-		for (int i = 0; i <= (int)maxTimeScale; i++)
+		for (int i = (int)minTimeScale; i <= (int)maxTimeScale; i++)
 		{
 			lastUpdateTimes[i] = updatedTimes[i];
 		}
 		RETURN_ASYNC;
 		END_ASYNC;
 	}
-	transferPendingData_Task& transferPendingData(TimeScale maxTimeScale, uint32_t currentTime)
+	transferPendingData_Task& transferPendingData(TimeScale minTimeScale, TimeScale maxTimeScale, uint32_t currentTime)
 	{
-		_transferPendingData = transferPendingData_Task(&THIS_T::transferPendingData, this, maxTimeScale, currentTime);
+		_transferPendingData = transferPendingData_Task(&THIS_T::transferPendingData, this, minTimeScale, maxTimeScale, currentTime);
 		return _transferPendingData;
 	}
 
+	// Remembers a range of data that was skipped, for every data collector with the timescale
+	void queueBackfill(TimeScale timeScale, uint32_t startTime, uint32_t endTime)
+	{
+		int deviceIndex = 0;
+		byte *deviceName;
+		bool accumulateData;
+		TimeScale deviceTimeScale;
+		byte dataSize;
+		while (deviceIndex != -1)
+		{
+			auto deviceRow = _deviceDirectory->findNextCollector(deviceName, deviceIndex, timeScale, timeScale);
+			if (deviceRow != nullptr &&
+				DataCollectorDevice::getParametersFromDataCollectorDeviceType(deviceRow->deviceType, accumulateData, deviceTimeScale, dataSize) &&
+				deviceTimeScale == timeScale)
+			{
+				_backfillQueue.push(deviceRow->slaveId, deviceRow->deviceNumber, timeScale, startTime, endTime);
+			}
+		}
+	}
+
+	DEFINE_CLASS_TASK(THIS_T, backfillPendingData, void, VARS(int, DeviceDirectoryRow*, byte*, BackfillRange));
+	backfillPendingData_Task _backfillPendingData;
+	virtual ASYNC_CLASS_FUNC(THIS_T, backfillPendingData)
+	{
+		ASYNC_VAR_INIT(0, deviceIndex, 0);
+		ASYNC_VAR(1, deviceRow);
+		ASYNC_VAR(2, deviceName);
+		ASYNC_VAR(3, chunk);
+		word maxPoints;
+		START_ASYNC;
+		if (_backfillQueue.isEmpty())
+			RETURN_ASYNC;
+		maxPoints = _maxTransferSize;
+		// Same as transferPendingData, so quarter-second data stays aligned to whole seconds
+		if (_backfillQueue.front()->timeScale == TimeScale::ms250)
+			maxPoints = (maxPoints / 4) * 4;
+		if (!_backfillQueue.takeChunk(maxPoints, chunk))
+			RETURN_ASYNC;
+		DEBUG(backfillPendingData, P_TIME(); PRINT("Backfilling slave "); PRINT(chunk.slaveId); PRINT(" device "); PRINT(chunk.deviceNumber);
+			PRINT(" from "); PRINT(chunk.startTime); PRINT(" to "); PRINTLN(chunk.endTime));
+		while (deviceIndex != -1)
+		{
+			deviceRow = _deviceDirectory->findNextDeviceForSlave(chunk.slaveId, deviceName, deviceIndex);
+			if (deviceRow != nullptr && deviceRow->slaveId == chunk.slaveId && deviceRow->deviceNumber == chunk.deviceNumber)
+			{
+				readAndSendDeviceData(deviceRow, _deviceDirectory->getDeviceNameLength(), deviceName, chunk.startTime, chunk.endTime);
+				AWAIT(_readAndSendDeviceData);
+				if (_preemptedAt != 0)
+					_backfillQueue.push(chunk.slaveId, chunk.deviceNumber, chunk.timeScale, _preemptedAt, chunk.endTime);
+				RETURN_ASYNC;
+			}
+		}
+		// The device is gone, so the rest of its ranges are no use
+		_backfillQueue.removeDevice(chunk.slaveId, chunk.deviceNumber);
+		END_ASYNC;
+	}
+	backfillPendingData_Task& backfillPendingData()
+	{
+		_backfillPendingData = backfillPendingData_Task(&THIS_T::backfillPendingData, this);
+		return _backfillPendingData;
+	}
+
+	DEFINE_CLASS_TASK(THIS_T, deliverCachedData, void, VARS(int, DeviceDirectoryRow*, uint32_t, DataPageCacheEntry));
+	deliverCachedData_Task _deliverCachedData;
+	virtual ASYNC_CLASS_FUNC(THIS_T, deliverCachedData)
+	{
+		ASYNC_VAR_INIT(0, deviceIndex, 0);
+		ASYNC_VAR(1, device);
+		ASYNC_VAR(2, cursor);
+		ASYNC_VAR(3, entry);
+		byte *dummyName;
+		START_ASYNC;
+		_busTimeCategory = BusTimeCategory::delivery;
+		if (_dataCache == nullptr)
+			RETURN_ASYNC;
+		while (deviceIndex != -1)
+		{
+			device = _deviceDirectory->findNextTransmitter(dummyName, deviceIndex);
+			if (device != nullptr && Device::isDataTransmitterDeviceType(device->deviceType))
+			{
+				if (!_dataCache->getCursor(device->slaveId, device->deviceNumber, cursor))
+				{
+					// Too many destinations for the cache
+					reportMalfunction(__LINE__);
+					continue;
+				}
+				while (_dataCache->readPage(cursor, entry, _cacheNameBuffer, _dataBuffer, _dataBufferSize))
+				{
+					sendDataToDevice(device, entry.startTime, entry.dataSize, entry.timeScale, entry.numPoints, _cacheNameBuffer, _dataBuffer);
+					AWAIT(_sendDataToDevice);
+					if (_sendDataToDevice.result() == masterFailure)
+						RETURN_ASYNC;
+					if (_sendDataToDevice.result() == noResponse)
+					{
+						// Keep the remaining pages for this destination until it responds again
+						DEBUG(deliverCachedData, P_TIME(); PRINT("Cached data delivery deferred for slaveID = "); PRINTLN(device->slaveId));
+						break;
+					}
+					_dataCache->setCursor(device->slaveId, device->deviceNumber, cursor);
+				}
+			}
+		}
+		END_ASYNC;
+	}
+	deliverCachedData_Task& deliverCachedData()
+	{
+		CREATE_ASSIGN_CLASS_TASK(_deliverCachedData, THIS_T, this, deliverCachedData);
+		return _deliverCachedData;
+	}
+
+	void markDeviceResponded(DeviceDirectoryRow* device)
+	{
+		_deviceDirectory->recordDeviceResponse(device, getClock());
+	}
+
+	void markDeviceNotResponding(DeviceDirectoryRow* device)
+	{
+		byte slaveId = device->slaveId;
+		word deviceNumber = device->deviceNumber;
+		auto state = _deviceDirectory->recordDeviceNoResponse(device);
+		if (state == DeviceLivenessState::evicted)
+		{
+			DEBUG(liveness, P_TIME(); PRINT("Evicted device "); PRINT(deviceNumber); PRINT(" on slave "); PRINTLN(slaveId));
+			_backfillQueue.removeDevice(slaveId, deviceNumber);
+			// Another device could be given the same slave ID and number, and shouldn't inherit the cursor
+			if (_dataCache != nullptr)
+				_dataCache->removeDestination(slaveId, deviceNumber);
+		}
+		else if (state == DeviceLivenessState::suspended)
+		{
+			VERBOSE(liveness, P_TIME(); PRINT("Device "); PRINT(deviceNumber); PRINT(" on slave "); PRINT(slaveId); PRINTLN(" is suspended"));
+		}
+	}
+
+	// Checks whether one suspended device has come back, taking turns between them. A device that
+	// answers is live again, and one that keeps not answering is eventually evicted. Once all of a slave's
+	// devices are evicted, resetQuarantinedSlave sends it back to discovery when it answers again.
+	DEFINE_CLASS_TASK(THIS_T, probeSuspendedDevice, void, VARS(DeviceDirectoryRow*));
+	probeSuspendedDevice_Task _probeSuspendedDevice;
+	virtual ASYNC_CLASS_FUNC(THIS_T, probeSuspendedDevice)
+	{
+		ASYNC_VAR(0, deviceRow);
+		byte *deviceName;
+		START_ASYNC;
+		_busTimeCategory = BusTimeCategory::discovery;
+		if (_probeRow == -1)
+			_probeRow = 0;
+		deviceRow = _deviceDirectory->findNextSuspendedDevice(deviceName, _probeRow);
+		if (deviceRow == nullptr)
+		{
+			_probeRow = 0;
+			deviceRow = _deviceDirectory->findNextSuspendedDevice(deviceName, _probeRow);
+			if (deviceRow == nullptr)
+				RETURN_ASYNC;
+		}
+		completeModbusReadRegisters(deviceRow->slaveId, 0, 1);
+		AWAIT(_completeModbusReadRegisters);
+		// Any answer at all, even an exception, means the slave is there
+		if (_completeModbusReadRegisters.result() == noResponse)
+			markDeviceNotResponding(deviceRow);
+		else if (_completeModbusReadRegisters.result() == masterFailure || _completeModbusReadRegisters.result() == taskFailure)
+			reportMalfunction(__LINE__);
+		else
+			markDeviceResponded(deviceRow);
+		END_ASYNC;
+	}
+	probeSuspendedDevice_Task& probeSuspendedDevice()
+	{
+		_probeSuspendedDevice = probeSuspendedDevice_Task(&THIS_T::probeSuspendedDevice, this);
+		return _probeSuspendedDevice;
+	}
+
+	// Tells one slave whose devices were all evicted to go back to slave ID 1, taking turns between them.
+	// The slave keeps its ID until then, so the directory doesn't hand the ID out again until the slave
+	// has answered this.
+	DEFINE_CLASS_TASK(THIS_T, resetQuarantinedSlave, void, VARS(byte));
+	resetQuarantinedSlave_Task _resetQuarantinedSlave;
+	virtual ASYNC_CLASS_FUNC(THIS_T, resetQuarantinedSlave)
+	{
+		ASYNC_VAR(0, slaveId);
+		START_ASYNC;
+		_busTimeCategory = BusTimeCategory::discovery;
+		slaveId = _deviceDirectory->findNextQuarantinedSlaveId(_quarantineProbeId);
+		if (slaveId == 0)
+		{
+			slaveId = _deviceDirectory->findNextQuarantinedSlaveId(0);
+			if (slaveId == 0)
+				RETURN_ASYNC;
+		}
+		_quarantineProbeId = slaveId;
+		_registerBuffer[0] = 1;
+		_registerBuffer[1] = 1;
+		_registerBuffer[2] = 1;
+		completeModbusWriteRegisters(slaveId, 0, 3, _registerBuffer);
+		AWAIT(_completeModbusWriteRegisters);
+		ENSURE_NONMALFUNCTION(_completeModbusWriteRegisters);
+		if (_completeModbusWriteRegisters.result() != noResponse)
+		{
+			DEBUG(liveness, P_TIME(); PRINT("Sent slave "); PRINT(slaveId); PRINTLN(" back to discovery"));
+			_deviceDirectory->releaseQuarantinedSlaveId(slaveId);
+		}
+		END_ASYNC;
+	}
+	resetQuarantinedSlave_Task& resetQuarantinedSlave()
+	{
+		_resetQuarantinedSlave = resetQuarantinedSlave_Task(&THIS_T::resetQuarantinedSlave, this);
+		return _resetQuarantinedSlave;
+	}
+
 	DEFINE_CLASS_TASK(THIS_T, requestCurrentTime, uint32_t, VARS(int, DeviceDirectoryRow*, byte*, uint32_t));
 	requestCurrentTime_Task _requestCurrentTime;
 	virtual ASYNC_CLASS_FUNC(THIS_T, requestCurrentTime)
@@ -708,10 +1330,11 @@ protected_testable:
 		word regCount;
 		word *regs;
 		START_ASYNC;
+		_busTimeCategory = BusTimeCategory::timeSync;
 		DEBUG(requestCurrentTime, P_TIME(); PRINTLN("Request current time."));
 		while (deviceIndex != -1)
 		{
-			deviceRow = _deviceDirectory->findNextDevice(deviceName, deviceIndex);
+			deviceRow = _deviceDirectory->findNextTimeServer(deviceName, deviceIndex);
 			if (deviceRow != nullptr)
 			{
 				if (Device::isTimeServerDeviceType(deviceRow->deviceType))
@@ -724,12 +1347,19 @@ protected_testable:
 
 					ENSURE_NONMALFUNCTION(_completeModbusWriteRegisters);
 					if (_completeModbusWriteRegisters.result() == noResponse)
+					{
+						markDeviceNotResponding(deviceRow);
 						continue;
+					}
 					completeModbusReadRegisters(deviceRow->slaveId, 0, 3);
 					AWAIT(_completeModbusReadRegisters);
 					ENSURE_NONMALFUNCTION(_completeModbusReadRegisters);
 					if (_completeModbusReadRegisters.result() == noResponse)
+					{
+						markDeviceNotResponding(deviceRow);
 						continue;
+					}
+					markDeviceResponded(deviceRow);
 					_modbus->isReadRegsResponse(regCount, regs);
 					uint32_t result = (uint32_t)regs[1] + ((uint32_t)regs[2] << 16);
 					VERBOSE(requestCurrentTime, P_TIME(); PRINT("Requested time from device "); for (int i = 0; i < _deviceDirectory->getDeviceNameLength(); i++) { WRITE(deviceName[i]); }
@@ -750,18 +1380,19 @@ protected_testable:
 		return _requestCurrentTime;
 	}
 
-	DEFINE_CLASS_TASK(THIS_T, loop, void, VARS(unsigned long, unsigned long, unsigned int, unsigned long, uint32_t, bool, int, unsigned long));
+	DEFINE_CLASS_TASK(THIS_T, loop, void, VARS(unsigned long, TimeScale, unsigned long, uint32_t, bool, int));
 	loop_Task _loop;
+	// Each pass serves at most one class of work besides time sync, in priority order: time sync, live
+	// data, onboarding, backfill. Classes are held to their bus time budgets, and lower classes stop at the
+	// next page (or slave) boundary when a higher class needs the bus.
 	virtual ASYNC_CLASS_FUNC(THIS_T, loop)
 	{
 		ASYNC_VAR_INIT(0, lastActivityTime, 0);
-		ASYNC_VAR_INIT(1, lastSyncTime, 0);
-		ASYNC_VAR_INIT(2, syncNum, 0);
-		ASYNC_VAR(3, curTime);
-		ASYNC_VAR(4, curClock);
-		ASYNC_VAR(5, something);
-		ASYNC_VAR(6, i);
-		ASYNC_VAR_INIT(7, clockLastUpdated, 0);
+		ASYNC_VAR(1, dueTimeScale);
+		ASYNC_VAR(2, curTime);
+		ASYNC_VAR(3, curClock);
+		ASYNC_VAR(4, something);
+		ASYNC_VAR(5, i);
 		START_ASYNC;
 		// Initialize existing slaves on startup
 		//for (i = 2; i <= 246; i++)
@@ -779,16 +1410,58 @@ protected_testable:
 		for (;;)
 		{
 			tick(_system->micros());
+			_busTime.update(_system->micros());
+			_priorityBudget.update(_system->micros());
 			curTime = getCurTime();
 			curClock = getClock();
+			_preemptible = true;
+			_busPriority = BusPriority::timeSync;
 			if (_timeUpdatePending)
 			{
 				_timeUpdatePending = false;
 				broadcastTime();
 			}
-			if (lastActivityTime == 0 || (curTime - lastActivityTime > 2000000))
+			if (isClockUpdateDue(curClock))
+			{
+				DEBUG(loop, P_TIME(); PRINT("Updating clock. Current clock = "); PRINTLN(curClock));
+				requestCurrentTime();
+				AWAIT(_requestCurrentTime);
+				if (_requestCurrentTime.result() != 0)
+				{
+					setClock(_requestCurrentTime.result());
+					curClock = getClock();
+					VERBOSE(loop, P_TIME(); PRINT("Clock updated. Value = "); PRINTLN(curClock));
+				}
+				else
+				{
+					VERBOSE(loop, P_TIME(); PRINTLN("Clock update failed. Will try again in 1 second."));
+				}
+				_clockLastUpdated = curClock;
+			}
+			if (!wasTimeNeverSet() && _transferScheduler.isEmpty())
+			{
+				scheduleTransfers(curClock);
+			}
+
+			if (!wasTimeNeverSet() && _priorityBudget.hasBudget(BusPriority::liveData) &&
+				_transferScheduler.popDue(curClock, dueTimeScale))
+			{
+				VERBOSE(loop, P_TIME(); PRINT("Current clock = "); PRINT(curClock); PRINT(", transferring timescale "); PRINT((int)dueTimeScale);
+					PRINT(", lateness = "); PRINTLN(_transferScheduler.getLastLateness(dueTimeScale)));
+				_busPriority = BusPriority::liveData;
+				transferPendingData(dueTimeScale, dueTimeScale, curClock);
+				AWAIT(_transferPendingData);
+				if (_dataCache != nullptr)
+				{
+					deliverCachedData();
+					AWAIT(_deliverCachedData);
+				}
+			}
+			else if (_priorityBudget.hasBudget(BusPriority::onboarding) &&
+				(lastActivityTime == 0 || (curTime - lastActivityTime > 2000000)))
 			{
 				VERBOSE(loop, P_TIME(); PRINTLN("loop: Checking for unassigned slave."));
+				_busPriority = BusPriority::onboarding;
 				checkForNewSlaves(1);
 				AWAIT(_checkForNewSlaves);
 				something = (_checkForNewSlaves.result() == found) || (_checkForNewSlaves.result() == badSlave);
@@ -797,58 +1470,72 @@ protected_testable:
 					DEBUG(loop, P_TIME(); PRINT("loop: Found slave. badSlave = "); PRINTLN(_checkForNewSlaves.result() == badSlave));
 					processNewSlave(_checkForNewSlaves.result() == badSlave);
 					AWAIT(_processNewSlave);
+					if (shouldYieldBus())
+						break;
 					checkForNewSlaves(1);
 					AWAIT(_checkForNewSlaves);
 					something = (_checkForNewSlaves.result() == found) || (_checkForNewSlaves.result() == badSlave);
 				}
-				lastActivityTime = curTime;
-			}
-			if (lastSyncTime == 0)
-			{
-				lastSyncTime = curClock;
-			}
-			else if ((curClock - lastSyncTime >= 4) && !wasTimeNeverSet())
-			{
-				VERBOSE(loop, P_TIME(); PRINT("Current clock = "); PRINTLN(curClock));
-				syncNum++;
-				if (syncNum % 21600 == 0)
-					transferPendingData(TimeScale::hr24, curClock);
-				else if (syncNum % 900 == 0)
-					transferPendingData(TimeScale::hr1, curClock);
-				else if (syncNum % 450 == 0)
-					transferPendingData(TimeScale::min30, curClock);
-				else if (syncNum % 150 == 0)
-					transferPendingData(TimeScale::min10, curClock);
-				else if (syncNum % 15 == 0)
-					transferPendingData(TimeScale::min1, curClock);
-				else
-					transferPendingData(TimeScale::sec1, curClock);
-				AWAIT(_transferPendingData);
-				lastSyncTime = curClock;
-			}
-			if ((curClock - clockLastUpdated >= 86400) || (wasTimeNeverSet() && (curClock - clockLastUpdated >= 1)))
-			{
-				DEBUG(loop, P_TIME(); PRINT("Updating clock. Current clock = "); PRINTLN(curClock));
-				requestCurrentTime();
-				AWAIT(_requestCurrentTime);
-				if (_requestCurrentTime.result() != 0)
+				if (!something)
 				{
-					setClock(_requestCurrentTime.result());
-					curClock = getClock();
-					VERBOSE(loop, P_TIME(); PRINT("Clock updated. Value = "); PRINTLN(curClock));
+					probeSuspendedDevice();
+					AWAIT(_probeSuspendedDevice);
+					resetQuarantinedSlave();
+					AWAIT(_resetQuarantinedSlave);
 				}
-				else
+				// If onboarding was cut short, carry on with it as soon as it gets the bus again
+				lastActivityTime = something ? 0 : curTime;
+			}
+			else if (!wasTimeNeverSet() && !_backfillQueue.isEmpty() && _priorityBudget.hasBudget(BusPriority::backfill) &&
+				curTime - _lastBackfillTime >= _backfillInterval)
+			{
+				// Nothing else needs the bus, so catch up on skipped data, one chunk at a time
+				_lastBackfillTime = curTime;
+				_busPriority = BusPriority::backfill;
+				backfillPendingData();
+				AWAIT(_backfillPendingData);
+				if (_dataCache != nullptr)
 				{
-					VERBOSE(loop, P_TIME(); PRINTLN("Clock update failed. Will try again in 1 second."));
+					deliverCachedData();
+					AWAIT(_deliverCachedData);
 				}
-				clockLastUpdated = curClock;
 			}
+			_preemptible = false;
+			_busPriority = BusPriority::liveData;
 
 			YIELD_ASYNC;
 		}
 		END_ASYNC;
 	}
 
+	bool isClockUpdateDue(uint32_t curClock)
+	{
+		return (curClock - _clockLastUpdated >= 86400) || (wasTimeNeverSet() && (curClock - _clockLastUpdated >= 1));
+	}
+
+	// Whether work in progress should stop at the next page boundary, either because its class has used up
+	// its bus time for this cycle, or because a higher class is waiting. Live data only yields to its budget,
+	// since time broadcasts are sent in between its pages.
+	bool shouldYieldBus()
+	{
+		if (!_preemptible)
+			return false;
+		_priorityBudget.update(_system->micros());
+		if (!_priorityBudget.hasBudget(_busPriority))
+			return true;
+		if (_busPriority > BusPriority::liveData)
+		{
+			uint32_t curClock = getClock();
+			if (isClockUpdateDue(curClock))
+				return true;
+			TransferDeadline next;
+			if (!wasTimeNeverSet() && _priorityBudget.hasBudget(BusPriority::liveData) &&
+				_transferScheduler.peek(next) && (int32_t)(curClock - next.deadline) >= 0)
+				return true;
+		}
+		return false;
+	}
+
 	virtual bool broadcastTime()
 	{
 		word data[4];
@@ -856,11 +1543,26 @@ protected_testable:
 		data[1] = 32770; // Broadcast time function
 		uint32_t *clock = (uint32_t*)(data + 2);
 		*clock = getClock();
-		return (completeModbusWriteRegisters(0, 0, 4, (word*)data).runSynchronously() == success);
+		auto category = _busTimeCategory;
+		auto priority = _busPriority;
+		_busTimeCategory = BusTimeCategory::timeSync;
+		_busPriority = BusPriority::timeSync;
+		bool result = (completeModbusWriteRegisters(0, 0, 4, (word*)data).runSynchronously() == success);
+		_busTimeCategory = category;
+		_busPriority = priority;
+		return result;
+	}
+
+	void recordBusTime(word requestLength, word responseLength)
+	{
+		_busTime.config(_modbus->getBaud(), _modbus->getFrameDelay());
+		unsigned long now = _system->micros();
+		_busTime.record(_busTimeCategory, requestLength, responseLength, _busRequestStart, now);
+		_priorityBudget.charge(_busPriority, now - _busRequestStart);
 	}
 
 public:
-	void config(S *system, M *modbus, D *deviceDirectory, byte dataBufferSize, byte registerBufferSize)
+	void config(S *system, M *modbus, D *deviceDirectory, word dataBufferSize, word registerBufferSize)
 	{
 		_system = system;
 		_modbus = modbus;
@@ -873,6 +1575,11 @@ public:
 		{
 			lastUpdateTimes[i] = 0;
 		}
+		_busTime.reset(_system->micros());
+		_backfillQueue.init(8);
+		_priorityBudget.setBudget(BusPriority::onboarding, 250000);
+		_priorityBudget.setBudget(BusPriority::backfill, 250000);
+		_priorityBudget.reset(_system->micros());
 	}
 
 	word getMaxTransferSize()
@@ -885,6 +1592,88 @@ public:
 		_maxTransferSize = value;
 	}
 
+	TransferScheduler &getTransferScheduler()
+	{
+		return _transferScheduler;
+	}
+
+	DataPageCache *getDataCache()
+	{
+		return _dataCache;
+	}
+
+	// When a cache is set, data read from collectors is cached, and delivered to each transmitter separately
+	void setDataCache(DataPageCache *dataCache)
+	{
+		_dataCache = dataCache;
+		if (_cacheNameBuffer != nullptr)
+		{
+			delete[] _cacheNameBuffer;
+			_cacheNameBuffer = nullptr;
+		}
+		if (_dataCache != nullptr)
+		{
+			_cacheNameBuffer = new byte[_dataCache->getDeviceNameLength()];
+		}
+	}
+
+	// Bus time used since the last reset, by category, for judging how much headroom the bus has
+	BusTimeAccounting &getBusTimeAccounting()
+	{
+		_busTime.update(_system->micros());
+		return _busTime;
+	}
+
+	void resetBusTimeAccounting()
+	{
+		_busTime.reset(_system->micros());
+	}
+
+	BackfillQueue &getBackfillQueue()
+	{
+		return _backfillQueue;
+	}
+
+	unsigned long getBackfillInterval()
+	{
+		return _backfillInterval;
+	}
+
+	// Minimum time between backfill chunks, in microseconds
+	void setBackfillInterval(unsigned long value)
+	{
+		_backfillInterval = value;
+	}
+
+	// Budgets are microseconds of bus time per cycle, 0 for unlimited. By default, onboarding and backfill
+	// each get a quarter of every second, and time sync and live data are unlimited.
+	BusPriorityBudget &getPriorityBudget()
+	{
+		return _priorityBudget;
+	}
+
+	DataArchive *getDataArchive()
+	{
+		return _dataArchive;
+	}
+
+	// When an archive is set, every page read from collectors is also appended to it
+	void setDataArchive(DataArchive *dataArchive)
+	{
+		_dataArchive = dataArchive;
+	}
+
+	bool getBroadcastDataDistribution()
+	{
+		return _broadcastDataDistribution;
+	}
+
+	// When enabled, data is broadcast once to all slaves, and only slaves that missed pages are sent data individually
+	void setBroadcastDataDistribution(bool value)
+	{
+		_broadcastDataDistribution = value;
+	}
+
 	bool started = false;
 	void loop()
 	{
@@ -901,6 +1690,8 @@ public:
 	{
 		TimeManager::setClock(clock);
 		_timeUpdatePending = true;
+		// Deadlines are relative to the clock, so they are rescheduled after it changes
+		_transferScheduler.clear();
 	}
 
 	bool slaveFound = false;
@@ -0,0 +1,357 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+#include "../dataArchive/DataArchive.h"
+#include "../timeManager/TimeManager.h"
+#include "../bitFunctions/BitFunctions.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+
+struct MmapDataArchiveSegmentHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	byte timeScale;
+	byte dataSize;
+	uint32_t firstTimeCode;
+	uint32_t numSlots;
+};
+
+// One data point. A slot that was never written, or whose write was torn by a crash,
+// is all zeros, and is not valid.
+struct MmapDataArchiveRecord
+{
+	uint64_t value;
+	uint32_t timeCode;
+	uint32_t check;
+
+	static uint32_t computeCheck(uint64_t value, uint32_t timeCode)
+	{
+		// FNV-1a over the value and time code, never 0 so a zeroed slot can't pass
+		uint32_t hash = 2166136261u;
+		for (int i = 0; i < 8; i++)
+		{
+			hash = (hash ^ (byte)(value >> (i * 8))) * 16777619u;
+		}
+		for (int i = 0; i < 4; i++)
+		{
+			hash = (hash ^ (byte)(timeCode >> (i * 8))) * 16777619u;
+		}
+		return hash | 1;
+	}
+
+	bool isValid() const
+	{
+		return check == computeCheck(value, timeCode);
+	}
+};
+
+struct MmapDataArchiveSegment
+{
+	int fd = -1;
+	byte *map = nullptr;
+	size_t length = 0;
+	byte *deviceName = nullptr;
+	TimeScale timeScale = (TimeScale)0;
+	uint32_t segmentIndex = 0;
+};
+
+// Append-only time series store for the Linux master. Each device and time scale gets its own
+// series of segment files, each holding a fixed number of fixed-size records, and a point's
+// record is found from its time code alone (time codes are those of TimeManager::getTimeCodeForClock).
+// Segments are memory mapped, so range queries return pointers straight into the mapping. Those
+// pointers are only good until the segment is unmapped, which happens when more than
+// maxOpenSegments segments are in use, or the archive is cleared.
+class MmapDataArchive : public DataArchive
+{
+private_testable:
+	static const uint32_t _magic = 0x4B574841; // KWHA
+	static const uint16_t _version = 1;
+
+	char *_directory = nullptr;
+	word _deviceNameLength = 0;
+	uint32_t _slotsPerSegment = 0;
+
+	MmapDataArchiveSegment *_segments = nullptr;
+	byte _maxOpenSegments = 0;
+	byte _nextEviction = 0;
+
+	uint32_t _recoveredRecords = 0;
+
+	size_t getSegmentLength()
+	{
+		return sizeof(MmapDataArchiveSegmentHeader) + (size_t)_slotsPerSegment * sizeof(MmapDataArchiveRecord);
+	}
+
+	void getSegmentPath(byte *deviceName, TimeScale timeScale, uint32_t segmentIndex, char *pathOut, size_t pathLength)
+	{
+		int pos = snprintf(pathOut, pathLength, "%s/", _directory);
+		for (word i = 0; i < _deviceNameLength && pos + 3 < (int)pathLength; i++)
+		{
+			pos += snprintf(pathOut + pos, pathLength - pos, "%02x", deviceName[i]);
+		}
+		snprintf(pathOut + pos, pathLength - pos, "-%d-%08x.seg", (int)timeScale, segmentIndex);
+	}
+
+	static MmapDataArchiveSegmentHeader *getHeader(MmapDataArchiveSegment &segment)
+	{
+		return (MmapDataArchiveSegmentHeader*)segment.map;
+	}
+
+	static MmapDataArchiveRecord *getRecords(MmapDataArchiveSegment &segment)
+	{
+		return (MmapDataArchiveRecord*)(segment.map + sizeof(MmapDataArchiveSegmentHeader));
+	}
+
+	void closeSegment(MmapDataArchiveSegment &segment)
+	{
+		if (segment.map != nullptr)
+		{
+			msync(segment.map, segment.length, MS_SYNC);
+			munmap(segment.map, segment.length);
+			segment.map = nullptr;
+		}
+		if (segment.fd >= 0)
+		{
+			::close(segment.fd);
+			segment.fd = -1;
+		}
+	}
+
+	// Zeroes any record left torn by a crash
+	void recoverSegment(MmapDataArchiveSegment &segment)
+	{
+		auto header = getHeader(segment);
+		auto records = getRecords(segment);
+		for (uint32_t i = 0; i < header->numSlots; i++)
+		{
+			auto &record = records[i];
+			if ((!record.isValid() || record.timeCode != header->firstTimeCode + i) &&
+				(record.value != 0 || record.timeCode != 0 || record.check != 0))
+			{
+				memset(&record, 0, sizeof(MmapDataArchiveRecord));
+				_recoveredRecords++;
+			}
+		}
+	}
+
+	// Pass dataSize 0 to open an existing segment without creating it
+	MmapDataArchiveSegment *openSegment(byte *deviceName, TimeScale timeScale, uint32_t segmentIndex, byte dataSize)
+	{
+		if (_segments == nullptr)
+			return nullptr;
+		for (byte i = 0; i < _maxOpenSegments; i++)
+		{
+			auto &segment = _segments[i];
+			if (segment.map != nullptr && segment.timeScale == timeScale && segment.segmentIndex == segmentIndex &&
+				memcmp(segment.deviceName, deviceName, _deviceNameLength) == 0)
+			{
+				if (dataSize != 0 && getHeader(segment)->dataSize != dataSize)
+					return nullptr;
+				return &segment;
+			}
+		}
+
+		char path[256];
+		getSegmentPath(deviceName, timeScale, segmentIndex, path, sizeof(path));
+		int fd = open(path, dataSize == 0 ? O_RDWR : O_RDWR | O_CREAT, 0644);
+		if (fd < 0)
+			return nullptr;
+		struct stat fileStat;
+		size_t length = getSegmentLength();
+		bool created = false;
+		if (fstat(fd, &fileStat) != 0 ||
+			(fileStat.st_size != 0 && (size_t)fileStat.st_size != length))
+		{
+			::close(fd);
+			return nullptr;
+		}
+		if (fileStat.st_size == 0)
+		{
+			if (dataSize == 0 || ftruncate(fd, length) != 0)
+			{
+				::close(fd);
+				return nullptr;
+			}
+			created = true;
+		}
+		void *map = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (map == MAP_FAILED)
+		{
+			::close(fd);
+			return nullptr;
+		}
+
+		auto &segment = _segments[_nextEviction];
+		_nextEviction = (_nextEviction + 1) % _maxOpenSegments;
+		closeSegment(segment);
+		segment.fd = fd;
+		segment.map = (byte*)map;
+		segment.length = length;
+		memcpy(segment.deviceName, deviceName, _deviceNameLength);
+		segment.timeScale = timeScale;
+		segment.segmentIndex = segmentIndex;
+
+		auto header = getHeader(segment);
+		// A zero header means a crash came between creating the file and writing the header
+		if (created || (header->magic == 0 && dataSize != 0))
+		{
+			header->magic = _magic;
+			header->version = _version;
+			header->timeScale = (byte)timeScale;
+			header->dataSize = dataSize;
+			header->firstTimeCode = segmentIndex * _slotsPerSegment;
+			header->numSlots = _slotsPerSegment;
+			msync(segment.map, sizeof(MmapDataArchiveSegmentHeader), MS_SYNC);
+		}
+		else if (header->magic != _magic || header->version != _version ||
+			header->timeScale != (byte)timeScale || header->numSlots != _slotsPerSegment ||
+			header->firstTimeCode != segmentIndex * _slotsPerSegment ||
+			(dataSize != 0 && header->dataSize != dataSize))
+		{
+			closeSegment(segment);
+			return nullptr;
+		}
+		else
+		{
+			recoverSegment(segment);
+		}
+		return &segment;
+	}
+
+public:
+	// The directory must already exist. Segment files are named after the device name in hex,
+	// the time scale and the segment index.
+	bool init(const char *directory, word deviceNameLength, uint32_t slotsPerSegment = 4096, byte maxOpenSegments = 8)
+	{
+		clear();
+		if (directory == nullptr || deviceNameLength == 0 || slotsPerSegment == 0 || maxOpenSegments == 0)
+			return false;
+		_directory = new char[strlen(directory) + 1];
+		strcpy(_directory, directory);
+		_deviceNameLength = deviceNameLength;
+		_slotsPerSegment = slotsPerSegment;
+		_maxOpenSegments = maxOpenSegments;
+		_nextEviction = 0;
+		_segments = new MmapDataArchiveSegment[_maxOpenSegments];
+		for (byte i = 0; i < _maxOpenSegments; i++)
+		{
+			_segments[i].deviceName = new byte[_deviceNameLength];
+		}
+		return true;
+	}
+
+	void clear()
+	{
+		if (_segments != nullptr)
+		{
+			for (byte i = 0; i < _maxOpenSegments; i++)
+			{
+				closeSegment(_segments[i]);
+				delete[] _segments[i].deviceName;
+			}
+			delete[] _segments;
+			_segments = nullptr;
+		}
+		if (_directory != nullptr)
+		{
+			delete[] _directory;
+			_directory = nullptr;
+		}
+		_maxOpenSegments = 0;
+	}
+
+	// Writes every open segment through to disk
+	void flush()
+	{
+		for (byte i = 0; i < _maxOpenSegments; i++)
+		{
+			if (_segments[i].map != nullptr)
+				msync(_segments[i].map, _segments[i].length, MS_SYNC);
+		}
+	}
+
+	bool append(byte *deviceName, uint32_t startTime, byte dataSize, TimeScale timeScale, word numPoints, byte *data)
+	{
+		if (numPoints == 0)
+			return true;
+		if (dataSize == 0 || dataSize > 64 || TimeManager::getPeriodFromTimeScale(timeScale) == 0)
+			return false;
+		// Same time code as TimeManager::getTimeCodeForClock
+		uint32_t timeCode = (uint32_t)((uint64_t)startTime * 1000 / TimeManager::getPeriodFromTimeScale(timeScale));
+		MmapDataArchiveSegment *segment = nullptr;
+		for (word i = 0; i < numPoints; i++, timeCode++)
+		{
+			uint32_t segmentIndex = timeCode / _slotsPerSegment;
+			if (segment == nullptr || segment->segmentIndex != segmentIndex)
+			{
+				segment = openSegment(deviceName, timeScale, segmentIndex, dataSize);
+				if (segment == nullptr)
+					return false;
+			}
+			uint64_t value = 0;
+			BitFunctions::copyBits<byte, uint64_t, uint32_t>(data, &value, (uint32_t)i * dataSize, 0, dataSize);
+			uint32_t slot = timeCode % _slotsPerSegment;
+			auto &record = getRecords(*segment)[slot];
+			// The check goes last, so a record is only valid once it is completely written
+			record.check = 0;
+			std::atomic_thread_fence(std::memory_order_release);
+			record.value = value;
+			record.timeCode = timeCode;
+			std::atomic_thread_fence(std::memory_order_release);
+			record.check = MmapDataArchiveRecord::computeCheck(value, timeCode);
+		}
+		return true;
+	}
+
+	bool getPoint(byte *deviceName, TimeScale timeScale, uint32_t timeCode, uint64_t &valueOut)
+	{
+		auto segment = openSegment(deviceName, timeScale, timeCode / _slotsPerSegment, 0);
+		if (segment == nullptr)
+			return false;
+		auto &record = getRecords(*segment)[timeCode % _slotsPerSegment];
+		if (!record.isValid() || record.timeCode != timeCode)
+			return false;
+		valueOut = record.value;
+		return true;
+	}
+
+	// Points recordsOut at the record for timeCode, inside the mapped segment, and returns how many
+	// consecutive records (at most count) can be read from there before the end of the segment.
+	// Records that are not valid are points that were never archived.
+	uint32_t getRange(byte *deviceName, TimeScale timeScale, uint32_t timeCode, uint32_t count,
+		const MmapDataArchiveRecord *&recordsOut)
+	{
+		auto segment = openSegment(deviceName, timeScale, timeCode / _slotsPerSegment, 0);
+		if (segment == nullptr)
+			return 0;
+		uint32_t slot = timeCode % _slotsPerSegment;
+		recordsOut = getRecords(*segment) + slot;
+		if (count > _slotsPerSegment - slot)
+			count = _slotsPerSegment - slot;
+		return count;
+	}
+
+	// Number of torn records cleared while opening segments
+	uint32_t getRecoveredRecords()
+	{
+		return _recoveredRecords;
+	}
+
+	~MmapDataArchive()
+	{
+		clear();
+	}
+};
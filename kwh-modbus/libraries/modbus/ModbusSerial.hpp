@@ -59,11 +59,11 @@ class ModbusSerial : public TBase {
 private:
 	TSerial* _port;
 	TSystemFunctions* _system;
-	long  _baud;
+	long  _baud = 0;
 	int   _txPin;
 private_testable:
-	unsigned int _t15; // inter character time out
-	unsigned int _t35; // frame delay
+	unsigned int _t15 = 0; // inter character time out
+	unsigned int _t35 = 0; // frame delay
 	bool _transmitting = false;
 protected_testable:
 	int available()
@@ -232,6 +232,7 @@ public:
 		this->_port = port;
 		this->_system = system;
 		this->_txPin = txPin;
+		this->_baud = baud;
 		_port->begin(baud);
 		//while (!(*port));
 
@@ -249,4 +250,14 @@ public:
 
 		return true;
 	}
+
+	long getBaud()
+	{
+		return _baud;
+	}
+
+	unsigned int getFrameDelay()
+	{
+		return _t35;
+	}
 };
\ No newline at end of file
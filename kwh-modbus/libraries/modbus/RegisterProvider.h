@@ -0,0 +1,16 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+// Fills in registers on demand, right before a read request that covers them is answered
+class IRegisterProvider
+{
+public:
+	// Returns false if the registers could not be produced
+	virtual bool provideRegisters(word startReg, word numRegs) = 0;
+};
@@ -12,6 +12,8 @@
 #else
 #include "../arduinoMacros/arduinoMacros.h"
 #endif
+
+#include "RegisterProvider.h"
 //
 //#define MAX_REGS     32
 //#define MAX_FRAME   128
@@ -51,6 +53,7 @@ class Modbus {
 
 	protected_testable:
         byte  _reply;
+		IRegisterProvider *_registerProvider = nullptr;
 
 		virtual bool Reg(word address, word value) = 0;
 		virtual word Reg(word address) = 0;
@@ -70,6 +73,12 @@ class Modbus {
 
 		virtual bool validRange(word startReg, word numReg) = 0;
 
+		// Not tested: trivial
+		void setRegisterProvider(IRegisterProvider *registerProvider)
+		{
+			_registerProvider = registerProvider;
+		}
+
 		static word revWord(word input);
 };
 
@@ -34,6 +34,12 @@ private:
 			return false;
 		}
 
+		//Let registers that are computed on demand be filled in
+		if (this->_registerProvider != nullptr && !this->_registerProvider->provideRegisters(startreg, numregs)) {
+			this->exceptionResponse(MB_FC_READ_REGS, MB_EX_SLAVE_FAILURE);
+			return false;
+		}
+
 
 		//Clean frame buffer
 		if (!resetFrameRegs(numregs, 1)) {
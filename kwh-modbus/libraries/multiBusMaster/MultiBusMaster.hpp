@@ -0,0 +1,379 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+#include "../master/Master.hpp"
+#include "../dataArchive/DataArchive.h"
+#include "../dataPageCache/DataPageCache.hpp"
+#include "../spscQueue/SpscQueue.hpp"
+#include "../sharedDeviceDirectory/SharedDeviceDirectory.hpp"
+#include "../bitFunctions/BitFunctions.hpp"
+
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Sends every page read on one bus to the queues of all the other buses, then on to
+// another archive if there is one. Runs on the thread of the bus it belongs to.
+class BusForwardingArchive : public DataArchive
+{
+private_testable:
+	static const byte _headerSize = 8;
+
+	SpscQueue **_outboundQueues = nullptr;
+	byte _numOutboundQueues = 0;
+	word _deviceNameLength = 0;
+	DataArchive *_next = nullptr;
+	std::atomic<uint32_t> _droppedPages;
+
+public:
+	BusForwardingArchive()
+	{
+		_droppedPages.store(0);
+	}
+
+	static word getSlotSize(word deviceNameLength, word maxDataBytes)
+	{
+		return _headerSize + deviceNameLength + maxDataBytes;
+	}
+
+	void init(SpscQueue **outboundQueues, byte numOutboundQueues, word deviceNameLength)
+	{
+		_outboundQueues = outboundQueues;
+		_numOutboundQueues = numOutboundQueues;
+		_deviceNameLength = deviceNameLength;
+	}
+
+	void setNext(DataArchive *next)
+	{
+		_next = next;
+	}
+
+	DataArchive *getNext()
+	{
+		return _next;
+	}
+
+	// Pages are dropped if a queue is full or the page doesn't fit in a slot
+	bool append(byte *deviceName, uint32_t startTime, byte dataSize, TimeScale timeScale, word numPoints, byte *data)
+	{
+		word dataBytes = BitFunctions::bitsToBytes((uint32_t)numPoints * dataSize);
+		for (byte i = 0; i < _numOutboundQueues; i++)
+		{
+			auto queue = _outboundQueues[i];
+			byte *slot = queue->beginPush();
+			if (slot == nullptr || getSlotSize(_deviceNameLength, dataBytes) > queue->getSlotSize())
+			{
+				_droppedPages++;
+				continue;
+			}
+			slot[0] = (byte)startTime;
+			slot[1] = (byte)(startTime >> 8);
+			slot[2] = (byte)(startTime >> 16);
+			slot[3] = (byte)(startTime >> 24);
+			slot[4] = (byte)numPoints;
+			slot[5] = (byte)(numPoints >> 8);
+			slot[6] = dataSize;
+			slot[7] = (byte)timeScale;
+			memcpy(slot + _headerSize, deviceName, _deviceNameLength);
+			memcpy(slot + _headerSize + _deviceNameLength, data, dataBytes);
+			queue->endPush();
+		}
+		if (_next != nullptr)
+			return _next->append(deviceName, startTime, dataSize, timeScale, numPoints, data);
+		return true;
+	}
+
+	// Unpacks a slot filled by append
+	static void readSlot(byte *slot, word deviceNameLength, uint32_t &startTime, byte &dataSize,
+		TimeScale &timeScale, word &numPoints, byte *&deviceName, byte *&data)
+	{
+		startTime = (uint32_t)slot[0] | ((uint32_t)slot[1] << 8) |
+			((uint32_t)slot[2] << 16) | ((uint32_t)slot[3] << 24);
+		numPoints = (word)slot[4] | ((word)slot[5] << 8);
+		dataSize = slot[6];
+		timeScale = (TimeScale)slot[7];
+		deviceName = slot + _headerSize;
+		data = slot + _headerSize + deviceNameLength;
+	}
+
+	uint32_t getDroppedPages()
+	{
+		return _droppedPages.load();
+	}
+};
+
+// Runs one Master per serial port, each on its own thread. Every bus caches the data it reads, and
+// forwards it to every other bus through a lock-free queue per pair of buses, so data transmitters on
+// any bus get data from collectors on all of them. Each bus discovers its own slaves, and the
+// devices of all buses can be looked up in a shared directory.
+template<class M, class S, class D>
+class MultiBusMaster
+{
+private_testable:
+	typedef Master<M, S, D> T_MASTER;
+
+	byte _numBuses = 0;
+	word _deviceNameLength = 0;
+	word _dataBufferSize = 0;
+	word _registerBufferSize = 0;
+
+	T_MASTER *_masters = nullptr;
+	D **_directories = nullptr;
+	uint32_t *_publishedVersions = nullptr;
+	DataPageCache *_caches = nullptr;
+	BusForwardingArchive *_forwarders = nullptr;
+
+	// Queue from bus i to bus j is at i * numBuses + j
+	SpscQueue *_queues = nullptr;
+	SpscQueue **_outboundQueues = nullptr;
+
+	SharedDeviceDirectory _sharedDirectory;
+
+	std::thread *_workers = nullptr;
+	std::atomic<bool> _running;
+	// Pause between passes of each worker, so an idle bus doesn't keep a core busy. Defaults to the
+	// Modbus frame delay above 19200 baud, which is as often as a bus can have anything new.
+	unsigned int _passDelayMicros = 2625;
+
+	SpscQueue &getQueue(byte from, byte to)
+	{
+		return _queues[from * _numBuses + to];
+	}
+
+public:
+	MultiBusMaster()
+	{
+		_running.store(false);
+	}
+
+	// cacheCapacity and queueSlots are per bus, and per pair of buses, and must be powers of two
+	bool init(byte numBuses, word deviceNameLength, word maxDevices, word dataBufferSize, word registerBufferSize,
+		word cacheCapacity, byte maxDestinations, word queueSlots)
+	{
+		clear();
+		if (numBuses == 0)
+			return false;
+		_numBuses = numBuses;
+		_deviceNameLength = deviceNameLength;
+		_dataBufferSize = dataBufferSize;
+		_registerBufferSize = registerBufferSize;
+		_masters = new T_MASTER[_numBuses];
+		_directories = new D*[_numBuses];
+		_publishedVersions = new uint32_t[_numBuses];
+		_caches = new DataPageCache[_numBuses];
+		_forwarders = new BusForwardingArchive[_numBuses];
+		_queues = new SpscQueue[_numBuses * _numBuses];
+		_outboundQueues = new SpscQueue*[_numBuses * _numBuses];
+		_sharedDirectory.init(deviceNameLength, maxDevices);
+
+		word slotSize = BusForwardingArchive::getSlotSize(deviceNameLength, dataBufferSize);
+		for (byte i = 0; i < _numBuses; i++)
+		{
+			_directories[i] = nullptr;
+			_publishedVersions[i] = 0;
+			if (!_caches[i].init(cacheCapacity, deviceNameLength, maxDestinations))
+				return false;
+			byte numOutbound = 0;
+			for (byte j = 0; j < _numBuses; j++)
+			{
+				if (i == j)
+					continue;
+				if (!getQueue(i, j).init(slotSize, queueSlots))
+					return false;
+				_outboundQueues[i * _numBuses + numOutbound] = &getQueue(i, j);
+				numOutbound++;
+			}
+			_forwarders[i].init(_outboundQueues + i * _numBuses, numOutbound, deviceNameLength);
+		}
+		return true;
+	}
+
+	// Each bus needs its own system functions, Modbus master and device directory
+	void configBus(byte bus, S *system, M *modbus, D *deviceDirectory)
+	{
+		auto &master = _masters[bus];
+		master.config(system, modbus, deviceDirectory, _dataBufferSize, _registerBufferSize);
+		master.setDataCache(&_caches[bus]);
+		master.setDataArchive(&_forwarders[bus]);
+		_directories[bus] = deviceDirectory;
+		_publishedVersions[bus] = deviceDirectory->getVersion() - 1;
+	}
+
+	// Moves pages forwarded from other buses into the cache of this bus. Returns the number of pages moved.
+	word receiveForwardedPages(byte bus)
+	{
+		word received = 0;
+		for (byte from = 0; from < _numBuses; from++)
+		{
+			if (from == bus)
+				continue;
+			auto &queue = getQueue(from, bus);
+			byte *slot;
+			while ((slot = queue.front()) != nullptr)
+			{
+				uint32_t startTime;
+				byte dataSize;
+				TimeScale timeScale;
+				word numPoints;
+				byte *deviceName;
+				byte *data;
+				BusForwardingArchive::readSlot(slot, _deviceNameLength, startTime, dataSize, timeScale, numPoints, deviceName, data);
+				_caches[bus].append(deviceName, startTime, dataSize, timeScale, numPoints, data);
+				queue.pop();
+				received++;
+			}
+		}
+		return received;
+	}
+
+	void publishDeviceDirectory(byte bus)
+	{
+		auto directory = _directories[bus];
+		if (directory == nullptr || directory->getVersion() == _publishedVersions[bus])
+			return;
+		_sharedDirectory.publish(bus, *directory);
+		_publishedVersions[bus] = directory->getVersion();
+	}
+
+	// One pass of a bus worker
+	void work(byte bus)
+	{
+		_masters[bus].loop();
+		receiveForwardedPages(bus);
+		publishDeviceDirectory(bus);
+	}
+
+	// Only set while the workers are stopped
+	void setPassDelay(unsigned int micros)
+	{
+		_passDelayMicros = micros;
+	}
+
+	void start()
+	{
+		if (_running.load() || _numBuses == 0)
+			return;
+		_running.store(true);
+		_workers = new std::thread[_numBuses];
+		for (byte i = 0; i < _numBuses; i++)
+		{
+			_workers[i] = std::thread([this, i]()
+			{
+				while (_running.load(std::memory_order_relaxed))
+				{
+					work(i);
+					std::this_thread::sleep_for(std::chrono::microseconds(_passDelayMicros));
+				}
+			});
+		}
+	}
+
+	void stop()
+	{
+		if (_workers == nullptr)
+			return;
+		_running.store(false);
+		for (byte i = 0; i < _numBuses; i++)
+		{
+			_workers[i].join();
+		}
+		delete[] _workers;
+		_workers = nullptr;
+	}
+
+	bool isRunning()
+	{
+		return _running.load();
+	}
+
+	T_MASTER &getMaster(byte bus)
+	{
+		return _masters[bus];
+	}
+
+	DataPageCache &getDataCache(byte bus)
+	{
+		return _caches[bus];
+	}
+
+	// Pages read on this bus can also be archived, after they are forwarded
+	void setDataArchive(byte bus, DataArchive *dataArchive)
+	{
+		_forwarders[bus].setNext(dataArchive);
+	}
+
+	SharedDeviceDirectory &getDeviceDirectory()
+	{
+		return _sharedDirectory;
+	}
+
+	byte getNumBuses()
+	{
+		return _numBuses;
+	}
+
+	// Pages that could not be forwarded because a queue was full
+	uint32_t getDroppedPages(byte bus)
+	{
+		return _forwarders[bus].getDroppedPages();
+	}
+
+	void clear()
+	{
+		stop();
+		if (_masters != nullptr)
+		{
+			for (byte i = 0; i < _numBuses; i++)
+			{
+				_masters[i].setDataCache(nullptr);
+				_masters[i].setDataArchive(nullptr);
+			}
+			delete[] _masters;
+			_masters = nullptr;
+		}
+		if (_directories != nullptr)
+		{
+			delete[] _directories;
+			_directories = nullptr;
+		}
+		if (_publishedVersions != nullptr)
+		{
+			delete[] _publishedVersions;
+			_publishedVersions = nullptr;
+		}
+		if (_caches != nullptr)
+		{
+			delete[] _caches;
+			_caches = nullptr;
+		}
+		if (_forwarders != nullptr)
+		{
+			delete[] _forwarders;
+			_forwarders = nullptr;
+		}
+		if (_queues != nullptr)
+		{
+			delete[] _queues;
+			_queues = nullptr;
+		}
+		if (_outboundQueues != nullptr)
+		{
+			delete[] _outboundQueues;
+			_outboundQueues = nullptr;
+		}
+		_sharedDirectory.clear();
+		_numBuses = 0;
+	}
+
+	~MultiBusMaster()
+	{
+		clear();
+	}
+};
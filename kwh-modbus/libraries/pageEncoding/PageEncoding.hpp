@@ -0,0 +1,281 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+#include "../bitFunctions/BitFunctions.hpp"
+
+// How the data points of a page are laid out on the bus. Advertised in the low 2 bits of the device type.
+enum class PageEncoding : byte
+{
+	raw = 0,
+	zigzagVarint = 1,
+	packedDelta = 2,
+	deadband = 3
+};
+
+// Encodes pages of fixed-width data points as deltas from the previous point, which suits slowly
+// changing series like accumulated energy. Deltas wrap at the data point size, so a meter rolling
+// over costs no more than any other small step.
+// zigzagVarint: each zigzagged delta (the first point is a delta from 0) in 7-bit groups, low group
+//   first, with the high bit of each byte set if another group follows.
+// packedDelta: an 8-bit delta width W, the first point in full, then each zigzagged delta in W bits.
+// deadband: a bit per point that is set if the point is carried, then each carried point in full. The
+//   first point is always carried. A point is left out if it is within the deadband of the last carried
+//   one, and is read back as that point, so flat series cost about a bit per point. A deadband of 0
+//   only leaves out repeats and loses nothing. Missing points are always carried when they start or end.
+class PageEncoder
+{
+private_testable:
+	template<class T>
+	static uint64_t readBits(T *src, uint32_t bit, byte count)
+	{
+		byte bytes[8] = { 0 };
+		BitFunctions::copyBits<T, byte, uint32_t>(src, bytes, bit, 0, count);
+		uint64_t value = 0;
+		for (int i = 7; i >= 0; i--)
+		{
+			value = (value << 8) | bytes[i];
+		}
+		return value;
+	}
+
+	template<class T>
+	static void writeBits(T *dest, uint32_t bit, byte count, uint64_t value)
+	{
+		byte bytes[8];
+		for (int i = 0; i < 8; i++)
+		{
+			bytes[i] = (byte)value;
+			value >>= 8;
+		}
+		BitFunctions::copyBits<byte, T, uint32_t>(bytes, dest, 0, bit, count);
+	}
+
+	static inline uint64_t pointMask(byte dataSize)
+	{
+		return dataSize >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << dataSize) - 1;
+	}
+
+	static uint64_t zigzagDelta(uint64_t value, uint64_t previous, byte dataSize)
+	{
+		uint64_t mask = pointMask(dataSize);
+		uint64_t difference = (value - previous) & mask;
+		int64_t delta = (int64_t)difference;
+		if ((difference >> (dataSize - 1)) & 1)
+			delta = (int64_t)(difference | ~mask);
+		return ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+	}
+
+	static uint64_t applyZigzagDelta(uint64_t zigzag, uint64_t previous, byte dataSize)
+	{
+		int64_t delta = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+		return (previous + (uint64_t)delta) & pointMask(dataSize);
+	}
+
+	static bool isOutsideDeadband(uint64_t value, uint64_t carried, byte dataSize, uint64_t deadband)
+	{
+		uint64_t missing = pointMask(dataSize);
+		if ((value == missing) != (carried == missing))
+			return true;
+		uint64_t zigzag = zigzagDelta(value, carried, dataSize);
+		// Magnitude of the wrapped difference
+		return ((zigzag >> 1) + (zigzag & 1)) > deadband;
+	}
+
+	static byte bitWidth(uint64_t value)
+	{
+		byte width = 0;
+		while (value != 0)
+		{
+			width++;
+			value >>= 1;
+		}
+		return width;
+	}
+
+public:
+	// Encodes numPoints data points, starting at srcBit, into dest starting at destBit.
+	// Returns the number of bits written, or 0 if the encoded page would be longer than maxBits.
+	// The deadband is only used by PageEncoding::deadband.
+	template<class T, class U>
+	static uint32_t encode(PageEncoding encoding, T *src, uint32_t srcBit, word numPoints, byte dataSize,
+		U *dest, uint32_t destBit, uint32_t maxBits, uint64_t deadband = 0)
+	{
+		if (numPoints == 0 || dataSize == 0 || dataSize > 63)
+			return 0;
+		uint32_t bits = 0;
+		uint64_t previous = 0;
+		switch (encoding)
+		{
+		case PageEncoding::raw:
+			bits = (uint32_t)numPoints * dataSize;
+			if (bits > maxBits)
+				return 0;
+			BitFunctions::copyBits<T, U, uint32_t>(src, dest, srcBit, destBit, bits);
+			return bits;
+		case PageEncoding::zigzagVarint:
+			for (word i = 0; i < numPoints; i++)
+			{
+				uint64_t value = readBits(src, srcBit + (uint32_t)i * dataSize, dataSize);
+				uint64_t zigzag = zigzagDelta(value, previous, dataSize);
+				previous = value;
+				do
+				{
+					if (bits + 8 > maxBits)
+						return 0;
+					byte group = zigzag & 0x7F;
+					zigzag >>= 7;
+					if (zigzag != 0)
+						group |= 0x80;
+					writeBits(dest, destBit + bits, 8, group);
+					bits += 8;
+				} while (zigzag != 0);
+			}
+			return bits;
+		case PageEncoding::packedDelta:
+		{
+			byte width = 0;
+			previous = readBits(src, srcBit, dataSize);
+			for (word i = 1; i < numPoints; i++)
+			{
+				uint64_t value = readBits(src, srcBit + (uint32_t)i * dataSize, dataSize);
+				byte curWidth = bitWidth(zigzagDelta(value, previous, dataSize));
+				if (curWidth > width)
+					width = curWidth;
+				previous = value;
+			}
+			bits = 8 + dataSize + (uint32_t)(numPoints - 1) * width;
+			if (bits > maxBits)
+				return 0;
+			writeBits(dest, destBit, 8, width);
+			previous = readBits(src, srcBit, dataSize);
+			writeBits(dest, destBit + 8, dataSize, previous);
+			for (word i = 1; i < numPoints; i++)
+			{
+				uint64_t value = readBits(src, srcBit + (uint32_t)i * dataSize, dataSize);
+				writeBits(dest, destBit + 8 + dataSize + (uint32_t)(i - 1) * width, width,
+					zigzagDelta(value, previous, dataSize));
+				previous = value;
+			}
+			return bits;
+		}
+		case PageEncoding::deadband:
+		{
+			bits = numPoints;
+			for (word i = 0; i < numPoints; i++)
+			{
+				uint64_t value = readBits(src, srcBit + (uint32_t)i * dataSize, dataSize);
+				if (i == 0 || isOutsideDeadband(value, previous, dataSize, deadband))
+				{
+					bits += dataSize;
+					previous = value;
+				}
+			}
+			if (bits > maxBits)
+				return 0;
+			uint32_t pointBit = destBit + numPoints;
+			for (word i = 0; i < numPoints; i++)
+			{
+				uint64_t value = readBits(src, srcBit + (uint32_t)i * dataSize, dataSize);
+				bool carried = i == 0 || isOutsideDeadband(value, previous, dataSize, deadband);
+				writeBits(dest, destBit + i, 1, carried);
+				if (carried)
+				{
+					writeBits(dest, pointBit, dataSize, value);
+					pointBit += dataSize;
+					previous = value;
+				}
+			}
+			return bits;
+		}
+		default:
+			return 0;
+		}
+	}
+
+	// Decodes numPoints data points from src starting at srcBit, reading no more than maxBits,
+	// into dest starting at bit 0. Returns false if the page is malformed or runs past maxBits.
+	template<class T, class U>
+	static bool decode(PageEncoding encoding, T *src, uint32_t srcBit, uint32_t maxBits,
+		word numPoints, byte dataSize, U *dest)
+	{
+		if (dataSize == 0 || dataSize > 63)
+			return false;
+		uint32_t bits = 0;
+		uint64_t previous = 0;
+		switch (encoding)
+		{
+		case PageEncoding::raw:
+			bits = (uint32_t)numPoints * dataSize;
+			if (bits > maxBits)
+				return false;
+			BitFunctions::copyBits<T, U, uint32_t>(src, dest, srcBit, 0, bits);
+			return true;
+		case PageEncoding::zigzagVarint:
+			for (word i = 0; i < numPoints; i++)
+			{
+				uint64_t zigzag = 0;
+				byte shift = 0;
+				byte group;
+				do
+				{
+					if (bits + 8 > maxBits || shift >= 64)
+						return false;
+					group = (byte)readBits(src, srcBit + bits, 8);
+					zigzag |= (uint64_t)(group & 0x7F) << shift;
+					shift += 7;
+					bits += 8;
+				} while (group & 0x80);
+				previous = applyZigzagDelta(zigzag, previous, dataSize);
+				writeBits(dest, (uint32_t)i * dataSize, dataSize, previous);
+			}
+			return true;
+		case PageEncoding::packedDelta:
+		{
+			if (numPoints == 0)
+				return true;
+			if (maxBits < 8)
+				return false;
+			byte width = (byte)readBits(src, srcBit, 8);
+			if (width > dataSize || 8 + dataSize + (uint32_t)(numPoints - 1) * width > maxBits)
+				return false;
+			previous = readBits(src, srcBit + 8, dataSize);
+			writeBits(dest, 0, dataSize, previous);
+			for (word i = 1; i < numPoints; i++)
+			{
+				uint64_t zigzag = readBits(src, srcBit + 8 + dataSize + (uint32_t)(i - 1) * width, width);
+				previous = applyZigzagDelta(zigzag, previous, dataSize);
+				writeBits(dest, (uint32_t)i * dataSize, dataSize, previous);
+			}
+			return true;
+		}
+		case PageEncoding::deadband:
+		{
+			if (numPoints == 0)
+				return true;
+			if (numPoints > maxBits || readBits(src, srcBit, 1) == 0)
+				return false;
+			bits = numPoints;
+			for (word i = 0; i < numPoints; i++)
+			{
+				if (readBits(src, srcBit + i, 1) != 0)
+				{
+					if (bits + dataSize > maxBits)
+						return false;
+					previous = readBits(src, srcBit + bits, dataSize);
+					bits += dataSize;
+				}
+				writeBits(dest, (uint32_t)i * dataSize, dataSize, previous);
+			}
+			return true;
+		}
+		default:
+			return false;
+		}
+	}
+};
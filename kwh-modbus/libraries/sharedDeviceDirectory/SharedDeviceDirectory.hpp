@@ -0,0 +1,245 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+#include "../deviceDirectoryRow/DeviceDirectoryRow.h"
+
+#include <string.h>
+#include <atomic>
+#include <mutex>
+
+// One published version of the shared directory. It is never changed while a reader holds it.
+struct SharedDeviceDirectorySnapshot
+{
+	std::atomic<uint32_t> readers;
+	SharedDeviceDirectorySnapshot *nextInPool = nullptr;
+	uint32_t version = 0;
+	word deviceNameLength = 0;
+	word numDevices = 0;
+	byte *buses = nullptr;
+	DeviceDirectoryRow *devices = nullptr;
+	byte *deviceNames = nullptr;
+
+	SharedDeviceDirectorySnapshot(word _deviceNameLength, word maxDevices)
+	{
+		readers.store(0);
+		deviceNameLength = _deviceNameLength;
+		buses = new byte[maxDevices];
+		devices = new DeviceDirectoryRow[maxDevices];
+		deviceNames = new byte[deviceNameLength * maxDevices];
+	}
+
+	byte *getDeviceName(word index) const
+	{
+		return deviceNames + index * deviceNameLength;
+	}
+
+	bool findDevice(byte *name, byte &busOut, DeviceDirectoryRow &deviceOut) const
+	{
+		for (word i = 0; i < numDevices; i++)
+		{
+			if (memcmp(getDeviceName(i), name, deviceNameLength) == 0)
+			{
+				busOut = buses[i];
+				deviceOut = devices[i];
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool getDevice(word index, byte &busOut, DeviceDirectoryRow &deviceOut, byte *nameOut) const
+	{
+		if (index >= numDevices)
+			return false;
+		busOut = buses[index];
+		deviceOut = devices[index];
+		memcpy(nameOut, getDeviceName(index), deviceNameLength);
+		return true;
+	}
+
+	~SharedDeviceDirectorySnapshot()
+	{
+		delete[] buses;
+		delete[] devices;
+		delete[] deviceNames;
+	}
+};
+
+// Devices on all the buses of a multi-bus master. Each bus keeps its own device directory, since
+// slave IDs are only unique within a bus, and publishes a copy here whenever it changes.
+//
+// Copy on write, RCU style: each publish fills a snapshot no reader holds and swaps it in atomically.
+// Readers take the current snapshot without locking and never wait for a publish, nor a publish for
+// them; a snapshot still held when it is replaced stays as it is until released. Only publishes
+// wait for each other. Snapshots are reused once no reader holds them, and more are allocated while
+// readers hold all of them.
+class SharedDeviceDirectory
+{
+private_testable:
+	std::mutex _publishMutex;
+	std::atomic<SharedDeviceDirectorySnapshot*> _current;
+	// Every snapshot, current or not. Only publish and clear use it.
+	SharedDeviceDirectorySnapshot *_pool = nullptr;
+	word _numSnapshots = 0;
+
+	word _deviceNameLength = 0;
+	word _maxDevices = 0;
+	uint32_t _version = 0;
+
+	SharedDeviceDirectorySnapshot *takeFreeSnapshot()
+	{
+		auto current = _current.load();
+		for (auto snapshot = _pool; snapshot != nullptr; snapshot = snapshot->nextInPool)
+		{
+			if (snapshot != current && snapshot->readers.load() == 0)
+				return snapshot;
+		}
+		auto snapshot = new SharedDeviceDirectorySnapshot(_deviceNameLength, _maxDevices);
+		snapshot->nextInPool = _pool;
+		_pool = snapshot;
+		_numSnapshots++;
+		return snapshot;
+	}
+
+	static void copyRow(const SharedDeviceDirectorySnapshot *from, word fromIndex, SharedDeviceDirectorySnapshot *to, word toIndex)
+	{
+		to->buses[toIndex] = from->buses[fromIndex];
+		to->devices[toIndex] = from->devices[fromIndex];
+		memcpy(to->getDeviceName(toIndex), from->getDeviceName(fromIndex), from->deviceNameLength);
+	}
+
+public:
+	SharedDeviceDirectory()
+	{
+		_current.store(nullptr);
+	}
+
+	// Not safe while other threads use the directory
+	void init(word deviceNameLength, word maxDevices)
+	{
+		std::lock_guard<std::mutex> lock(_publishMutex);
+		clear();
+		_deviceNameLength = deviceNameLength;
+		_maxDevices = maxDevices;
+		_current.store(takeFreeSnapshot());
+	}
+
+	// Replaces the devices of a bus with those in its own directory. Returns false if
+	// there was not room for all of them.
+	template<class D>
+	bool publish(byte bus, D &directory)
+	{
+		std::lock_guard<std::mutex> lock(_publishMutex);
+		auto current = _current.load();
+		if (current == nullptr)
+			return false;
+		auto next = takeFreeSnapshot();
+		word numDevices = 0;
+		for (word i = 0; i < current->numDevices; i++)
+		{
+			if (current->buses[i] != bus)
+				copyRow(current, i, next, numDevices++);
+		}
+
+		bool fits = true;
+		int row = 0;
+		byte *name;
+		while (row != -1)
+		{
+			auto device = directory.findNextDevice(name, row);
+			if (device == nullptr)
+				continue;
+			if (numDevices == _maxDevices)
+			{
+				fits = false;
+				break;
+			}
+			next->buses[numDevices] = bus;
+			next->devices[numDevices] = *device;
+			memcpy(next->getDeviceName(numDevices), name, _deviceNameLength);
+			numDevices++;
+		}
+		next->numDevices = numDevices;
+		next->version = ++_version;
+		_current.store(next);
+		return fits;
+	}
+
+	// The current snapshot, which stays the same until released. Never waits.
+	const SharedDeviceDirectorySnapshot *acquireSnapshot()
+	{
+		while (true)
+		{
+			auto snapshot = _current.load();
+			if (snapshot == nullptr)
+				return nullptr;
+			snapshot->readers.fetch_add(1);
+			// A publish may have reused the snapshot between the load and the count, so it is
+			// only safe to read if it is still current now that it is counted
+			if (_current.load() == snapshot)
+				return snapshot;
+			snapshot->readers.fetch_sub(1);
+		}
+	}
+
+	void releaseSnapshot(const SharedDeviceDirectorySnapshot *snapshot)
+	{
+		if (snapshot != nullptr)
+			const_cast<SharedDeviceDirectorySnapshot*>(snapshot)->readers.fetch_sub(1);
+	}
+
+	bool findDevice(byte *name, byte &busOut, DeviceDirectoryRow &deviceOut)
+	{
+		auto snapshot = acquireSnapshot();
+		bool found = snapshot != nullptr && snapshot->findDevice(name, busOut, deviceOut);
+		releaseSnapshot(snapshot);
+		return found;
+	}
+
+	// Indices are only stable until the next publish. Hold a snapshot to go through all of them.
+	bool getDevice(word index, byte &busOut, DeviceDirectoryRow &deviceOut, byte *nameOut)
+	{
+		auto snapshot = acquireSnapshot();
+		bool found = snapshot != nullptr && snapshot->getDevice(index, busOut, deviceOut, nameOut);
+		releaseSnapshot(snapshot);
+		return found;
+	}
+
+	word getDeviceCount()
+	{
+		auto snapshot = acquireSnapshot();
+		word count = snapshot == nullptr ? 0 : snapshot->numDevices;
+		releaseSnapshot(snapshot);
+		return count;
+	}
+
+	word getDeviceNameLength()
+	{
+		return _deviceNameLength;
+	}
+
+	// Not safe while other threads use the directory
+	void clear()
+	{
+		_current.store(nullptr);
+		while (_pool != nullptr)
+		{
+			auto next = _pool->nextInPool;
+			delete _pool;
+			_pool = next;
+		}
+		_numSnapshots = 0;
+		_maxDevices = 0;
+	}
+
+	~SharedDeviceDirectory()
+	{
+		clear();
+	}
+};
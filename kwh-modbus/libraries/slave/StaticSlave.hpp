@@ -0,0 +1,48 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/ArduinoMacros.h"
+#include "../../noArduino/TestHelpers.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+#include "Slave.hpp"
+
+// A Slave whose buffers and device tables are members instead of being allocated in init,
+// so it never touches the heap and sizeof gives its whole footprint. Meant to be declared
+// globally on boards where heap fragmentation at boot is a concern.
+template<class M, class S, word MaxDevices, word NameLen, word BufSize>
+class StaticSlave : public Slave<M, S>
+{
+private_testable:
+	byte _dataBufferStorage[BufSize];
+	byte _encodeBufferStorage[BufSize];
+	byte _prefetchBufferStorage[BufSize];
+	byte _deviceNameStorage[MaxDevices][NameLen];
+	byte *_deviceNamePointers[MaxDevices];
+	Device *_deviceStorage[MaxDevices];
+	word _broadcastDevicePageSizeStorage[MaxDevices];
+
+public:
+	// Returns false if there are more devices than MaxDevices
+	bool init(word deviceCount, word hregCount, Device **devices, byte **deviceNames)
+	{
+		if (deviceCount > MaxDevices)
+			return false;
+		this->clearDevices();
+		this->_ownsStorage = false;
+		this->_dataBuffer = _dataBufferStorage;
+		this->_encodeBuffer = _encodeBufferStorage;
+		this->_prefetchBuffer = _prefetchBufferStorage;
+		for (word i = 0; i < MaxDevices; i++)
+		{
+			_deviceNamePointers[i] = _deviceNameStorage[i];
+		}
+		this->_deviceNames = _deviceNamePointers;
+		this->_devices = _deviceStorage;
+		this->_broadcastDevicePageSizes = _broadcastDevicePageSizeStorage;
+		this->setupDevices(deviceCount, NameLen, hregCount, BufSize, devices, deviceNames);
+		return true;
+	}
+};
@@ -10,7 +10,9 @@
 #include "../device/Device.h"
 #include "../timeManager/TimeManager.h"
 #include "../bitFunctions/BitFunctions.hpp"
+#include "../pageEncoding/PageEncoding.hpp"
 #include "../debugMacros/DebugMacros.h"
+#include "../modbus/RegisterProvider.h"
 #define ENSURE(statement) if (!(statement)) return false
 
 enum SlaveState : word
@@ -26,6 +28,7 @@ enum SlaveState : word
 	sReceivingDevCommand = 8,
 	sDisplayDevMessage = 9,
 	sDisplaySlaveMessage = 10,
+	sBroadcastReceipt = 11,
 	sSetTime = 32770
 };
 
@@ -34,25 +37,211 @@ class Slave : public TimeManager
 {
 private_testable:
 	const byte _majorVersion = 1;
-	const byte _minorVersion = 0;
+	const byte _minorVersion = 1;
 	word _deviceNameLength;
-	word _deviceCount;
+	word _deviceCount = 0;
 	byte **_deviceNames = nullptr;
 	Device **_devices = nullptr;
 	SlaveState _state = sIdle;
 	word _stateDetail;
+	word _receivePointsPerPage = 0;
 	bool displayedStateInvalid = true;
 	word _hregCount;
 
 	byte* _dataBuffer = nullptr;
-	byte _dataBufferSize;
+	word _dataBufferSize;
+
+	// False when the buffers and device arrays belong to a subclass, like StaticSlave
+	bool _ownsStorage = true;
+
+	// Holds encoded pages, only allocated once a device uses a page encoding
+	byte* _encodeBuffer = nullptr;
+
+	// The page after the last one displayed, read ahead from the device in loop while the master
+	// transfers the current one. Its buffer trades places with _dataBuffer when the page is requested.
+	enum PrefetchState : byte
+	{
+		prefetchNone = 0,
+		prefetchWanted = 1,
+		prefetchReady = 2
+	};
+	struct PrefetchedPage
+	{
+		PrefetchState state = prefetchNone;
+		word deviceNum;
+		uint32_t startTime;
+		word numDataPoints;
+		word page;
+		word maxPoints;
+		bool success;
+		word dataPointsCount;
+		word pagesRemaining;
+		byte dataPointSize;
+	};
+	PrefetchedPage _prefetch;
+	byte* _prefetchBuffer = nullptr;
+
+	// Broadcast data transfer in progress
+	word _broadcastTransferId = 0;
+	word _broadcastPointsPerPage = 0;
+	uint32_t _broadcastAcceptedDevices = 0;
+	uint32_t _broadcastReceivedPages = 0;
+	word *_broadcastDevicePageSizes = nullptr;
 
 	S *_system;
 	M *_modbus;
 
+	// Produces a requested data page when the master first reads past the state register,
+	// so pages the master never reads are never read from the device
+	class DataPageProvider : public IRegisterProvider
+	{
+	public:
+		Slave *slave = nullptr;
+
+		bool provideRegisters(word startReg, word numRegs)
+		{
+			return slave->provideRegisters(startReg, numRegs);
+		}
+	};
+	DataPageProvider _dataPageProvider;
+	bool _dataPagePending = false;
+
 private_testable:
-	virtual bool setOutgoingState()
+	bool isPrefetched(word deviceNum, uint32_t startTime, word numDataPoints, word page, word maxPoints)
+	{
+		return _prefetch.state == prefetchReady && _prefetch.deviceNum == deviceNum && _prefetch.startTime == startTime &&
+			_prefetch.numDataPoints == numDataPoints && _prefetch.page == page && _prefetch.maxPoints == maxPoints;
+	}
+
+	// Reads a page into _dataBuffer, or takes it from the prefetch buffer if it was read ahead
+	bool readDataPage(word deviceNum, uint32_t startTime, word numDataPoints, word page, word maxPoints,
+		word &dataPointsCount, word &pagesRemaining, byte &dataPointSize)
+	{
+		bool success;
+		if (isPrefetched(deviceNum, startTime, numDataPoints, page, maxPoints))
+		{
+			byte *buffer = _dataBuffer;
+			_dataBuffer = _prefetchBuffer;
+			_prefetchBuffer = buffer;
+			success = _prefetch.success;
+			dataPointsCount = _prefetch.dataPointsCount;
+			pagesRemaining = _prefetch.pagesRemaining;
+			dataPointSize = _prefetch.dataPointSize;
+		}
+		else
+		{
+			success = _devices[deviceNum]->readData(startTime, numDataPoints, page,
+				_dataBuffer, _dataBufferSize, maxPoints, dataPointsCount, pagesRemaining, dataPointSize);
+		}
+		_prefetch.state = prefetchNone;
+		if (success && pagesRemaining > 0)
+		{
+			_prefetch.state = prefetchWanted;
+			_prefetch.deviceNum = deviceNum;
+			_prefetch.startTime = startTime;
+			_prefetch.numDataPoints = numDataPoints;
+			_prefetch.page = page + 1;
+			_prefetch.maxPoints = maxPoints;
+		}
+		return success;
+	}
+
+	void prefetchDataPage()
 	{
+		if (_prefetch.state != prefetchWanted)
+			return;
+		_prefetch.success = _devices[_prefetch.deviceNum]->readData(_prefetch.startTime, _prefetch.numDataPoints, _prefetch.page,
+			_prefetchBuffer, _dataBufferSize, _prefetch.maxPoints, _prefetch.dataPointsCount, _prefetch.pagesRemaining, _prefetch.dataPointSize);
+		_prefetch.state = prefetchReady;
+	}
+
+	bool displayDataPage()
+	{
+		if (wasTimeNeverSet())
+		{
+			// need the time
+			ENSURE(_modbus->Hreg(1, 1));
+		}
+		else
+		{
+			word deviceNum = _modbus->Hreg(2);
+			uint32_t startTime = _modbus->Hreg(3) + ((uint32_t)_modbus->Hreg(4) << 16);
+			word numDataPointsRequested = _modbus->Hreg(5);
+			word curPage = _modbus->Hreg(6);
+			word maxPoints = _modbus->Hreg(7);
+			word dataPointsCount;
+			word pagesRemaining;
+			byte dataPointSize;
+
+			if (startTime > getClock())
+			{
+				// If the request starts in the future, someone's clock is messed up!
+				ENSURE(_modbus->Hreg(1, 1));
+			}
+			else if (readDataPage(deviceNum, startTime, numDataPointsRequested, curPage, maxPoints,
+				dataPointsCount, pagesRemaining, dataPointSize))
+			{
+				// success
+				ENSURE(_modbus->Hreg(1, 0));
+				ENSURE(_modbus->Hreg(2, (word)(startTime & 0xFFFF)));
+				ENSURE(_modbus->Hreg(3, (word)((startTime >> 16) & 0xFFFF)));
+				ENSURE(_modbus->Hreg(4, dataPointsCount));
+				ENSURE(_modbus->Hreg(5, curPage));
+				ENSURE(_modbus->Hreg(6, pagesRemaining));
+				uint32_t totalBits = (uint32_t)dataPointsCount * dataPointSize;
+				byte *pageData = _dataBuffer;
+				word firstDataReg = 7;
+				PageEncoding pageEncoding = Device::getPageEncodingFromDeviceType(_devices[deviceNum]->getType());
+				if (pageEncoding != PageEncoding::raw)
+				{
+					// Register 7 holds the encoding actually used and the payload length in registers.
+					// Pages that don't shrink when encoded are sent raw.
+					if (_encodeBuffer == nullptr)
+						_encodeBuffer = new byte[_dataBufferSize];
+					uint32_t deadband = pageEncoding == PageEncoding::deadband ? _devices[deviceNum]->getDeadband() : 0;
+					uint32_t encodedBits = PageEncoder::encode(pageEncoding, _dataBuffer, (uint32_t)0,
+						dataPointsCount, dataPointSize, _encodeBuffer, (uint32_t)0, totalBits - 1, deadband);
+					if (encodedBits > 0)
+					{
+						totalBits = encodedBits;
+						pageData = _encodeBuffer;
+					}
+					else
+					{
+						pageEncoding = PageEncoding::raw;
+					}
+					firstDataReg = 8;
+					ENSURE(_modbus->Hreg(7, BitFunctions::bitsToStructs<word, word>(totalBits) + ((word)pageEncoding << 12)));
+				}
+				word numRegs = BitFunctions::bitsToStructs<word, word>(totalBits);
+				word curReg;
+				for (int i = 0; i < numRegs; i++)
+				{
+					curReg = 0;
+					if (i < numRegs - 1)
+					{
+						BitFunctions::copyBits(pageData, &curReg, (uint32_t)i * 16, (uint32_t)0, (uint32_t)16);
+					}
+					else
+					{
+						BitFunctions::copyBits(pageData, &curReg, (uint32_t)i * 16, (uint32_t)0, (totalBits - 1) % 16 + 1);
+					}
+					ENSURE(_modbus->Hreg(firstDataReg + i, curReg));
+				}
+			}
+			else
+			{
+				// device does not send data
+				ENSURE(_modbus->Hreg(1, 2));
+			}
+		}
+		return true;
+	}
+
+	// With deferDataPage, a requested data page is left for provideRegisters to fill in
+	virtual bool setOutgoingState(bool deferDataPage = false)
+	{
+		_dataPagePending = false;
 		ENSURE(_modbus->validRange(0, _hregCount));
 		ENSURE(_modbus->Hreg(0, _state));
 		byte* name;
@@ -93,65 +282,21 @@ private_testable:
 			ENSURE(_modbus->Hreg(4 + index, 0)); // Messages waiting
 			break;
 		case sDisplayDevData:
-			if (wasTimeNeverSet())
-			{
-				// need the time
-				ENSURE(_modbus->Hreg(1, 1));
-			}
+			if (deferDataPage)
+				_dataPagePending = true;
 			else
-			{
-				deviceNum = _modbus->Hreg(2);
-				uint32_t startTime = _modbus->Hreg(3) + ((uint32_t)_modbus->Hreg(4) << 16);
-				word numDataPointsRequested = _modbus->Hreg(5);
-				byte curPage = (byte)(_modbus->Hreg(6) & 0x00FF);
-				byte maxPoints = (byte)((_modbus->Hreg(6) >> 8) & 0x00FF);
-				Device *device = _devices[deviceNum];
-				byte dataPointsCount;
-				byte pagesRemaining;
-				byte dataPointSize;
-				
-				if (startTime > getClock())
-				{
-					// If the request starts in the future, someone's clock is messed up!
-					ENSURE(_modbus->Hreg(1, 1));
-				}
-				else if (device->readData(startTime, numDataPointsRequested, curPage,
-					_dataBuffer, _dataBufferSize, maxPoints, dataPointsCount, pagesRemaining, dataPointSize))
-				{
-					// success
-					ENSURE(_modbus->Hreg(1, 0));
-					ENSURE(_modbus->Hreg(2, (word)(startTime & 0xFFFF)));
-					ENSURE(_modbus->Hreg(3, (word)((startTime >> 16) & 0xFFFF)));
-					ENSURE(_modbus->Hreg(4, (word)(dataPointsCount + ((word)(dataPointSize << 8)))));
-					ENSURE(_modbus->Hreg(5, (word)(curPage + ((word)(pagesRemaining << 8)))));
-					word totalBits = dataPointsCount * dataPointSize;
-					byte numRegs = BitFunctions::bitsToStructs<word, word>(totalBits);
-					word curReg;
-					for (int i = 0; i < numRegs; i++)
-					{
-						curReg = 0;
-						if (i < numRegs - 1)
-						{
-							BitFunctions::copyBits((byte*)_dataBuffer, &curReg, (word)(i * 16), (word)0, (word)16);
-						}
-						else
-						{
-							BitFunctions::copyBits((byte*)_dataBuffer, &curReg, (word)(i * 16), (word)0, (word)((totalBits - 1) % 16 + 1));
-						}
-						ENSURE(_modbus->Hreg(6 + i, curReg));
-					}
-				}
-				else
-				{
-					// device does not send data
-					ENSURE(_modbus->Hreg(1, 2));
-				}
-				//ENSURE(_modbus->Hreg(1, deviceNum));
-				//ENSURE(_modbus->Hreg(2, _devices[deviceNum]->getType()));
-			}
+				ENSURE(displayDataPage());
 			break;
 		case sPreparingToReceiveDevData:
 			ENSURE(_modbus->Hreg(1, _stateDetail));
+			ENSURE(_modbus->Hreg(2, _receivePointsPerPage));
+			break;
+		case sBroadcastReceipt:
+			ENSURE(_modbus->Hreg(1, _broadcastTransferId));
+			ENSURE(_modbus->Hreg(2, (word)_broadcastAcceptedDevices));
+			ENSURE(_modbus->Hreg(3, (word)(_broadcastAcceptedDevices >> 16)));
+			ENSURE(_modbus->Hreg(4, (word)_broadcastReceivedPages));
+			ENSURE(_modbus->Hreg(5, (word)(_broadcastReceivedPages >> 16)));
 			break;
 		case sRequestedTime:
 		{
@@ -167,6 +312,110 @@ private_testable:
 		return true;
 	}
 
+	// Returns true if any device took part in the transfer
+	bool prepareToReceiveBroadcastData()
+	{
+		_broadcastTransferId = _modbus->Hreg(2);
+		_broadcastAcceptedDevices = 0;
+		_broadcastReceivedPages = 0;
+		word nameLength = _modbus->Hreg(3);
+		uint32_t startTime = _modbus->Hreg(4) + ((uint32_t)_modbus->Hreg(5) << 16);
+		byte dataPointSize = (byte)(_modbus->Hreg(6) & 0xFF);
+		TimeScale dataTimeScale = (TimeScale)((_modbus->Hreg(6) >> 8) & 0xFF);
+		word dataPointsCount = _modbus->Hreg(7);
+		_broadcastPointsPerPage = _modbus->Hreg(8);
+		uint32_t pageBits = (uint32_t)_broadcastPointsPerPage * dataPointSize;
+		// Every page of the transfer would be dropped if a whole one doesn't fit in the buffer and registers
+		if (wasTimeNeverSet() || nameLength > _dataBufferSize || pageBits == 0 ||
+			pageBits > (uint32_t)_dataBufferSize * 8 || 6 + (pageBits + 15) / 16 > _hregCount)
+		{
+			// Master will find nothing accepted in the receipt and send to each device individually
+			return false;
+		}
+		word curReg;
+		for (int i = 0; i < nameLength; i++)
+		{
+			if (i % 2 == 0)
+				curReg = _modbus->Hreg(9 + i / 2);
+			else
+				curReg >>= 8;
+			_dataBuffer[i] = (byte)(curReg & 0xFF);
+		}
+		for (int i = 0; i < _deviceCount && i < 32; i++)
+		{
+			if (!Device::isDataTransmitterDeviceType(_devices[i]->getType()))
+				continue;
+			word dataPointsPerPage = _broadcastPointsPerPage;
+			RecieveDataStatus status = _devices[i]->prepareReceiveData(nameLength, _dataBuffer, startTime,
+				dataPointSize, dataTimeScale, dataPointsCount, dataPointsPerPage);
+			// A device that wants smaller pages can still take part, as long as a broadcast page splits evenly
+			if (status == RecieveDataStatus::success && dataPointsPerPage > 0 &&
+				_broadcastPointsPerPage % dataPointsPerPage == 0)
+			{
+				_broadcastAcceptedDevices |= (uint32_t)1 << i;
+				_broadcastDevicePageSizes[i] = dataPointsPerPage;
+			}
+		}
+		VERBOSE(prepareToReceiveData, P_TIME(); PRINT("Broadcast transfer "); PRINT(_broadcastTransferId); PRINT(" accepted devices = "); PRINTLN(_broadcastAcceptedDevices));
+		return _broadcastAcceptedDevices != 0;
+	}
+
+	// Returns true if the page is for a transfer this slave took part in, even if the page was dropped
+	bool receiveBroadcastDataPage()
+	{
+		if (_modbus->Hreg(2) != _broadcastTransferId || _broadcastAcceptedDevices == 0)
+			return false;
+		word dataPointsInPage = _modbus->Hreg(3);
+		byte dataPointSize = (byte)_modbus->Hreg(4);
+		TimeScale timeScale = (TimeScale)((byte)(_modbus->Hreg(4) >> 8));
+		word pageNumber = _modbus->Hreg(5);
+		if (pageNumber >= 32)
+			return true;
+		if ((uint32_t)dataPointsInPage * dataPointSize > (uint32_t)_dataBufferSize * 8)
+			return true;
+		// Unpacked once, then each device gets its sub-pages copied out, so that no device sees what
+		// another one did to its copy
+		word dataLengthBytes = BitFunctions::bitsToBytes((uint32_t)dataPointsInPage * dataPointSize);
+		word curReg = 0;
+		for (int j = 0; j < dataLengthBytes; j++)
+		{
+			if (j % 2 == 0)
+				curReg = _modbus->Hreg(6 + j / 2);
+			else
+				curReg >>= 8;
+			_dataBuffer[j] = (byte)(curReg & 0xFF);
+		}
+		if (_encodeBuffer == nullptr)
+			_encodeBuffer = new byte[_dataBufferSize];
+		for (int i = 0; i < _deviceCount && i < 32; i++)
+		{
+			if ((_broadcastAcceptedDevices & ((uint32_t)1 << i)) == 0)
+				continue;
+			word devicePointsPerPage = _broadcastDevicePageSizes[i];
+			word subPages = _broadcastPointsPerPage / devicePointsPerPage;
+			for (word subPage = 0; (uint32_t)subPage * devicePointsPerPage < dataPointsInPage; subPage++)
+			{
+				word subPagePoints = dataPointsInPage - subPage * devicePointsPerPage;
+				if (subPagePoints > devicePointsPerPage)
+					subPagePoints = devicePointsPerPage;
+				BitFunctions::copyBits(_dataBuffer, _encodeBuffer, (uint32_t)subPage * devicePointsPerPage * dataPointSize,
+					(uint32_t)0, (uint32_t)subPagePoints * dataPointSize);
+				_devices[i]->receiveDeviceData(subPagePoints, dataPointSize, timeScale,
+					pageNumber * subPages + subPage, _encodeBuffer);
+			}
+		}
+		_broadcastReceivedPages |= (uint32_t)1 << pageNumber;
+		return true;
+	}
+
+	// A broadcast overwrites the displayed registers of every slave, including those that don't take part.
+	// They are displayed again, except for states that read their parameters from those registers.
+	void ignoreBroadcast()
+	{
+		if (_state == sDisplayDevInfo || _state == sDisplayDevData || _state == sRequestedTime)
+			_state = sIdle;
+	}
+
 	virtual bool processIncomingState(bool &requestProcessed)
 	{
 		requestProcessed = false;
@@ -200,6 +449,7 @@ private_testable:
 				{
 					_stateDetail = (word)RecieveDataStatus::timeRequested;
 				}
+				_receivePointsPerPage = 0;
 				RecieveDataStatus status;
 				Device *device = _devices[_modbus->Hreg(2)];
 				word nameLength = _modbus->Hreg(3);
@@ -226,9 +476,10 @@ private_testable:
 					PRINT(": startTime = "); PRINT(startTime); PRINT(" dataPointSize = "); PRINT(dataPointSize); PRINT(" dataTimeScale = "); PRINT((int)dataTimeScale); PRINT(" dataPointsCount = "); PRINTLN(dataPointsCount));
 					if (dataPointsCount > 0)
 					{
-						byte dataPointsPerPage = 0;
+						word dataPointsPerPage = 0;
 						status = device->prepareReceiveData(nameLength, _dataBuffer, startTime, dataPointSize, dataTimeScale, dataPointsCount, dataPointsPerPage);
-						_stateDetail = (word)status + ((word)dataPointsPerPage << 8);
+						_stateDetail = (word)status;
+						_receivePointsPerPage = dataPointsPerPage;
 					}
 					else
 					{
@@ -244,26 +495,47 @@ private_testable:
 				_state = sIdle;
 				RecieveDataStatus status;
 				Device *device = _devices[_modbus->Hreg(2)];
-				byte dataPointsInPage = (byte)_modbus->Hreg(3);
-				byte dataPointSize = (byte)(_modbus->Hreg(3) >> 8);
-				TimeScale timeScale = (TimeScale)((byte)_modbus->Hreg(4));
-				byte pageNumber = (byte)(_modbus->Hreg(4) >> 8);
-
-
+				word dataPointsInPage = _modbus->Hreg(3);
+				byte dataPointSize = (byte)(_modbus->Hreg(4) & 0x3F);
+				PageEncoding pageEncoding = (PageEncoding)((_modbus->Hreg(4) >> 6) & 0x03);
+				TimeScale timeScale = (TimeScale)((byte)(_modbus->Hreg(4) >> 8));
+				word pageNumber = _modbus->Hreg(5);
 
 				word curReg = 0;
-				word dataLengthBytes = BitFunctions::bitsToBytes(dataPointsInPage * dataPointSize);
-				if (dataLengthBytes > _dataBufferSize)
+				word dataLengthBytes = BitFunctions::bitsToBytes((uint32_t)dataPointsInPage * dataPointSize);
+				if ((uint32_t)dataPointsInPage * dataPointSize > (uint32_t)_dataBufferSize * 8)
 				{
 					// Data is too long. Save myself the segfault
 					return true;
 				}
+				else if (pageEncoding != PageEncoding::raw)
+				{
+					// An encoded page is never longer than the raw page would have been
+					if (_encodeBuffer == nullptr)
+						_encodeBuffer = new byte[_dataBufferSize];
+					word maxPayloadBytes = _hregCount > 6 ? (_hregCount - 6) * 2 : 0;
+					if (dataLengthBytes > maxPayloadBytes)
+						dataLengthBytes = maxPayloadBytes;
+					for (int i = 0; i < dataLengthBytes; i++)
+					{
+						if (i % 2 == 0)
+							curReg = _modbus->Hreg(6 + i / 2);
+						else
+							curReg >>= 8;
+						_encodeBuffer[i] = (byte)(curReg & 0xFF);
+					}
+					if (!PageEncoder::decode(pageEncoding, _encodeBuffer, (uint32_t)0, (uint32_t)dataLengthBytes * 8,
+						dataPointsInPage, dataPointSize, _dataBuffer))
+					{
+						return true;
+					}
+				}
 				else
 				{
 					for (int i = 0; i < dataLengthBytes; i++)
 					{
 						if (i % 2 == 0)
-							curReg = _modbus->Hreg(5 + i / 2);
+							curReg = _modbus->Hreg(6 + i / 2);
 						else
 							curReg >>= 8;
 						_dataBuffer[i] = (byte)(curReg & 0xFF);
@@ -287,6 +559,20 @@ private_testable:
 				setClock(((uint32_t)_modbus->Hreg(3) << 16) + (uint16_t)_modbus->Hreg(2));
 				displayedStateInvalid = true;
 				break;
+			case 32772:
+				if (prepareToReceiveBroadcastData())
+					_state = sBroadcastReceipt;
+				else
+					ignoreBroadcast();
+				displayedStateInvalid = true;
+				break;
+			case 32773:
+				if (receiveBroadcastDataPage())
+					_state = sBroadcastReceipt;
+				else
+					ignoreBroadcast();
+				displayedStateInvalid = true;
+				break;
 			}
 		}
 		return true;
@@ -297,21 +583,43 @@ public:
 	{
 		_system = system;
 		_modbus = modbus;
+		_dataPageProvider.slave = this;
+		_modbus->setRegisterProvider(&_dataPageProvider);
+	}
+
+	bool provideRegisters(word startReg, word numRegs)
+	{
+		if (!_dataPagePending || startReg + numRegs <= 1)
+			return true;
+		_dataPagePending = false;
+		return displayDataPage();
 	}
 
-	void init(word deviceCount, word deviceNameLength, word hregCount, byte dataBufferSize, Device **devices, byte **deviceNames)
+	void init(word deviceCount, word deviceNameLength, word hregCount, word dataBufferSize, Device **devices, byte **deviceNames)
 	{
 		clearDevices();
+		_dataBuffer = new byte[dataBufferSize];
+		_prefetchBuffer = new byte[dataBufferSize];
+		_deviceNames = new byte*[deviceCount];
+		for (int i = 0; i < deviceCount; i++)
+		{
+			_deviceNames[i] = new byte[deviceNameLength];
+		}
+		_devices = new Device*[deviceCount];
+		_broadcastDevicePageSizes = new word[deviceCount];
+		setupDevices(deviceCount, deviceNameLength, hregCount, dataBufferSize, devices, deviceNames);
+	}
+
+protected:
+	// Fills in storage that is already allocated
+	void setupDevices(word deviceCount, word deviceNameLength, word hregCount, word dataBufferSize, Device **devices, byte **deviceNames)
+	{
 		_deviceCount = deviceCount;
 		_deviceNameLength = deviceNameLength;
 		_hregCount = hregCount;
 		_dataBufferSize = dataBufferSize;
-		_dataBuffer = new byte[_dataBufferSize];
-		_deviceNames = new byte*[_deviceNameLength];
-		_devices = new Device*[_deviceCount];
 		for (int i = 0; i < _deviceCount; i++)
 		{
-			_deviceNames[i] = new byte[_deviceNameLength];
 			for (int j = 0; j < _deviceNameLength; j++)
 			{
 				_deviceNames[i][j] = deviceNames[i][j];
@@ -322,9 +630,11 @@ public:
 		}
 	}
 
+public:
 	void setClock(uint32_t clock)
 	{
 		TimeManager::setClock(clock);
+		_prefetch.state = prefetchNone;
 		for (int i = 0; i < _deviceCount; i++)
 		{
 			_devices[i]->setClock(clock);
@@ -342,7 +652,9 @@ public:
 		if (processed)
 			processIncomingState(processed);
 		if (displayedStateInvalid)
-			setOutgoingState();
+			setOutgoingState(true);
+		else if (!_dataPagePending)
+			prefetchDataPage();
 
 		for (int i = 0; i < _deviceCount; i++)
 			_devices[i]->loop();
@@ -350,16 +662,36 @@ public:
 
 	void clearDevices()
 	{
-		if (_deviceNames != nullptr)
-		{
-			delete[] _deviceNames;
-			_deviceNames = nullptr;
-		}
-		if (_devices != nullptr)
+		if (_ownsStorage)
 		{
-			delete[] _devices;
-			_devices = nullptr;
+			if (_deviceNames != nullptr)
+			{
+				for (int i = 0; i < _deviceCount; i++)
+				{
+					delete[] _deviceNames[i];
+				}
+				delete[] _deviceNames;
+			}
+			if (_devices != nullptr)
+				delete[] _devices;
+			if (_broadcastDevicePageSizes != nullptr)
+				delete[] _broadcastDevicePageSizes;
+			if (_dataBuffer != nullptr)
+				delete[] _dataBuffer;
+			if (_prefetchBuffer != nullptr)
+				delete[] _prefetchBuffer;
+			if (_encodeBuffer != nullptr)
+				delete[] _encodeBuffer;
 		}
+		_deviceNames = nullptr;
+		_devices = nullptr;
+		_broadcastDevicePageSizes = nullptr;
+		_dataBuffer = nullptr;
+		_encodeBuffer = nullptr;
+		_prefetchBuffer = nullptr;
+		_ownsStorage = true;
+		_prefetch.state = prefetchNone;
+		_broadcastAcceptedDevices = 0;
 		_deviceCount = 0;
 	}
 
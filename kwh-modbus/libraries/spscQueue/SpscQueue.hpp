@@ -0,0 +1,109 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+#include "../bitFunctions/BitFunctions.hpp"
+
+#include <atomic>
+
+// Lock-free queue of fixed-size slots between exactly one producer thread and one consumer thread.
+// Slots are filled and read in place: the producer gets a slot with beginPush, fills it, and publishes
+// it with endPush; the consumer reads the slot from front, and frees it with pop.
+class SpscQueue
+{
+private_testable:
+	byte *_slots = nullptr;
+	word _slotSize = 0;
+	word _numSlots = 0;
+
+	// Positions only increase, and are masked down to a slot when used. The slot count is a
+	// power of two, so the mapping stays continuous when a position wraps at 2^32.
+	std::atomic<uint32_t> _head;
+	std::atomic<uint32_t> _tail;
+
+	byte *getSlot(uint32_t position)
+	{
+		return _slots + (size_t)(position & (_numSlots - 1)) * _slotSize;
+	}
+
+public:
+	SpscQueue()
+	{
+		_head.store(0);
+		_tail.store(0);
+	}
+
+	bool init(word slotSize, word numSlots)
+	{
+		clear();
+		if (slotSize == 0 || !BitFunctions::isPowerOfTwo(numSlots))
+			return false;
+		_slotSize = slotSize;
+		_numSlots = numSlots;
+		_slots = new byte[(size_t)_slotSize * _numSlots];
+		return true;
+	}
+
+	// Not safe while either thread is using the queue
+	void clear()
+	{
+		if (_slots != nullptr)
+		{
+			delete[] _slots;
+			_slots = nullptr;
+		}
+		_slotSize = 0;
+		_numSlots = 0;
+		_head.store(0);
+		_tail.store(0);
+	}
+
+	// Producer only. Returns nullptr if the queue is full.
+	byte *beginPush()
+	{
+		uint32_t head = _head.load(std::memory_order_relaxed);
+		if (_slots == nullptr || head - _tail.load(std::memory_order_acquire) >= _numSlots)
+			return nullptr;
+		return getSlot(head);
+	}
+
+	// Producer only
+	void endPush()
+	{
+		_head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Consumer only. Returns nullptr if the queue is empty.
+	byte *front()
+	{
+		uint32_t tail = _tail.load(std::memory_order_relaxed);
+		if (_slots == nullptr || tail == _head.load(std::memory_order_acquire))
+			return nullptr;
+		return getSlot(tail);
+	}
+
+	// Consumer only
+	void pop()
+	{
+		_tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	word getCount()
+	{
+		return (word)(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire));
+	}
+
+	word getSlotSize()
+	{
+		return _slotSize;
+	}
+
+	~SpscQueue()
+	{
+		clear();
+	}
+};
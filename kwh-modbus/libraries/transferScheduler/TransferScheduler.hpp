@@ -0,0 +1,180 @@
+#pragma once
+
+#ifdef NO_ARDUINO
+#include "../../noArduino/TestHelpers.h"
+#include "../../noArduino/ArduinoMacros.h"
+#else
+#include "../arduinoMacros/arduinoMacros.h"
+#endif
+
+#include "../timeManager/TimeManager.h"
+
+struct TransferDeadline
+{
+	uint32_t deadline;
+	uint32_t period;
+	TimeScale timeScale;
+};
+
+// Priority queue of data transfer deadlines, one per timescale, ordered by the earliest deadline.
+// Deadlines advance by whole periods from when they were first scheduled, so they keep their phase
+// no matter how long each transfer takes. Lateness is recorded each time a deadline is served.
+class TransferScheduler
+{
+private_testable:
+	static const byte _maxEntries = 8;
+
+	TransferDeadline _heap[_maxEntries];
+	byte _count = 0;
+
+	uint32_t _lastLateness[_maxEntries];
+	uint32_t _maxLateness[_maxEntries];
+	word _missedDeadlines[_maxEntries];
+
+	static bool isEarlier(const TransferDeadline &a, const TransferDeadline &b)
+	{
+		int32_t difference = (int32_t)(a.deadline - b.deadline);
+		if (difference == 0)
+			return a.timeScale < b.timeScale;
+		return difference < 0;
+	}
+
+	void swap(byte a, byte b)
+	{
+		TransferDeadline temp = _heap[a];
+		_heap[a] = _heap[b];
+		_heap[b] = temp;
+	}
+
+	void siftUp(byte index)
+	{
+		while (index > 0)
+		{
+			byte parent = (index - 1) / 2;
+			if (!isEarlier(_heap[index], _heap[parent]))
+				break;
+			swap(index, parent);
+			index = parent;
+		}
+	}
+
+	void siftDown(byte index)
+	{
+		for (;;)
+		{
+			byte earliest = index;
+			byte left = index * 2 + 1;
+			byte right = index * 2 + 2;
+			if (left < _count && isEarlier(_heap[left], _heap[earliest]))
+				earliest = left;
+			if (right < _count && isEarlier(_heap[right], _heap[earliest]))
+				earliest = right;
+			if (earliest == index)
+				break;
+			swap(index, earliest);
+			index = earliest;
+		}
+	}
+
+	void remove(TimeScale timeScale)
+	{
+		for (byte i = 0; i < _count; i++)
+		{
+			if (_heap[i].timeScale == timeScale)
+			{
+				_count--;
+				if (i < _count)
+				{
+					_heap[i] = _heap[_count];
+					siftDown(i);
+					siftUp(i);
+				}
+				return;
+			}
+		}
+	}
+
+public:
+	void clear()
+	{
+		_count = 0;
+		for (int i = 0; i < _maxEntries; i++)
+		{
+			_lastLateness[i] = 0;
+			_maxLateness[i] = 0;
+			_missedDeadlines[i] = 0;
+		}
+	}
+
+	// Adds or replaces the deadline for a timescale
+	bool schedule(TimeScale timeScale, uint32_t firstDeadline, uint32_t period)
+	{
+		if ((int)timeScale >= _maxEntries || period == 0)
+			return false;
+		remove(timeScale);
+		_heap[_count].deadline = firstDeadline;
+		_heap[_count].period = period;
+		_heap[_count].timeScale = timeScale;
+		_count++;
+		siftUp(_count - 1);
+		return true;
+	}
+
+	bool isEmpty()
+	{
+		return _count == 0;
+	}
+
+	byte getCount()
+	{
+		return _count;
+	}
+
+	bool peek(TransferDeadline &deadlineOut)
+	{
+		if (_count == 0)
+			return false;
+		deadlineOut = _heap[0];
+		return true;
+	}
+
+	// If the earliest deadline has passed, outputs its timescale and schedules its next deadline.
+	// Deadlines that were missed entirely are skipped, since a transfer catches up on all pending data.
+	bool popDue(uint32_t currentClock, TimeScale &timeScaleOut)
+	{
+		if (_count == 0 || (int32_t)(currentClock - _heap[0].deadline) < 0)
+			return false;
+		TransferDeadline &due = _heap[0];
+		int index = (int)due.timeScale;
+		uint32_t lateness = currentClock - due.deadline;
+		_lastLateness[index] = lateness;
+		if (lateness > _maxLateness[index])
+			_maxLateness[index] = lateness;
+		if (lateness >= due.period)
+			_missedDeadlines[index] += lateness / due.period;
+		timeScaleOut = due.timeScale;
+		due.deadline += (lateness / due.period + 1) * due.period;
+		siftDown(0);
+		return true;
+	}
+
+	uint32_t getLastLateness(TimeScale timeScale)
+	{
+		return _lastLateness[(int)timeScale];
+	}
+
+	uint32_t getMaxLateness(TimeScale timeScale)
+	{
+		return _maxLateness[(int)timeScale];
+	}
+
+	word getMissedDeadlines(TimeScale timeScale)
+	{
+		return _missedDeadlines[(int)timeScale];
+	}
+
+	TransferScheduler()
+	{
+		clear();
+	}
+};